@@ -3,45 +3,31 @@
 #include <string_view>
 #include <stdexcept>
 #include <windows.h>
+#include "Utf.h"
 
 namespace Common::Encoding
 {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "Common::Encoding expects UTF-16 wchar_t");
+
     // wstring(UTF-16) -> string(UTF-8)
+    // ޷󵥱ת루 Utf.hǷ루 WC_ERR_INVALID_CHARS һʧ
     [[nodiscard]] inline std::string WideToUtf8(std::wstring_view wsrc)
     {
         if (wsrc.empty())
             return {};
 
-        int bytes = WideCharToMultiByte(
-            CP_UTF8,
-            WC_ERR_INVALID_CHARS,
-            wsrc.data(),
-            static_cast<int>(wsrc.size()),
-            nullptr,
-            0,
-            nullptr,
-            nullptr
-        );
-        if (bytes <= 0) {
-            throw std::runtime_error("WideCharToMultiByte sizing failed, error=" + std::to_string(GetLastError()));
-        }
-
         std::string out;
-        out.resize(bytes);
+        out.resize(Utf::MaxUtf8Length(wsrc.size()));
 
-        int written = WideCharToMultiByte(
-            CP_UTF8,
-            WC_ERR_INVALID_CHARS,
-            wsrc.data(),
-            static_cast<int>(wsrc.size()),
-            out.data(),
-            bytes,
-            nullptr,
-            nullptr
+        size_t written = Utf::Utf16ToUtf8(
+            reinterpret_cast<const char16_t*>(wsrc.data()),
+            wsrc.size(),
+            out.data()
         );
-        if (written <= 0) {
-            throw std::runtime_error("WideCharToMultiByte conversion failed, error=" + std::to_string(GetLastError()));
+        if (written == Utf::INVALID) {
+            throw std::runtime_error("WideToUtf8 failed, error=" + std::to_string(ERROR_NO_UNICODE_TRANSLATION));
         }
+        out.resize(written);
 
         if (!out.empty() && out.back() == '\0') {
             out.pop_back();
@@ -55,34 +41,18 @@ namespace Common::Encoding
         if (src.empty())
             return {};
 
-        int wchars = MultiByteToWideChar(
-            CP_UTF8,
-            MB_ERR_INVALID_CHARS,
-            src.data(),
-            static_cast<int>(src.size()),
-            nullptr,
-            0
-        );
-
-        if (wchars <= 0) {
-            throw std::runtime_error("MultiByteToWideChar sizing failed, error=" + std::to_string(GetLastError()));
-        }
-
         std::wstring out;
-        out.resize(wchars);
+        out.resize(Utf::MaxUtf16Length(src.size()));
 
-        int written = MultiByteToWideChar(
-            CP_UTF8,
-            MB_ERR_INVALID_CHARS,
+        size_t written = Utf::Utf8ToUtf16(
             src.data(),
-            static_cast<int>(src.size()),
-            out.data(),
-            wchars
+            src.size(),
+            reinterpret_cast<char16_t*>(out.data())
         );
-
-        if (written <= 0) {
-            throw std::runtime_error("MultiByteToWideChar conversion failed, error=" + std::to_string(GetLastError()));
+        if (written == Utf::INVALID) {
+            throw std::runtime_error("Utf8ToWide failed, error=" + std::to_string(ERROR_NO_UNICODE_TRANSLATION));
         }
+        out.resize(written);
         return out;
     }
 }
\ No newline at end of file
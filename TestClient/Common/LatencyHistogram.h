@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+namespace Common::Metrics
+{
+    // Ͱӳֱͼλɵ÷ͨΪ΢룩
+    // - ÿ 2 ٷ 4 Ͱ 25%
+    // - Record ̵߳
+    class LatencyHistogram
+    {
+    public:
+        static constexpr size_t BUCKETS = 256;
+
+        void Record(uint64_t value)
+        {
+            m_buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t Count() const
+        {
+            return m_count.load(std::memory_order_relaxed);
+        }
+
+        // p ȡֵ 0~100ͰϽ
+        uint64_t Percentile(double p) const
+        {
+            uint64_t total = Count();
+            if (total == 0)
+                return 0;
+
+            uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total));
+            if (rank >= total)
+                rank = total - 1;
+
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                seen += m_buckets[b].load(std::memory_order_relaxed);
+                if (seen > rank)
+                    return UpperBound(b);
+            }
+            return UpperBound(BUCKETS - 1);
+        }
+
+        void Reset()
+        {
+            for (auto& b : m_buckets)
+                b.store(0, std::memory_order_relaxed);
+            m_count.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static size_t BucketOf(uint64_t v)
+        {
+            if (v < 4)
+                return static_cast<size_t>(v);
+            unsigned msb = static_cast<unsigned>(std::bit_width(v)) - 1;
+            unsigned sub = static_cast<unsigned>(v >> (msb - 2)) & 3;
+            return (msb - 1) * 4 + sub;
+        }
+
+        static uint64_t UpperBound(size_t b)
+        {
+            if (b < 4)
+                return b;
+            unsigned msb = static_cast<unsigned>(b / 4) + 1;
+            unsigned sub = static_cast<unsigned>(b % 4);
+            uint64_t lower = static_cast<uint64_t>(4 + sub) << (msb - 2);
+            return lower + (1ULL << (msb - 2)) - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+        std::atomic<uint64_t> m_count{ 0 };
+    };
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COMMON_UTF_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COMMON_UTF_SSE2 1
+#endif
+
+// ==============================
+// Common::Utf Win32  UTF-8 / UTF-16 У + ת
+// - Ŀ껺ɵ÷޷䣨UTF-16 -> UTF-8  3 UTF-8 -> UTF-16  1 תһ
+// -  WC_ERR_INVALID_CHARS / MB_ERR_INVALID_CHARS һ£롢
+//   Ĵ U+10FFFFضжΪʧܣ INVALID
+// - ASCII  SIMDѡ AVX2 / SSE2 ASCII ʱǰٻص SIMD
+// -  COMMON_UTF_SCALAR ǿֻñʵ
+// ==============================
+namespace Common::Utf
+{
+    constexpr size_t INVALID = static_cast<size_t>(-1);
+
+    // ޷Ŀ껺ĳ
+    constexpr size_t MaxUtf8Length(size_t utf16Units) { return utf16Units * 3; }
+    constexpr size_t MaxUtf16Length(size_t utf8Bytes) { return utf8Bytes; }
+
+    namespace Detail
+    {
+        //  src[i] һ㣬ɹ true ƽ i / o
+        inline bool EncodeOne(const char16_t* src, size_t len, size_t& i, char* dst, size_t& o)
+        {
+            uint32_t c = src[i];
+            if (c < 0x80) {
+                dst[o++] = static_cast<char>(c);
+                i += 1;
+                return true;
+            }
+            if (c < 0x800) {
+                dst[o++] = static_cast<char>(0xC0 | (c >> 6));
+                dst[o++] = static_cast<char>(0x80 | (c & 0x3F));
+                i += 1;
+                return true;
+            }
+            if (c < 0xD800 || c > 0xDFFF) {
+                dst[o++] = static_cast<char>(0xE0 | (c >> 12));
+                dst[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                dst[o++] = static_cast<char>(0x80 | (c & 0x3F));
+                i += 1;
+                return true;
+            }
+            // ԣǸߴ + ʹ
+            if (c > 0xDBFF || i + 1 >= len)
+                return false;
+            uint32_t lo = src[i + 1];
+            if (lo < 0xDC00 || lo > 0xDFFF)
+                return false;
+            uint32_t cp = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+            dst[o++] = static_cast<char>(0xF0 | (cp >> 18));
+            dst[o++] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            dst[o++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[o++] = static_cast<char>(0x80 | (cp & 0x3F));
+            i += 2;
+            return true;
+        }
+
+        inline bool IsCont(uint8_t b) { return (b & 0xC0) == 0x80; }
+
+        inline bool DecodeOne(const uint8_t* src, size_t len, size_t& i, char16_t* dst, size_t& o)
+        {
+            uint8_t b0 = src[i];
+            if (b0 < 0x80) {
+                dst[o++] = b0;
+                i += 1;
+                return true;
+            }
+
+            size_t rest = len - i;
+            if (b0 >= 0xC2 && b0 <= 0xDF) {
+                if (rest < 2 || !IsCont(src[i + 1]))
+                    return false;
+                dst[o++] = static_cast<char16_t>(((b0 & 0x1F) << 6) | (src[i + 1] & 0x3F));
+                i += 2;
+                return true;
+            }
+            if (b0 >= 0xE0 && b0 <= 0xEF) {
+                if (rest < 3)
+                    return false;
+                uint8_t b1 = src[i + 1], b2 = src[i + 2];
+                // E0 ų룬ED ų UTF-8 Ĵ
+                uint8_t lo = b0 == 0xE0 ? 0xA0 : 0x80;
+                uint8_t hi = b0 == 0xED ? 0x9F : 0xBF;
+                if (b1 < lo || b1 > hi || !IsCont(b2))
+                    return false;
+                dst[o++] = static_cast<char16_t>(((b0 & 0x0F) << 12) | ((b1 & 0x3F) << 6) | (b2 & 0x3F));
+                i += 3;
+                return true;
+            }
+            if (b0 >= 0xF0 && b0 <= 0xF4) {
+                if (rest < 4)
+                    return false;
+                uint8_t b1 = src[i + 1], b2 = src[i + 2], b3 = src[i + 3];
+                // F0 ų룬F4 ų U+10FFFF
+                uint8_t lo = b0 == 0xF0 ? 0x90 : 0x80;
+                uint8_t hi = b0 == 0xF4 ? 0x8F : 0xBF;
+                if (b1 < lo || b1 > hi || !IsCont(b2) || !IsCont(b3))
+                    return false;
+                uint32_t cp = ((b0 & 0x07u) << 18) | ((b1 & 0x3Fu) << 12) | ((b2 & 0x3Fu) << 6) | (b3 & 0x3Fu);
+                cp -= 0x10000;
+                dst[o++] = static_cast<char16_t>(0xD800 + (cp >> 10));
+                dst[o++] = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+                i += 4;
+                return true;
+            }
+            return false;
+        }
+
+        //  src ת ASCIIشĵԪ0 ʾ׿麬 ASCII
+        inline size_t AsciiBlock16To8(const char16_t* src, size_t len, char* dst)
+        {
+            size_t i = 0;
+#if !defined(COMMON_UTF_SCALAR) && defined(COMMON_UTF_AVX2)
+            for (; i + 32 <= len; i += 32) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+                // packus зűͣ>= 0x8000  0ȵ 9 λ
+                __m256i high = _mm256_and_si256(_mm256_or_si256(a, b), _mm256_set1_epi16(static_cast<short>(0xFF80)));
+                if (!_mm256_testz_si256(high, high))
+                    return i;
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+            }
+#endif
+#if !defined(COMMON_UTF_SCALAR) && defined(COMMON_UTF_SSE2)
+            for (; i + 16 <= len; i += 16) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+                __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF)
+                    return i;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+            }
+#else
+            for (; i + 8 <= len; i += 8) {
+                uint64_t w[2];
+                std::memcpy(w, src + i, sizeof(w));
+                if (((w[0] | w[1]) & 0xFF80FF80FF80FF80ull) != 0)
+                    return i;
+                for (size_t k = 0; k < 8; ++k)
+                    dst[i + k] = static_cast<char>(src[i + k]);
+            }
+#endif
+            return i;
+        }
+
+        inline size_t AsciiBlock8To16(const uint8_t* src, size_t len, char16_t* dst)
+        {
+            size_t i = 0;
+#if !defined(COMMON_UTF_SCALAR) && defined(COMMON_UTF_AVX2)
+            for (; i + 32 <= len; i += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                if (_mm256_movemask_epi8(v) != 0)
+                    return i;
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 16),
+                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+            }
+#endif
+#if !defined(COMMON_UTF_SCALAR) && defined(COMMON_UTF_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                if (_mm_movemask_epi8(v) != 0)
+                    return i;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+            }
+#else
+            for (; i + 8 <= len; i += 8) {
+                uint64_t w;
+                std::memcpy(&w, src + i, sizeof(w));
+                if ((w & 0x8080808080808080ull) != 0)
+                    return i;
+                for (size_t k = 0; k < 8; ++k)
+                    dst[i + k] = src[i + k];
+            }
+#endif
+            return i;
+        }
+
+        //  ASCII ǰ׺ȣֻ鲻дƽ
+        inline size_t AsciiPrefix8(const uint8_t* src, size_t len)
+        {
+            size_t i = 0;
+#if !defined(COMMON_UTF_SCALAR) && defined(COMMON_UTF_SSE2)
+            for (; i + 16 <= len; i += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                if (_mm_movemask_epi8(v) != 0)
+                    return i;
+            }
+#else
+            for (; i + 8 <= len; i += 8) {
+                uint64_t w;
+                std::memcpy(&w, src + i, sizeof(w));
+                if ((w & 0x8080808080808080ull) != 0)
+                    return i;
+            }
+#endif
+            return i;
+        }
+
+        //  ASCII ʱ̾룬ĵ ASCII ı SIMD
+        constexpr size_t SCALAR_RUN = 16;
+    }
+
+    // UTF-16 -> UTF-8dst  MaxUtf8Length(len) ֽڡдֽǷ뷵 INVALID
+    inline size_t Utf16ToUtf8(const char16_t* src, size_t len, char* dst)
+    {
+        size_t i = 0, o = 0;
+        while (i < len) {
+            size_t n = Detail::AsciiBlock16To8(src + i, len - i, dst + o);
+            i += n;
+            o += n;
+
+            size_t runEnd = i + Detail::SCALAR_RUN < len ? i + Detail::SCALAR_RUN : len;
+            while (i < runEnd) {
+                if (!Detail::EncodeOne(src, len, i, dst, o))
+                    return INVALID;
+            }
+        }
+        return o;
+    }
+
+    // ֻУ UTF-8ת룻 Utf8ToUtf16 ͬ
+    inline bool IsValidUtf8(const char* src, size_t len)
+    {
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+        char16_t scratch[2];
+        size_t i = 0;
+        while (i < len) {
+            i += Detail::AsciiPrefix8(s + i, len - i);
+
+            size_t runEnd = i + Detail::SCALAR_RUN < len ? i + Detail::SCALAR_RUN : len;
+            while (i < runEnd) {
+                size_t o = 0;
+                if (!Detail::DecodeOne(s, len, i, scratch, o))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // UTF-8 -> UTF-16dst  MaxUtf16Length(len) Ԫд뵥ԪǷ뷵 INVALID
+    inline size_t Utf8ToUtf16(const char* src, size_t len, char16_t* dst)
+    {
+        const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+        size_t i = 0, o = 0;
+        while (i < len) {
+            size_t n = Detail::AsciiBlock8To16(s + i, len - i, dst + o);
+            i += n;
+            o += n;
+
+            size_t runEnd = i + Detail::SCALAR_RUN < len ? i + Detail::SCALAR_RUN : len;
+            while (i < runEnd) {
+                if (!Detail::DecodeOne(s, len, i, dst, o))
+                    return INVALID;
+            }
+        }
+        return o;
+    }
+}
@@ -0,0 +1,85 @@
+#include "BufferPool.h"
+#include <bit>
+#include <algorithm>
+
+std::shared_ptr<BufferPool> BufferPool::Create(size_t maxIdleBytes)
+{
+    return std::shared_ptr<BufferPool>(new BufferPool(maxIdleBytes));
+}
+
+BufferPool::BufferPool(size_t maxIdleBytes)
+    : m_maxIdleBytes(maxIdleBytes)
+{
+
+}
+
+size_t BufferPool::ClassOf(size_t size)
+{
+    size_t rounded = std::bit_ceil((std::max)(size, MIN_POOLED_SIZE));
+    return static_cast<size_t>(std::countr_zero(rounded) - std::countr_zero(MIN_POOLED_SIZE));
+}
+
+BufferLease BufferPool::Acquire(size_t size)
+{
+    std::unique_ptr<PooledBuffer> buffer;
+
+    if (size <= MAX_POOLED_SIZE) {
+        size_t cls = ClassOf(size);
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (!m_free[cls].empty()) {
+                buffer = std::move(m_free[cls].back());
+                m_free[cls].pop_back();
+                m_idleBytes.fetch_sub(buffer->Capacity(), std::memory_order_relaxed);
+            }
+        }
+        if (!buffer) {
+            buffer = std::make_unique<PooledBuffer>(MIN_POOLED_SIZE << cls);
+        }
+    }
+    else {
+        buffer = std::make_unique<PooledBuffer>(size);
+    }
+
+    buffer->m_size = size;
+    buffer->m_sealed = false;
+    buffer->m_leased = buffer->Capacity();
+    m_leasedBytes.fetch_add(buffer->m_leased, std::memory_order_relaxed);
+
+    std::weak_ptr<BufferPool> weak = weak_from_this();
+    return BufferLease(buffer.release(), [weak](PooledBuffer* p) {
+        if (auto pool = weak.lock()) {
+            pool->Recycle(p);
+        }
+        else {
+            delete p;
+        }
+        });
+}
+
+BufferLease BufferPool::Copy(const uint8_t* data, size_t size)
+{
+    BufferLease lease = Acquire(size);
+    if (size > 0) {
+        std::memcpy(lease->Data(), data, size);
+    }
+    return lease;
+}
+
+void BufferPool::Recycle(PooledBuffer* buffer)
+{
+    std::unique_ptr<PooledBuffer> owned(buffer);
+    size_t capacity = owned->Capacity();
+    m_leasedBytes.fetch_sub(owned->m_leased, std::memory_order_relaxed);
+
+    // ֻǡĳһĻ壨Resize ݹֱͷţ
+    if (capacity > MAX_POOLED_SIZE || capacity < MIN_POOLED_SIZE || !std::has_single_bit(capacity))
+        return;
+
+    if (m_idleBytes.load(std::memory_order_relaxed) + capacity > m_maxIdleBytes)
+        return;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_free[ClassOf(capacity)].push_back(std::move(owned));
+    m_idleBytes.fetch_add(capacity, std::memory_order_relaxed);
+}
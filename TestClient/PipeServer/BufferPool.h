@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <span>
+#include <cstring>
+
+// ==============================
+// PooledBufferػ֡
+// - ǰԤ HEADROOM ֽڣ֡ǰ׺ȳSealFrame ֡ԭдܵ
+// - ͨ BufferLeaseshared_ptrֻʣһͷʱ黹
+// ==============================
+class PooledBuffer
+{
+public:
+    static constexpr size_t HEADROOM = 4;
+
+    explicit PooledBuffer(size_t capacity)
+        : m_storage(HEADROOM + capacity)
+    {
+    }
+
+    uint8_t*        Data() { return m_storage.data() + HEADROOM; }
+    const uint8_t*  Data() const { return m_storage.data() + HEADROOM; }
+    size_t          Size() const { return m_size; }
+    size_t          Capacity() const { return m_storage.size() - HEADROOM; }
+
+    std::span<const uint8_t> View() const { return { Data(), m_size }; }
+
+    // ʱݣڹ֮ǰã
+    void Resize(size_t size)
+    {
+        if (size > Capacity()) {
+            m_storage.resize(HEADROOM + size);
+        }
+        m_size = size;
+    }
+
+    // д֡ǰ׺ FrameCodec.h  SealFrame֮ FrameData/FrameSize Ϊ֡Ϊֻ
+    void SealFrame(uint32_t header)
+    {
+        std::memcpy(m_storage.data(), &header, sizeof(header));
+        m_sealed = true;
+    }
+
+    bool            IsSealed() const { return m_sealed; }
+    const uint8_t*  FrameData() const { return m_storage.data(); }
+    size_t          FrameSize() const { return HEADROOM + m_size; }
+
+private:
+    friend class BufferPool;
+
+    std::vector<uint8_t>    m_storage;
+    size_t                  m_size = 0;
+    size_t                  m_leased = 0;               // ʱͳƵ
+    bool                    m_sealed = false;
+};
+
+using BufferLease = std::shared_ptr<PooledBuffer>;
+
+// ==============================
+// BufferPool 2 ݷּû
+// - Acquire õ BufferLease ͷʱԶգʱֱͷڴ
+// -  MAX_POOLED_SIZE Ļ岻
+// ==============================
+class BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+public:
+    static constexpr size_t MIN_POOLED_SIZE = 256;
+    static constexpr size_t MAX_POOLED_SIZE = 16 * 1024 * 1024;
+
+    static std::shared_ptr<BufferPool> Create(size_t maxIdleBytes = 32 * 1024 * 1024);
+
+    // ȡΪ size Ļ壬Size() Ϊ size
+    BufferLease Acquire(size_t size);
+
+    //  data »壨ڰݷػ·
+    BufferLease Copy(const uint8_t* data, size_t size);
+
+    size_t IdleBytes() const { return m_idleBytes.load(std::memory_order_relaxed); }
+    size_t LeasedBytes() const { return m_leasedBytes.load(std::memory_order_relaxed); }
+
+private:
+    explicit BufferPool(size_t maxIdleBytes);
+
+    static size_t ClassOf(size_t size);
+    void Recycle(PooledBuffer* buffer);
+
+private:
+    static constexpr size_t CLASS_COUNT = 17;   // 256B .. 16MB
+
+    size_t                  m_maxIdleBytes;
+    std::mutex              m_mutex;
+    std::vector<std::unique_ptr<PooledBuffer>> m_free[CLASS_COUNT];
+    std::atomic<size_t>     m_idleBytes{ 0 };
+    std::atomic<size_t>     m_leasedBytes{ 0 };
+};
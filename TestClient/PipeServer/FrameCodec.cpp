@@ -0,0 +1,152 @@
+#include "FrameCodec.h"
+#include <algorithm>
+
+void EncodeFrame(std::vector<uint8_t>& out, FrameKind kind, const uint8_t* data, size_t size)
+{
+    AppendU32(out, MakeFrameHeader(kind, static_cast<uint32_t>(size)));
+    if (size > 0) {
+        out.insert(out.end(), data, data + size);
+    }
+}
+
+FrameDecoder::FrameDecoder(std::shared_ptr<BufferPool> pool, uint32_t maxFrameLength, size_t stagingSize)
+    : m_pool(pool ? std::move(pool) : BufferPool::Create())
+    , m_maxFrameLength(maxFrameLength)
+    , m_staging(stagingSize)
+{
+
+}
+
+uint8_t* FrameDecoder::ReadTarget(size_t& capacity)
+{
+    // ݴȡڽ֡壺ֱӶ֡
+    if (m_inBody && m_readPos == m_writePos) {
+        m_targetIsBody = true;
+        capacity = m_current.Size() - m_filled;
+        return m_current.buffer->Data() + m_filled;
+    }
+
+    // ѹݴδβƵͷ
+    if (m_readPos > 0) {
+        std::memmove(m_staging.data(), m_staging.data() + m_readPos, m_writePos - m_readPos);
+        m_writePos -= m_readPos;
+        m_readPos = 0;
+    }
+
+    m_targetIsBody = false;
+    capacity = m_staging.size() - m_writePos;
+    return m_staging.data() + m_writePos;
+}
+
+bool FrameDecoder::Commit(size_t n)
+{
+    if (m_failed)
+        return false;
+
+    if (m_targetIsBody) {
+        m_filled += n;
+        if (m_filled == m_current.Size()) {
+            FinishBody();
+        }
+        return true;
+    }
+
+    m_writePos += n;
+    Parse();
+    return !m_failed;
+}
+
+bool FrameDecoder::Next(Frame& frame)
+{
+    if (m_ready.empty())
+        return false;
+    frame = std::move(m_ready.front());
+    m_ready.pop_front();
+    return true;
+}
+
+void FrameDecoder::Parse()
+{
+    while (!m_failed)
+    {
+        if (!m_inBody) {
+            if (m_writePos - m_readPos < FRAME_HEADER_SIZE)
+                break;
+
+            uint32_t header = ReadU32(m_staging.data() + m_readPos);
+            m_readPos += FRAME_HEADER_SIZE;
+
+            uint32_t length = HeaderLength(header);
+            if (length > m_maxFrameLength) {
+                m_failed = true;
+                break;
+            }
+
+            m_current.kind = HeaderKind(header);
+            m_current.buffer = m_pool->Acquire(length);
+            m_current.buffer->SealFrame(header);
+            m_filled = 0;
+            m_inBody = true;
+        }
+
+        size_t take = (std::min)(m_writePos - m_readPos, m_current.Size() - m_filled);
+        if (take > 0) {
+            std::memcpy(m_current.buffer->Data() + m_filled, m_staging.data() + m_readPos, take);
+            m_filled += take;
+            m_readPos += take;
+        }
+
+        if (m_filled < m_current.Size())
+            break;
+
+        FinishBody();
+    }
+}
+
+FragmentAssembler::FragmentAssembler(std::shared_ptr<BufferPool> pool, size_t maxSize)
+    : m_pool(pool ? std::move(pool) : BufferPool::Create())
+    , m_maxSize(maxSize)
+{
+
+}
+
+FragmentAssembler::Result FragmentAssembler::Add(const Frame& frame, BufferLease& message)
+{
+    if (frame.Size() < FRAGMENT_HEADER_SIZE)
+        return Result::Malformed;
+
+    const uint8_t* p = frame.Data();
+    uint32_t streamId = ReadU32(p);
+    bool last = (p[sizeof(uint32_t)] & FRAGMENT_FLAG_LAST) != 0;
+    size_t size = frame.Size() - FRAGMENT_HEADER_SIZE;
+
+    BufferLease& assembly = m_streams[streamId];
+    size_t filled = assembly ? assembly->Size() : 0;
+    if (filled + size > m_maxSize) {
+        m_streams.erase(streamId);
+        return Result::TooLarge;
+    }
+
+    // ƬƬԤ֮ Resize 
+    if (!assembly) {
+        assembly = m_pool->Acquire(last ? size : 2 * FRAGMENT_SIZE);
+        assembly->Resize(0);
+    }
+    assembly->Resize(filled + size);
+    std::memcpy(assembly->Data() + filled, p + FRAGMENT_HEADER_SIZE, size);
+
+    if (!last)
+        return Result::Pending;
+
+    message = std::move(assembly);
+    m_streams.erase(streamId);
+    return Result::Complete;
+}
+
+void FrameDecoder::FinishBody()
+{
+    m_ready.push_back(std::move(m_current));
+    m_current = Frame{};
+    m_filled = 0;
+    m_inBody = false;
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include "BufferPool.h"
+
+// ==============================
+// ֡ʽ4ֽСǰ׺ + 
+// - ǰ׺ 24 λΪݳȣ 8 λΪ֡
+// - ɿͻˣԴı clientId 󶨣ֻշ 0MessageԭЭȫ
+// - ֻ֡ Hello  Resume Ŀͻˣ PipeServer.h  ConnectionSettings
+// ==============================
+enum class FrameKind : uint8_t
+{
+    Message      = 0,   // ͨϢJSON
+    StreamOpen   = 1,   // [u32 streamId][u64 totalSize][meta...]
+    StreamData   = 2,   // [u32 streamId][data...]
+    StreamEnd    = 3,   // [u32 streamId][u32 status]      ͷ
+    StreamCredit = 4,   // [u32 streamId][u32 bytes]       շ黹
+    StreamReset  = 5,   // [u32 streamId][u32 reason]      շֹ
+    Fragment     = 6,   // [u32 streamId][u8 flags][data...] ϢƬflags&1 ΪһƬ
+    Session      = 7,   // [u64 token][u64 received]        -> ͻˣỰơյĿͻϢtoken Ϊ 0 ʾ
+    Resume       = 8,   // [u64 token][u64 received][u64 resendFrom]  ͻѡʱ֡ SessionStore.hΪ 0 ʱ󷢰֡֡
+    Ack          = 9,   // [u64 received]                  ȷյϢͷݴ˲üطŻ
+    Credit       = 10,  // [u32 messages][u32 bytes]       ͻ -> ˣ׷ӷͶȣ׸ Credit ֡Ϊӿ
+    Batch        = 11,  // [frame][frame]...                Message ֡ǰ׺Ϊһֻ֡ʱЭ batch Ŀͻ˷
+    Compressed   = 12,  // [u32 originalSize][data...]     ѹһϢ PayloadCodec.hʱЭ compression ˫
+};
+
+constexpr size_t   FRAME_HEADER_SIZE = 4;
+constexpr uint32_t FRAME_LENGTH_MASK = 0x00FFFFFF;
+constexpr uint32_t MAX_FRAME_LENGTH  = 10 * 1024 * 1024;   // 10MB ޣ֡
+
+//  FRAGMENT_SIZE Ϣ߼ɷƬСϢ
+constexpr size_t   FRAGMENT_SIZE         = 32 * 1024;
+constexpr size_t   FRAGMENT_HEADER_SIZE  = sizeof(uint32_t) + sizeof(uint8_t);
+constexpr uint8_t  FRAGMENT_FLAG_LAST    = 0x01;
+constexpr size_t   MAX_REASSEMBLED_SIZE  = 64 * 1024 * 1024;   // Ϣ
+
+inline uint32_t MakeFrameHeader(FrameKind kind, uint32_t length)
+{
+    return (static_cast<uint32_t>(kind) << 24) | (length & FRAME_LENGTH_MASK);
+}
+
+inline FrameKind HeaderKind(uint32_t header)
+{
+    return static_cast<FrameKind>(header >> 24);
+}
+
+inline uint32_t HeaderLength(uint32_t header)
+{
+    return header & FRAME_LENGTH_MASK;
+}
+
+inline void AppendU32(std::vector<uint8_t>& out, uint32_t v)
+{
+    size_t pos = out.size();
+    out.resize(pos + sizeof(v));
+    std::memcpy(out.data() + pos, &v, sizeof(v));
+}
+
+inline void AppendU64(std::vector<uint8_t>& out, uint64_t v)
+{
+    size_t pos = out.size();
+    out.resize(pos + sizeof(v));
+    std::memcpy(out.data() + pos, &v, sizeof(v));
+}
+
+inline uint32_t ReadU32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t ReadU64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// ׷һ֡ǰ׺ + ݣ out ĩβ
+void EncodeFrame(std::vector<uint8_t>& out, FrameKind kind, const uint8_t* data, size_t size);
+
+// ػд֡ǰ׺֡ʱ falseֻܷƬͣ
+inline bool SealFrame(PooledBuffer& buffer, FrameKind kind)
+{
+    if (buffer.Size() > FRAME_LENGTH_MASK)
+        return false;
+    buffer.SealFrame(MakeFrameHeader(kind, static_cast<uint32_t>(buffer.Size())));
+    return true;
+}
+
+inline void EncodeSession(std::vector<uint8_t>& out, uint64_t token, uint64_t received)
+{
+    AppendU32(out, MakeFrameHeader(FrameKind::Session, 2 * sizeof(uint64_t)));
+    AppendU64(out, token);
+    AppendU64(out, received);
+}
+
+inline void EncodeResume(std::vector<uint8_t>& out, uint64_t token, uint64_t received, uint64_t resendFrom)
+{
+    AppendU32(out, MakeFrameHeader(FrameKind::Resume, 3 * sizeof(uint64_t)));
+    AppendU64(out, token);
+    AppendU64(out, received);
+    AppendU64(out, resendFrom);
+}
+
+inline void EncodeAck(std::vector<uint8_t>& out, uint64_t received)
+{
+    AppendU32(out, MakeFrameHeader(FrameKind::Ack, sizeof(uint64_t)));
+    AppendU64(out, received);
+}
+
+inline void EncodeCredit(std::vector<uint8_t>& out, uint32_t messages, uint32_t bytes)
+{
+    AppendU32(out, MakeFrameHeader(FrameKind::Credit, 2 * sizeof(uint32_t)));
+    AppendU32(out, messages);
+    AppendU32(out, bytes);
+}
+
+// ȡ Batch ֡ÿϢݣǰ׺ڲ Message ֡ʽʱ false
+template<typename F>
+bool ForEachBatchMessage(const uint8_t* data, size_t size, F&& fn)
+{
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < FRAME_HEADER_SIZE)
+            return false;
+        uint32_t header = ReadU32(data + offset);
+        uint32_t length = HeaderLength(header);
+        offset += FRAME_HEADER_SIZE;
+        if (HeaderKind(header) != FrameKind::Message || length > size - offset)
+            return false;
+        fn(data + offset, static_cast<size_t>(length));
+        offset += length;
+    }
+    return true;
+}
+
+// ֡λڳػУѷ֡ԭת
+struct Frame
+{
+    FrameKind               kind = FrameKind::Message;
+    BufferLease             buffer;
+
+    const uint8_t*  Data() const { return buffer->Data(); }
+    size_t          Size() const { return buffer->Size(); }
+};
+
+// ==============================
+// FrameDecoderʽ֡
+// - С֡ȶݴٲ
+// - ֡ڽȺ󣬺 ReadFile ֱд֡壬м俽
+// - ֡ȡ BufferPoolʹ÷ͷ Frame Զ
+// ÷ReadTarget -> ReadFile -> Commit -> ѭ Next
+// ==============================
+class FrameDecoder
+{
+public:
+    explicit FrameDecoder(std::shared_ptr<BufferPool> pool = nullptr,
+        uint32_t maxFrameLength = MAX_FRAME_LENGTH, size_t stagingSize = 8192);
+
+    // һζȡĿַ
+    uint8_t* ReadTarget(size_t& capacity);
+
+    // ύն n ֽڣ֡ʱ false÷ӦϿӣ
+    bool Commit(size_t n);
+
+    // ȡһ֡
+    bool Next(Frame& frame);
+
+    bool Failed() const { return m_failed; }
+
+    // ֺЭ̽֡
+    void SetMaxFrameLength(uint32_t maxFrameLength) { m_maxFrameLength = maxFrameLength; }
+
+private:
+    void Parse();
+    void FinishBody();
+
+private:
+    std::shared_ptr<BufferPool> m_pool;
+    uint32_t                m_maxFrameLength;
+    std::vector<uint8_t>    m_staging;
+    size_t                  m_readPos = 0;
+    size_t                  m_writePos = 0;
+
+    bool                    m_inBody = false;
+    bool                    m_targetIsBody = false;
+    Frame                   m_current;
+    size_t                  m_filled = 0;
+
+    std::deque<Frame>       m_ready;
+    bool                    m_failed = false;
+};
+
+// ==============================
+// FragmentAssembler߼ Fragment ֡
+// - ƬƬԤػ壬֮ԭ
+// -  maxSize ʱ TooLarge÷ӦϿӣ
+// ==============================
+class FragmentAssembler
+{
+public:
+    enum class Result
+    {
+        Pending,                // кƬ
+        Complete,               // message ΪϢ
+        Malformed,              // ƬͷѶ
+        TooLarge,
+    };
+
+    explicit FragmentAssembler(std::shared_ptr<BufferPool> pool = nullptr,
+        size_t maxSize = MAX_REASSEMBLED_SIZE);
+
+    Result Add(const Frame& frame, BufferLease& message);
+    void Clear() { m_streams.clear(); }
+
+private:
+    std::shared_ptr<BufferPool> m_pool;
+    size_t                  m_maxSize;
+    std::unordered_map<uint32_t, BufferLease> m_streams;
+};
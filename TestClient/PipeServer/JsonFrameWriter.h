@@ -0,0 +1,190 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include "BufferPool.h"
+#include "FrameCodec.h"
+
+// ==============================
+// JsonFrameWriterֱӰ JSON дػ֡
+// - ǰԤ֡ǰ׺PooledBuffer::HEADROOMFinish ʱȲ֡
+// -  PipeServer::SendToClient/Broadcast(BufferLease)·ٿ
+// - дԶ룻Key ֮һֵ
+// ÷
+//   JsonFrameWriter w(server.Pool());
+//   w.BeginObject().Field("type", "Response").Field("msgId", id).Key("payload").BeginObject()...EndObject().EndObject();
+//   server.SendToClient(clientId, w.Finish());
+// ==============================
+class JsonFrameWriter
+{
+public:
+    explicit JsonFrameWriter(std::shared_ptr<BufferPool> pool, size_t initialCapacity = 1024)
+        : m_pool(std::move(pool))
+        , m_buffer(m_pool->Acquire(initialCapacity))
+    {
+        m_buffer->Resize(0);
+    }
+
+    JsonFrameWriter& BeginObject() { Prefix(); Put('{'); Push(); return *this; }
+    JsonFrameWriter& EndObject()   { Pop(); Put('}'); return *this; }
+    JsonFrameWriter& BeginArray()  { Prefix(); Put('['); Push(); return *this; }
+    JsonFrameWriter& EndArray()    { Pop(); Put(']'); return *this; }
+
+    JsonFrameWriter& Key(std::string_view key)
+    {
+        Prefix();
+        Quoted(key);
+        Put(':');
+        m_afterKey = true;
+        return *this;
+    }
+
+    JsonFrameWriter& String(std::string_view s) { Prefix(); Quoted(s); return *this; }
+    JsonFrameWriter& Bool(bool v)               { Prefix(); Append(v ? "true" : "false"); return *this; }
+    JsonFrameWriter& Null()                     { Prefix(); Append("null"); return *this; }
+
+    JsonFrameWriter& Int(int64_t v)
+    {
+        Prefix();
+        char tmp[24];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        Append(std::string_view(tmp, static_cast<size_t>(r.ptr - tmp)));
+        return *this;
+    }
+
+    JsonFrameWriter& UInt(uint64_t v)
+    {
+        Prefix();
+        char tmp[24];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        Append(std::string_view(tmp, static_cast<size_t>(r.ptr - tmp)));
+        return *this;
+    }
+
+    // ֵNaN/InfдΪ null
+    JsonFrameWriter& Double(double v)
+    {
+        Prefix();
+        if (!std::isfinite(v)) {
+            Append("null");
+            return *this;
+        }
+        char tmp[32];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        Append(std::string_view(tmp, static_cast<size_t>(r.ptr - tmp)));
+        return *this;
+    }
+
+    // лõ JSON ƬΣԭд루÷֤Ϸ
+    JsonFrameWriter& Raw(std::string_view json) { Prefix(); Append(json); return *this; }
+
+    JsonFrameWriter& Field(std::string_view key, std::string_view v) { return Key(key).String(v); }
+    JsonFrameWriter& Field(std::string_view key, const char* v)      { return Key(key).String(v); }
+    JsonFrameWriter& Field(std::string_view key, bool v)             { return Key(key).Bool(v); }
+    JsonFrameWriter& Field(std::string_view key, int v)              { return Key(key).Int(v); }
+    JsonFrameWriter& Field(std::string_view key, int64_t v)          { return Key(key).Int(v); }
+    JsonFrameWriter& Field(std::string_view key, uint64_t v)         { return Key(key).UInt(v); }
+    JsonFrameWriter& Field(std::string_view key, double v)           { return Key(key).Double(v); }
+
+    size_t Size() const { return m_buffer ? m_buffer->Size() : 0; }
+
+    // ֡ǰ׺壬֮д
+    // ֡ʱ岻֡PipeServer ᰴƬ
+    BufferLease Finish()
+    {
+        if (m_buffer) {
+            SealFrame(*m_buffer, FrameKind::Message);
+        }
+        m_stack.clear();
+        m_afterKey = false;
+        return std::move(m_buffer);
+    }
+
+private:
+    void Push() { m_stack.push_back(0); }
+    void Pop()  { if (!m_stack.empty()) m_stack.pop_back(); }
+
+    // ͬһĵڶֵ֮ǰ
+    void Prefix()
+    {
+        if (m_afterKey) {
+            m_afterKey = false;
+            return;
+        }
+        if (!m_stack.empty()) {
+            if (m_stack.back())
+                Put(',');
+            m_stack.back() = 1;
+        }
+    }
+
+    uint8_t* Reserve(size_t n)
+    {
+        size_t size = m_buffer->Size();
+        if (size + n > m_buffer->Capacity()) {
+            // һĳػ壬ɻ黹
+            size_t want = (std::max)(m_buffer->Capacity() * 2, size + n);
+            BufferLease bigger = m_pool->Acquire(want);
+            std::memcpy(bigger->Data(), m_buffer->Data(), size);
+            m_buffer = std::move(bigger);
+        }
+        m_buffer->Resize(size + n);
+        return m_buffer->Data() + size;
+    }
+
+    void Put(char c) { *Reserve(1) = static_cast<uint8_t>(c); }
+
+    void Append(std::string_view s)
+    {
+        if (!s.empty()) {
+            std::memcpy(Reserve(s.size()), s.data(), s.size());
+        }
+    }
+
+    void Quoted(std::string_view s)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        Put('"');
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); ++i) {
+            uint8_t c = static_cast<uint8_t>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            // ַͨο
+            Append(s.substr(run, i - run));
+            run = i + 1;
+
+            switch (c) {
+            case '"':  Append("\\\""); break;
+            case '\\': Append("\\\\"); break;
+            case '\n': Append("\\n"); break;
+            case '\r': Append("\\r"); break;
+            case '\t': Append("\\t"); break;
+            case '\b': Append("\\b"); break;
+            case '\f': Append("\\f"); break;
+            default:
+            {
+                char esc[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+                Append(std::string_view(esc, sizeof(esc)));
+                break;
+            }
+            }
+        }
+        Append(s.substr(run));
+        Put('"');
+    }
+
+private:
+    std::shared_ptr<BufferPool> m_pool;
+    BufferLease             m_buffer;
+    std::vector<uint8_t>    m_stack;                    // ÿǷдֵ
+    bool                    m_afterKey = false;
+};
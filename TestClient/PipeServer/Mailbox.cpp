@@ -0,0 +1,104 @@
+#include "Mailbox.h"
+
+MailboxStore::MailboxStore(MailboxConfig config)
+    : m_config(config)
+{
+
+}
+
+bool MailboxStore::Put(const std::string& clientId, BufferLease frame, uint64_t nowMs)
+{
+    size_t size = frame->Size();
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    SweepLocked(nowMs);
+
+    if (size > m_config.maxBytes || m_bytes + size > m_config.maxTotalBytes) {
+        m_dropped++;
+        return false;
+    }
+
+    Box& box = m_boxes[clientId];
+    ExpireLocked(box, nowMs);
+    while (!box.entries.empty()
+        && (box.entries.size() >= m_config.maxMessages || box.bytes + size > m_config.maxBytes)) {
+        PopFrontLocked(box);
+        m_dropped++;
+    }
+
+    box.entries.push_back({ std::move(frame), nowMs + m_config.ttlMs });
+    box.bytes += size;
+    m_messages++;
+    m_bytes += size;
+    return true;
+}
+
+std::vector<BufferLease> MailboxStore::Take(const std::string& clientId, uint64_t nowMs)
+{
+    std::vector<BufferLease> frames;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_boxes.find(clientId);
+    if (it == m_boxes.end())
+        return frames;
+
+    Box& box = it->second;
+    ExpireLocked(box, nowMs);
+    frames.reserve(box.entries.size());
+    for (Entry& entry : box.entries) {
+        frames.push_back(std::move(entry.frame));
+    }
+    m_messages -= box.entries.size();
+    m_bytes -= box.bytes;
+    m_delivered += frames.size();
+    m_boxes.erase(it);
+    return frames;
+}
+
+MailboxStats MailboxStore::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    MailboxStats stats;
+    stats.mailboxes = m_boxes.size();
+    stats.messages = m_messages;
+    stats.bytes = m_bytes;
+    stats.delivered = m_delivered;
+    stats.dropped = m_dropped;
+    stats.expired = m_expired;
+    return stats;
+}
+
+void MailboxStore::ExpireLocked(Box& box, uint64_t nowMs)
+{
+    // ͬһ䰴˳
+    while (!box.entries.empty() && box.entries.front().expireMs <= nowMs) {
+        PopFrontLocked(box);
+        m_expired++;
+    }
+}
+
+void MailboxStore::SweepLocked(uint64_t nowMs)
+{
+    if (nowMs < m_nextSweepMs)
+        return;
+    m_nextSweepMs = nowMs + SWEEP_INTERVAL_MS;
+
+    for (auto it = m_boxes.begin(); it != m_boxes.end();) {
+        ExpireLocked(it->second, nowMs);
+        if (it->second.entries.empty()) {
+            it = m_boxes.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void MailboxStore::PopFrontLocked(Box& box)
+{
+    size_t size = box.entries.front().frame->Size();
+    box.entries.pop_front();
+    box.bytes -= size;
+    m_messages--;
+    m_bytes -= size;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "BufferPool.h"
+
+struct MailboxConfig
+{
+    uint64_t                 ttlMs = 30'000;            // Ϣеʱ
+    size_t                   maxMessages = 256;         //  clientId
+    size_t                   maxBytes = 1024 * 1024;    //  clientId
+    size_t                   maxTotalBytes = 16 * 1024 * 1024;
+};
+
+struct MailboxStats
+{
+    uint64_t                 mailboxes = 0;
+    uint64_t                 messages = 0;
+    uint64_t                 bytes = 0;                 // ǰռ
+    uint64_t                 delivered = 0;
+    uint64_t                 dropped = 0;               // ޱľϢ
+    uint64_t                 expired = 0;
+};
+
+// ==============================
+// MailboxStoreδ / δ󶨵 clientId Ϣݴڴˣʱһȡ
+// - 䳬ֽʱɵϢֽڳʱϢ
+// - Ϣڷʸʱÿȫɨһ
+// ==============================
+class MailboxStore
+{
+public:
+    explicit MailboxStore(MailboxConfig config = {});
+
+    // һѷ֡Ϣʱ false
+    bool Put(const std::string& clientId, BufferLease frame, uint64_t nowMs);
+
+    // ȡո clientId 䣨˳ѹڵĲأ
+    std::vector<BufferLease> Take(const std::string& clientId, uint64_t nowMs);
+
+    MailboxStats GetStats() const;
+
+private:
+    struct Entry
+    {
+        BufferLease          frame;
+        uint64_t             expireMs = 0;
+    };
+
+    struct Box
+    {
+        std::deque<Entry>    entries;
+        size_t               bytes = 0;
+    };
+
+    void ExpireLocked(Box& box, uint64_t nowMs);
+    void SweepLocked(uint64_t nowMs);
+    void PopFrontLocked(Box& box);
+
+private:
+    static constexpr uint64_t SWEEP_INTERVAL_MS = 1000;
+
+    MailboxConfig           m_config;
+
+    mutable std::mutex      m_mutex;
+    std::unordered_map<std::string, Box> m_boxes;
+    size_t                  m_messages = 0;
+    size_t                  m_bytes = 0;
+    uint64_t                m_nextSweepMs = 0;
+
+    uint64_t                m_delivered = 0;
+    uint64_t                m_dropped = 0;
+    uint64_t                m_expired = 0;
+};
@@ -0,0 +1,136 @@
+#include "PayloadCodec.h"
+#include <windows.h>
+#include <compressapi.h>
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    // ѹܲʹãÿ߳һ
+    struct XpressCompressor
+    {
+        COMPRESSOR_HANDLE handle = nullptr;
+        XpressCompressor() { CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &handle); }
+        ~XpressCompressor() { if (handle) CloseCompressor(handle); }
+    };
+
+    struct XpressDecompressor
+    {
+        DECOMPRESSOR_HANDLE handle = nullptr;
+        XpressDecompressor() { CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &handle); }
+        ~XpressDecompressor() { if (handle) CloseDecompressor(handle); }
+    };
+
+    BufferLease CopySealed(BufferPool& pool, const std::vector<uint8_t>& data, FrameKind kind)
+    {
+        BufferLease buffer = pool.Copy(data.data(), data.size());
+        SealFrame(*buffer, kind);
+        return buffer;
+    }
+
+    BufferLease CompressMessage(BufferPool& pool, const BufferLease& message)
+    {
+        thread_local XpressCompressor compressor;
+        if (!compressor.handle)
+            return message;
+
+        // СΪѹԭ
+        // Compressed ֡ 4 ֽԭʼȣó FRAGMENT_SIZEᱻƬͶʧ֡ͣ
+        // óȵϢֱһעʧܵѹ
+        size_t size = message->Size();
+        if (size > FRAGMENT_SIZE - sizeof(uint32_t))
+            return message;
+        BufferLease frame = pool.Acquire(sizeof(uint32_t) + size);
+        SIZE_T compressed = 0;
+        if (!::Compress(compressor.handle, message->Data(), size,
+            frame->Data() + sizeof(uint32_t), size, &compressed) || compressed >= size) {
+            return message;
+        }
+
+        uint32_t original = static_cast<uint32_t>(size);
+        std::memcpy(frame->Data(), &original, sizeof(original));
+        frame->Resize(sizeof(uint32_t) + compressed);
+        SealFrame(*frame, FrameKind::Compressed);
+        return frame;
+    }
+}
+
+const char* EncodingName(PayloadEncoding encoding)
+{
+    switch (encoding) {
+    case PayloadEncoding::Cbor:         return "cbor";
+    case PayloadEncoding::MessagePack:  return "msgpack";
+    default:                            return "json";
+    }
+}
+
+const char* CompressionName(PayloadCompression compression)
+{
+    return compression == PayloadCompression::Xpress ? "xpress" : "none";
+}
+
+bool ParseEncoding(std::string_view name, PayloadEncoding& encoding)
+{
+    if (name == "json")         encoding = PayloadEncoding::Json;
+    else if (name == "cbor")    encoding = PayloadEncoding::Cbor;
+    else if (name == "msgpack") encoding = PayloadEncoding::MessagePack;
+    else return false;
+    return true;
+}
+
+bool ParseCompression(std::string_view name, PayloadCompression& compression)
+{
+    if (name == "none")         compression = PayloadCompression::None;
+    else if (name == "xpress")  compression = PayloadCompression::Xpress;
+    else return false;
+    return true;
+}
+
+BufferLease EncodeOutbound(BufferPool& pool, const BufferLease& message,
+    PayloadEncoding encoding, PayloadCompression compression)
+{
+    BufferLease encoded = message;
+    if (encoding != PayloadEncoding::Json) {
+        auto json = nlohmann::json::parse(message->Data(), message->Data() + message->Size(), nullptr, false);
+        if (!json.is_discarded()) {
+            encoded = CopySealed(pool, encoding == PayloadEncoding::Cbor
+                ? nlohmann::json::to_cbor(json) : nlohmann::json::to_msgpack(json), FrameKind::Message);
+        }
+    }
+
+    if (compression == PayloadCompression::Xpress && encoded->Size() >= COMPRESS_MIN_SIZE) {
+        return CompressMessage(pool, encoded);
+    }
+    return encoded;
+}
+
+BufferLease DecodeInbound(BufferPool& pool, const uint8_t* data, size_t size, PayloadEncoding encoding)
+{
+    auto json = encoding == PayloadEncoding::Cbor
+        ? nlohmann::json::from_cbor(data, data + size, true, false)
+        : nlohmann::json::from_msgpack(data, data + size, true, false);
+    if (json.is_discarded())
+        return nullptr;
+
+    std::string text = json.dump();
+    return pool.Copy(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+BufferLease Decompress(BufferPool& pool, const uint8_t* data, size_t size)
+{
+    thread_local XpressDecompressor decompressor;
+    if (!decompressor.handle || size < sizeof(uint32_t))
+        return nullptr;
+
+    uint32_t original = ReadU32(data);
+    if (original > MAX_REASSEMBLED_SIZE)
+        return nullptr;
+
+    BufferLease message = pool.Acquire(original);
+    SIZE_T produced = 0;
+    if (!::Decompress(decompressor.handle, data + sizeof(uint32_t), size - sizeof(uint32_t),
+        message->Data(), original, &produced) || produced != original) {
+        return nullptr;
+    }
+    return message;
+}
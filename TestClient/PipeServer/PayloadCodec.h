@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include "BufferPool.h"
+#include "FrameCodec.h"
+
+// Ϣصı루Hello/Welcome Э̣ڹ̶
+// - ϲʼմ JSON ı JSON շ߽ת
+enum class PayloadEncoding : uint8_t
+{
+    Json,
+    Cbor,
+    MessagePack,
+};
+
+// ϢѹHello/Welcome Э̣ѹϢ Compressed ֡ͣ˫
+enum class PayloadCompression : uint8_t
+{
+    None,
+    Xpress,                     // Windows Compression APIXPRESS_HUFF
+};
+
+// öֵڰ  x ѹ ıöֵʱ
+constexpr size_t PAYLOAD_ENCODING_COUNT = static_cast<size_t>(PayloadEncoding::MessagePack) + 1;
+constexpr size_t PAYLOAD_COMPRESSION_COUNT = static_cast<size_t>(PayloadCompression::Xpress) + 1;
+
+constexpr size_t COMPRESS_MIN_SIZE = 1024;  // Сڴ˴СϢѹ
+
+const char* EncodingName(PayloadEncoding encoding);
+const char* CompressionName(PayloadCompression compression);
+bool ParseEncoding(std::string_view name, PayloadEncoding& encoding);
+bool ParseCompression(std::string_view name, PayloadCompression& compression);
+
+// ͷѷ֡ JSON Ϣ -> Э̵ı룬ﵽ COMPRESS_MIN_SIZE ѹЧʱٷΪ Compressed ֡
+// - JSON Ҳѹʱԭͬһ壨㿽ɼڿͻ֮乲
+// - زǺϷ JSON ʱת
+// - Ϣ 4 ֽԭʼȳ FRAGMENT_SIZE ĲѹCompressed ֡Ƭ
+BufferLease EncodeOutbound(BufferPool& pool, const BufferLease& message,
+    PayloadEncoding encoding, PayloadCompression compression);
+
+// շЭ̱ĸ -> JSON ıδ֡ʧܷؿ
+BufferLease DecodeInbound(BufferPool& pool, const uint8_t* data, size_t size, PayloadEncoding encoding);
+
+// Compressed ֡ -> ԭϢδ֡ʽ򳬹 MAX_REASSEMBLED_SIZE ʱؿ
+BufferLease Decompress(BufferPool& pool, const uint8_t* data, size_t size);
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <span>
+#include "BufferPool.h"
+
+// ==============================
+// յϢܵʵ޹أŷȡֻͷļ
+// ʱӣ
+// - timestampMs / deadlineMsUTC 루Unix Ԫŷе timestamp / deadline ͬһʱ
+// - receivedUssteady clock ΢룬ֻڼŶʱ
+// ==============================
+
+// FILETIME1601-01-01  100 תΪ UTC 루Unix Ԫ
+inline uint64_t FileTimeToUnixMs(uint64_t fileTime)
+{
+    constexpr uint64_t UNIX_EPOCH_FILETIME = 116444736000000000ULL;
+    return fileTime > UNIX_EPOCH_FILETIME ? (fileTime - UNIX_EPOCH_FILETIME) / 10000ULL : 0;
+}
+
+// Ϣṹ4ֽڳǰ׺ + ʵ
+struct PipeMessage
+{
+    std::string              clientId;
+    std::vector<uint8_t>     payload;
+    uint64_t                 timestampMs;
+    uint64_t                 receivedUs = 0;            // նʱ̣steady clock΢룩ڼŶʱ
+    uint64_t                 deadlineMs = 0;            //  ServiceManager ʱŷ0 ʾ
+};
+
+// 㿽գpayload ӽջֻͼlease ڼЧ
+// - ͷ lease Release󻺳յ
+// - ԭתʱ lease  SendToClient/Broadcast
+struct PipeMessageView
+{
+    std::string              clientId;
+    std::span<const uint8_t> payload;
+    uint64_t                 timestampMs = 0;
+    uint64_t                 receivedUs = 0;
+    BufferLease              lease;
+
+    void Release()
+    {
+        payload = {};
+        lease.reset();
+    }
+};
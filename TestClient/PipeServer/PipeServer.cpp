@@ -1,13 +1,23 @@
 #include "PipeServer.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <nlohmann/json.hpp>
 
+// UTC 루Unix Ԫ Envelope.h  UtcNowMs ŷе deadline ͬһʱ
 static uint64_t NowMs() {
     FILETIME ft;
     GetSystemTimeAsFileTime(&ft);
     ULARGE_INTEGER uli;
     uli.LowPart = ft.dwLowDateTime;
     uli.HighPart = ft.dwHighDateTime;
-    return static_cast<uint64_t>(uli.QuadPart / 10000ULL);
+    return FileTimeToUnixMs(uli.QuadPart);
+}
+
+static uint64_t NowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
 }
 
 static void Log(const char* s) {
@@ -21,10 +31,155 @@ static HANDLE MakeAutoResetEvent() {
     return CreateEvent(NULL, FALSE, FALSE, NULL);
 }
 
+// ѴϢһƬ׷ӵ outǷΪһƬ
+static bool AppendNextFragment(OutboundMessage& msg, std::vector<uint8_t>& out) {
+    const uint8_t* data = msg.buffer->Data();
+    size_t size = (std::min)(FRAGMENT_SIZE, msg.buffer->Size() - msg.offset);
+    bool last = msg.offset + size == msg.buffer->Size();
+
+    AppendU32(out, MakeFrameHeader(FrameKind::Fragment, static_cast<uint32_t>(FRAGMENT_HEADER_SIZE + size)));
+    AppendU32(out, msg.streamId);
+    out.push_back(last ? FRAGMENT_FLAG_LAST : 0);
+    out.insert(out.end(), data + msg.offset, data + msg.offset + size);
+
+    msg.offset += size;
+    return last;
+}
+
+// Ͷȣ ClientContext::creditFlowʼһϢҪϢֽڶȣƬֻֽڶ
+static bool HasMessageCredit(const ClientContext& ctx) {
+    return !ctx.creditFlow || (ctx.creditMessages > 0 && ctx.creditBytes > 0);
+}
+
+static bool HasByteCredit(const ClientContext& ctx) {
+    return !ctx.creditFlow || ctx.creditBytes > 0;
+}
+
+static bool CanSendFragment(const ClientContext& ctx, const OutboundMessage& msg) {
+    return msg.offset > 0 ? HasByteCredit(ctx) : HasMessageCredit(ctx);
+}
+
+// Hello ŷֶεĿɶȡȱʧͲʱȡĬֵ
+static const nlohmann::json& ObjectField(const nlohmann::json& obj, const char* key) {
+    static const nlohmann::json empty = nlohmann::json::object();
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_object() ? *it : empty;
+}
+
+static std::string StringField(const nlohmann::json& obj, const char* key) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_string() ? it->get<std::string>() : std::string();
+}
+
+static uint64_t UintField(const nlohmann::json& obj, const char* key, uint64_t fallback) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_number_unsigned() ? it->get<uint64_t>() : fallback;
+}
+
+static bool BoolField(const nlohmann::json& obj, const char* key) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->is_boolean() && it->get<bool>();
+}
+
+//  64 λַݣJSON ڲֿͻϻᶪȣҲ
+static uint64_t TokenField(const nlohmann::json& obj, const char* key) {
+    auto it = obj.find(key);
+    if (it == obj.end())
+        return 0;
+    if (it->is_number_unsigned())
+        return it->get<uint64_t>();
+    if (!it->is_string())
+        return 0;
+    const std::string& text = it->get_ref<const std::string&>();
+    uint64_t token = 0;
+    std::from_chars(text.data(), text.data() + text.size(), token);
+    return token;
+}
+
+static std::vector<uint8_t> EncodeJsonFrame(const nlohmann::json& envelope) {
+    std::string text = envelope.dump();
+    std::vector<uint8_t> frame;
+    EncodeFrame(frame, FrameKind::Message, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    return frame;
+}
+
+// token Ϊ 0Hello δ resumeʼỰʱ· resumeToken
+static std::vector<uint8_t> EncodeWelcome(const nlohmann::json& msgId, const std::string& clientId, uint64_t token,
+    const ConnectionSettings& settings, bool resumed, uint64_t received) {
+    nlohmann::json payload = {
+        { "clientId", clientId },
+        { "resumed", resumed },
+        { "received", received },
+        { "settings", {
+            { "maxFrameSize", settings.maxFrameSize },
+            { "encoding", EncodingName(settings.encoding) },
+            { "compression", CompressionName(settings.compression) },
+            { "batch", settings.batching },
+            { "heartbeatMs", settings.heartbeatMs },
+        } },
+    };
+    if (token != 0) {
+        payload["resumeToken"] = std::to_string(token);
+    }
+    return EncodeJsonFrame({
+        { "ver", "1.0" },
+        { "type", "Welcome" },
+        { "msgId", msgId },
+        { "clientId", clientId },
+        { "timestamp", NowMs() },
+        { "payload", std::move(payload) },
+    });
+}
+
+static std::vector<uint8_t> SessionFrame(const PipeSession& session, uint64_t received) {
+    std::vector<uint8_t> frame;
+    EncodeSession(frame, session.token, received);
+    return frame;
+}
+
+// ֡ͣѷ֡Ļ֡ͷͷ
+static bool IsMessageFrame(const BufferLease& buffer) {
+    return HeaderKind(ReadU32(buffer->FrameData())) == FrameKind::Message;
+}
+
+//  FRAGMENT_SIZE ϢƬͣģʽֻ Message ֡ϢҲ֡д
+static bool IsBulk(const ClientContext& ctx, const BufferLease& buffer) {
+    return !ctx.settings.legacy && buffer->Size() > FRAGMENT_SIZE;
+}
+
+// ģʽ޷ճ֡޵ϢܷƬ¼
+static bool DropOversized(const ClientContext& ctx, const BufferLease& buffer) {
+    if (!ctx.settings.legacy || buffer->Size() <= MAX_FRAME_LENGTH)
+        return false;
+    Log(("Message of " + std::to_string(buffer->Size()) + " bytes exceeds MAX_FRAME_LENGTH for legacy client "
+        + ctx.clientId + ", dropped").c_str());
+    return true;
+}
+
+// СϢӣֵϢͬʱָͬ key ĸϢ
+static void PopSmall(ClientContext& ctx) {
+    OutboundMessage& msg = ctx.sendQueue.front();
+    if (!msg.conflationKey.empty()) {
+        auto it = ctx.conflated.find(msg.conflationKey);
+        if (it != ctx.conflated.end() && it->second == &msg) {
+            ctx.conflated.erase(it);
+        }
+    }
+    ctx.sendQueue.pop_front();
+}
+
+static void ChargeCredit(ClientContext& ctx, uint64_t messages, size_t bytes) {
+    if (!ctx.creditFlow)
+        return;
+    ctx.creditMessages -= (std::min)(ctx.creditMessages, messages);
+    ctx.creditBytes -= static_cast<int64_t>(bytes);
+}
+
 PipeServer::PipeServer(const std::wstring& pipeName, size_t maxInstances, size_t bufferSize)
     : m_pipeName(pipeName)
     , m_maxInstances(maxInstances)
     , m_bufferSize(bufferSize)
+    , m_pool(BufferPool::Create())
 {
 
 }
@@ -68,28 +223,36 @@ void PipeServer::Stop()
 
 bool PipeServer::SendToClient(const std::string& clientId, const std::vector<uint8_t>& payload)
 {
+    return SendToClient(clientId, MakeOutbound(payload));
+}
+
+bool PipeServer::SendToClient(const std::string& clientId, BufferLease buffer)
+{
+    return SendLatestToClient(clientId, {}, std::move(buffer));
+}
+
+bool PipeServer::SendLatestToClient(const std::string& clientId, const std::string& conflationKey, BufferLease buffer)
+{
+    if (!buffer)
+        return false;
+
+    // δ֡Ļڹǰֻ֮֡
+    if (!buffer->IsSealed()) {
+        SealFrame(*buffer, FrameKind::Message);
+    }
+
+    // ͬһ£ BindClientId ȡ以⣬Ϣڸȡյ
     std::shared_ptr<ClientContext> ctx;
     {
         std::lock_guard<std::mutex> lk(m_clientsMutex);
         auto it = m_clients.find(clientId);
-        if (it == m_clients.end())
-            return false;
+        if (it == m_clients.end() || !it->second) {
+            return m_mailboxes.Put(clientId, std::move(buffer), NowMs());
+        }
         ctx = it->second;
     }
 
-    if (!ctx)
-        return false;
-
-    {
-        std::lock_guard<std::mutex> lk(ctx->sendMutex);
-        PipeMessage msg;
-        msg.clientId = clientId;
-        msg.payload = payload;
-        msg.timestampMs = NowMs();
-        ctx->sendQueue.push(std::move(msg));
-    }
-
-    ctx->sendCv.notify_one();
+    EnqueueOutbound(*ctx, EncodeFor(ctx->settings, buffer), conflationKey);
     return true;
 }
 
@@ -98,8 +261,32 @@ bool PipeServer::SendJsonToClient(const std::string& clientId, const std::string
     return SendToClient(clientId, std::vector<uint8_t>(jsonUtf8.begin(), jsonUtf8.end()));
 }
 
+bool PipeServer::SendLatestJsonToClient(const std::string& clientId, const std::string& conflationKey, const std::string& jsonUtf8)
+{
+    return SendLatestToClient(clientId, conflationKey,
+        MakeOutbound(std::vector<uint8_t>(jsonUtf8.begin(), jsonUtf8.end())));
+}
+
 size_t PipeServer::Broadcast(const std::vector<uint8_t>& payload)
 {
+    // ֻһΣпͻ˹ͬһ
+    return Broadcast(MakeOutbound(payload));
+}
+
+size_t PipeServer::Broadcast(BufferLease buffer)
+{
+    return BroadcastLatest({}, std::move(buffer));
+}
+
+size_t PipeServer::BroadcastLatest(const std::string& conflationKey, BufferLease buffer)
+{
+    if (!buffer)
+        return 0;
+
+    if (!buffer->IsSealed()) {
+        SealFrame(*buffer, FrameKind::Message);
+    }
+
     size_t cnt = 0;
     std::vector<std::shared_ptr<ClientContext>> clients;
 
@@ -112,17 +299,16 @@ size_t PipeServer::Broadcast(const std::vector<uint8_t>& payload)
         }
     }
 
+    // Э̵ĸʽתͬһʽĿͻ˹ͬһݽ
+    BufferLease encoded[PAYLOAD_ENCODING_COUNT][PAYLOAD_COMPRESSION_COUNT];
     for (auto& ctx : clients)
     {
-        {
-            std::lock_guard<std::mutex> lk(ctx->sendMutex);
-            PipeMessage msg;
-            msg.clientId = ctx->clientId;
-            msg.payload = payload;
-            msg.timestampMs = NowMs();
-            ctx->sendQueue.push(std::move(msg));
+        const ConnectionSettings& settings = ctx->settings;
+        BufferLease& shared = encoded[static_cast<size_t>(settings.encoding)][static_cast<size_t>(settings.compression)];
+        if (!shared) {
+            shared = EncodeFor(settings, buffer);
         }
-        ctx->sendCv.notify_one();
+        EnqueueOutbound(*ctx, shared, conflationKey);
         cnt++;
     }
 
@@ -136,7 +322,31 @@ size_t PipeServer::BroadcastJson(const std::string& jsonUtf8)
 
 bool PipeServer::TryPopReceived(PipeMessage& msg)
 {
-    std::lock_guard<std::mutex> lk(m_recvMutex);  
+    PipeMessageView view;
+    if (!TryPopReceivedView(view))
+        return false;
+    msg.clientId = std::move(view.clientId);
+    msg.payload.assign(view.payload.begin(), view.payload.end());
+    msg.timestampMs = view.timestampMs;
+    msg.receivedUs = view.receivedUs;
+    return true;
+}
+
+bool PipeServer::WaitAndPopReceived(PipeMessage& msg)
+{
+    PipeMessageView view;
+    if (!WaitAndPopReceivedView(view))
+        return false;
+    msg.clientId = std::move(view.clientId);
+    msg.payload.assign(view.payload.begin(), view.payload.end());
+    msg.timestampMs = view.timestampMs;
+    msg.receivedUs = view.receivedUs;
+    return true;
+}
+
+bool PipeServer::TryPopReceivedView(PipeMessageView& msg)
+{
+    std::lock_guard<std::mutex> lk(m_recvMutex);
     if (m_receiveData.empty())
         return false;
     msg = std::move(m_receiveData.front());
@@ -144,7 +354,7 @@ bool PipeServer::TryPopReceived(PipeMessage& msg)
     return true;
 }
 
-bool PipeServer::WaitAndPopReceived(PipeMessage& msg)
+bool PipeServer::WaitAndPopReceivedView(PipeMessageView& msg)
 {
     std::unique_lock<std::mutex> lk(m_recvMutex);
     m_recvCv.wait(lk, [&] {
@@ -163,6 +373,56 @@ void PipeServer::SetMessageHandler(MessageHandler handler)
     m_handler = std::move(handler);
 }
 
+void PipeServer::SetBatchConfig(BatchConfig config)
+{
+    m_batchConfig = config;
+}
+
+uint32_t PipeServer::OpenStream(const std::string& clientId, const std::string& metaJson,
+    std::shared_ptr<StreamProducer> producer)
+{
+    if (!producer)
+        return 0;
+
+    std::shared_ptr<ClientContext> ctx;
+    {
+        std::lock_guard<std::mutex> lk(m_clientsMutex);
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end())
+            return 0;
+        ctx = it->second;
+    }
+
+    if (!ctx)
+        return 0;
+
+    uint32_t streamId = 0;
+    {
+        // ģʽֻ Message ֡ܽշֿ
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        if (ctx->settings.legacy)
+            return 0;
+        streamId = ctx->nextStreamId++;
+
+        // StreamOpen ֡ڴ˱ƶУ֤Ԫݿ鵽
+        std::vector<uint8_t> open;
+        EncodeStreamOpen(open, streamId, producer->TotalSize(), metaJson);
+        ctx->controlQueue.push(std::move(open));
+
+        OutboundStream stream;
+        stream.producer = std::move(producer);
+        ctx->outStreams.emplace(streamId, std::move(stream));
+    }
+
+    ctx->sendCv.notify_one();
+    return streamId;
+}
+
+void PipeServer::SetStreamAcceptor(StreamAcceptor acceptor)
+{
+    m_streamAcceptor = std::move(acceptor);
+}
+
 std::vector<std::string> PipeServer::ListClients() const
 {
     std::vector<std::string> ids;
@@ -194,6 +454,30 @@ void PipeServer::DisconnectClient(const std::string& clientId)
         CloseClient(ctx);
 }
 
+PipeServerStats PipeServer::GetStats() const
+{
+    PipeServerStats stats;
+    stats.messagesSent = m_messagesSent.load(std::memory_order_relaxed);
+    stats.fragmentsSent = m_fragmentsSent.load(std::memory_order_relaxed);
+    stats.bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+    stats.writes = m_writes.load(std::memory_order_relaxed);
+    stats.creditStalls = m_creditStalls.load(std::memory_order_relaxed);
+    stats.conflated = m_conflated.load(std::memory_order_relaxed);
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    stats.batchedMessages = m_batchedMessages.load(std::memory_order_relaxed);
+    stats.handshakes = m_handshakes.load(std::memory_order_relaxed);
+    stats.legacyClients = m_legacyClients.load(std::memory_order_relaxed);
+    stats.heartbeatTimeouts = m_heartbeatTimeouts.load(std::memory_order_relaxed);
+    stats.smallP50Us = m_smallLatency.Percentile(50);
+    stats.smallP99Us = m_smallLatency.Percentile(99);
+    stats.smallP99UsUnderBulk = m_smallLatencyUnderBulk.Percentile(99);
+    stats.poolLeasedBytes = m_pool->LeasedBytes();
+    stats.poolIdleBytes = m_pool->IdleBytes();
+    stats.sessions = m_sessions.GetStats();
+    stats.mailbox = m_mailboxes.GetStats();
+    return stats;
+}
+
 HANDLE PipeServer::CreatePipeInstance()
 {
     HANDLE hPipe = CreateNamedPipeW(
@@ -268,17 +552,22 @@ void PipeServer::HandleClientCommunication(std::shared_ptr<ClientContext> ctx)
 
 void PipeServer::HandleClientRead(std::shared_ptr<ClientContext> ctx)
 {
-    const size_t BUFFER_SIZE = 8192;
-    std::vector<uint8_t> buffer(BUFFER_SIZE);
-    std::vector<uint8_t> messageBuffer;
+    // ֡ȡԹأϢӺʹ÷Լ꼴
+    FrameDecoder decoder(m_pool, MAX_FRAME_LENGTH);
+    FragmentAssembler fragments(m_pool);
+    uint64_t lastReadUs = NowUs();
 
     while (ctx->running.load() && m_running.load())
     {
+        // С֡ݴ֡ʣಿֱӶ֡
+        size_t capacity = 0;
+        uint8_t* target = decoder.ReadTarget(capacity);
+
         DWORD bytesRead = 0;
         BOOL success = ReadFile(
             ctx->hPipe,
-            buffer.data(),
-            static_cast<DWORD>(buffer.size()),
+            target,
+            static_cast<DWORD>(capacity),
             &bytesRead,
             &ctx->ovRead
         );
@@ -287,7 +576,8 @@ void PipeServer::HandleClientRead(std::shared_ptr<ClientContext> ctx)
             DWORD err = GetLastError();
             if (err == ERROR_IO_PENDING) {
                 // ȴ첽
-                DWORD waitResult = WaitForSingleObject(ctx->hReadEvent, 5000);
+                uint32_t heartbeatMs = ctx->settings.heartbeatMs;
+                DWORD waitResult = WaitForSingleObject(ctx->hReadEvent, heartbeatMs ? (std::min)(5000u, heartbeatMs) : 5000);
                 if (waitResult == WAIT_OBJECT_0) {
                     if (!GetOverlappedResult(ctx->hPipe, &ctx->ovRead, &bytesRead, FALSE)) {
                         Log("GetOverlappedResult failed on read");
@@ -295,9 +585,17 @@ void PipeServer::HandleClientRead(std::shared_ptr<ClientContext> ctx)
                     }
                 }
                 else if (waitResult == WAIT_TIMEOUT) {
-                    // ʱѭ
+                    // ʱȡѭȡǰѶݲܶ
                     CancelIoEx(ctx->hPipe, &ctx->ovRead);
-                    continue;
+                    if (!GetOverlappedResult(ctx->hPipe, &ctx->ovRead, &bytesRead, TRUE) || bytesRead == 0) {
+                        // Эӣ HEARTBEAT_MISSES ղκݼΪʧ
+                        if (heartbeatMs && NowUs() - lastReadUs > uint64_t(HEARTBEAT_MISSES) * heartbeatMs * 1000) {
+                            Log("Heartbeat timeout, disconnecting client");
+                            m_heartbeatTimeouts.fetch_add(1, std::memory_order_relaxed);
+                            break;
+                        }
+                        continue;
+                    }
                 }
                 else {
                     Log("WaitForSingleObject failed");
@@ -314,138 +612,986 @@ void PipeServer::HandleClientRead(std::shared_ptr<ClientContext> ctx)
             Log("Client disconnected (read 0 bytes)");
             break;
         }
+        lastReadUs = NowUs();
 
-        // ۻϢ
-        messageBuffer.insert(messageBuffer.end(), buffer.begin(), buffer.begin() + bytesRead);
-
-        // ϢЭ飺4ֽڳ + ݣ
-        while (messageBuffer.size() >= 4) {
-            uint32_t msgLen = *reinterpret_cast<uint32_t*>(messageBuffer.data());
+        // ֹⳬϢ֡ޣʹ÷ֿ
+        if (!decoder.Commit(bytesRead)) {
+            Log("Message too large, disconnecting client");
+            break;
+        }
 
-            // ֹⳬϢ
-            if (msgLen > 10 * 1024 * 1024) {  // 10MB 
-                Log("Message too large, disconnecting client");
-                ctx->running = false;
-                break;
+        Frame frame;
+        while (decoder.Next(frame)) {
+            if (frame.kind == FrameKind::Message) {
+                ProcessReceivedMessage(ctx, std::move(frame.buffer));
             }
-
-            if (messageBuffer.size() < 4 + msgLen) {
-                // Ϣȡ
-                break;
+            else if (frame.kind == FrameKind::Fragment) {
+                ProcessFragment(ctx, fragments, frame);
             }
+            else if (frame.kind == FrameKind::Resume || frame.kind == FrameKind::Ack) {
+                ProcessSessionFrame(ctx, frame);
+            }
+            else if (frame.kind == FrameKind::Credit) {
+                ProcessCreditFrame(ctx, frame);
+            }
+            else if (frame.kind == FrameKind::Batch) {
+                ProcessBatchFrame(ctx, frame);
+            }
+            else if (frame.kind == FrameKind::Compressed) {
+                ProcessCompressedFrame(ctx, frame);
+            }
+            else {
+                ProcessStreamFrame(ctx, frame);
+            }
+        }
 
-            // ȡϢ
-            std::vector<uint8_t> payload(
-                messageBuffer.begin() + 4,
-                messageBuffer.begin() + 4 + msgLen
-            );
-
-            // Ϣ
-            ProcessReceivedMessage(ctx, payload);
+        // ֺЭ̵ĵ֮֡յ֡
+        decoder.SetMaxFrameLength(ctx->settings.maxFrameSize);
+    }
 
-            // ƳѴϢ
-            messageBuffer.erase(messageBuffer.begin(), messageBuffer.begin() + 4 + msgLen);
-        }
+    // ӶϿ֪ͨδĽ
+    for (auto& kv : ctx->inStreams) {
+        kv.second.consumer->OnEnd(false);
     }
+    ctx->inStreams.clear();
 
     ctx->running = false;
 }
 
 void PipeServer::HandleClientWrite(std::shared_ptr<ClientContext> ctx)
 {
+    WriteBatch batch;
+
     while (ctx->running.load() && m_running.load())
     {
-        PipeMessage msg;
+        batch.bytes.clear();
+        batch.direct.reset();
+        batch.smallEnqueueUs.clear();
+        batch.bulkActive = false;
+        batch.backlog = 0;
+        batch.batched = 0;
+        batch.fragments = 0;
+
+        if (!NextWriteBatch(*ctx, batch)) {
+            continue;
+        }
 
-        // ȴͶ
-        {
-            std::unique_lock<std::mutex> lk(ctx->sendMutex);
-            ctx->sendCv.wait_for(lk, std::chrono::milliseconds(100), [&] {
-                return !ctx->sendQueue.empty() || !ctx->running.load();
-                });
+        bool ok = batch.direct
+            ? WriteToPipe(ctx, batch.direct->FrameData(), batch.direct->FrameSize())
+            : WriteToPipe(ctx, batch.bytes.data(), batch.bytes.size());
+        if (!ok) {
+            break;
+        }
+
+        RecordWrite(batch);
+    }
+
+    ctx->running = false;
+}
+
+// ݿػ岢֡·Ψһһο
+BufferLease PipeServer::MakeOutbound(const std::vector<uint8_t>& payload)
+{
+    BufferLease buffer = m_pool->Copy(payload.data(), payload.size());
+    SealFrame(*buffer, FrameKind::Message);
+    return buffer;
+}
+
+// Э̵ı/ѹתϢJSON Ҳѹģʽʱԭ
+BufferLease PipeServer::EncodeFor(const ConnectionSettings& settings, const BufferLease& buffer)
+{
+    if (settings.encoding == PayloadEncoding::Json && settings.compression == PayloadCompression::None)
+        return buffer;
+    return EncodeOutbound(*m_pool, buffer, settings.encoding, settings.compression);
+}
+
+// buffer Ѱӵĸʽת EncodeFor
+void PipeServer::EnqueueOutbound(ClientContext& ctx, BufferLease buffer, const std::string& conflationKey)
+{
+    {
+        std::lock_guard<std::mutex> lk(ctx.sendMutex);
+        if (DropOversized(ctx, buffer))
+            return;
+        if (!conflationKey.empty() && ConflateLocked(ctx, conflationKey, buffer))
+            return;
+        QueueOutboundLocked(ctx, std::move(buffer), conflationKey);
+    }
+    ctx.sendCv.notify_one();
+}
+
+void PipeServer::QueueOutboundLocked(ClientContext& ctx, BufferLease buffer, const std::string& conflationKey)
+{
+    OutboundMessage msg;
+    msg.buffer = std::move(buffer);
+    msg.enqueueUs = NowUs();
+
+    // Ϣ߼ IDƬϢͣͷ
+    if (IsBulk(ctx, msg.buffer)) {
+        msg.streamId = ctx.nextStreamId++;
+        ctx.bulkQueue.push_back(std::move(msg));
+    }
+    else {
+        msg.conflationKey = conflationKey;
+        ctx.sendQueue.push_back(std::move(msg));
+        // deque ˲ɾӰԪصĵַ
+        if (!conflationKey.empty()) {
+            ctx.conflated[conflationKey] = &ctx.sendQueue.back();
+        }
+    }
+}
+
+// ͬ key ֵϢ sendQueue ʱԭλ滻Ŷλʱ̣ true
+// ֵǴϢʱճƬŶӣ֮ĸ´Ӷβ
+bool PipeServer::ConflateLocked(ClientContext& ctx, const std::string& conflationKey, BufferLease& buffer)
+{
+    auto it = ctx.conflated.find(conflationKey);
+    if (it == ctx.conflated.end())
+        return false;
+
+    if (IsBulk(ctx, buffer)) {
+        ctx.conflated.erase(it);
+        return false;
+    }
 
-            if (!ctx->running.load()) {
+    it->second->buffer = std::move(buffer);
+    m_conflated.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// ѹϢСϢڰ󶨺ϲΪһд룬ϢճƬ
+void PipeServer::QueueBacklogLocked(ClientContext& ctx, BufferLease buffer)
+{
+    if (DropOversized(ctx, buffer))
+        return;
+    if (IsBulk(ctx, buffer)) {
+        QueueOutboundLocked(ctx, std::move(buffer));
+        return;
+    }
+
+    OutboundMessage msg;
+    msg.buffer = std::move(buffer);
+    msg.enqueueUs = NowUs();
+    ctx.backlogQueue.push_back(std::move(msg));
+}
+
+// Ϣдʱţд˳򼴿ͻ˳򣨴ϢһƬΪ׼
+void PipeServer::RecordSentLocked(ClientContext& ctx, const BufferLease& buffer)
+{
+    if (ctx.session) {
+        std::lock_guard<std::mutex> lk(ctx.session->mutex);
+        ctx.session->replay.Append(buffer);
+    }
+}
+
+// ȡһд
+// - ֡ϸȣԭ˳򣩣ٴǰǰѹϢһд
+// - СϢСÿϢÿжȵһͨתƽ
+// - ÿͨÿдԼ FRAGMENT_SIZE ֽڣСϢĵȴʱϢС޹
+// - ͻ˿غûжȵͨȣҲỽѷ߳
+// - Э Batch ӣСϢͨںϲڣ BatchConfigڻžΪһ Batch ֡
+bool PipeServer::NextWriteBatch(ClientContext& ctx, WriteBatch& batch)
+{
+    uint32_t streamId = 0;
+    std::shared_ptr<StreamProducer> producer;
+    size_t chunkSize = 0;
+
+    {
+        std::unique_lock<std::mutex> lk(ctx.sendMutex);
+
+        auto readyStreams = [&]() {
+            size_t n = 0;
+            for (auto& kv : ctx.outStreams) {
+                if (kv.second.credit > 0)
+                    ++n;
+            }
+            return n;
+        };
+
+        auto readyBulk = [&]() {
+            size_t n = 0;
+            for (const OutboundMessage& msg : ctx.bulkQueue) {
+                if (CanSendFragment(ctx, msg))
+                    ++n;
+            }
+            return n;
+        };
+
+        auto smallReady = [&]() {
+            if (ctx.sendQueue.empty() || !HasMessageCredit(ctx))
+                return false;
+            if (!ctx.settings.batching || NowUs() >= ctx.sendQueue.front().enqueueUs + m_batchConfig.maxDelayUs)
+                return true;
+
+            size_t count = 0;
+            size_t bytes = 0;
+            for (const OutboundMessage& msg : ctx.sendQueue) {
+                bytes += msg.buffer->FrameSize();
+                if (++count >= m_batchConfig.maxMessages || bytes >= m_batchConfig.maxBytes)
+                    return true;
+            }
+            return false;
+        };
+
+        // ȴͶпɷ͵ݣСϢںϲʱȵڵ
+        auto waitEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        while (!(!ctx.controlQueue.empty() || !ctx.replayQueue.empty()
+            || (HasMessageCredit(ctx) && !ctx.backlogQueue.empty())
+            || smallReady() || readyBulk() > 0 || readyStreams() > 0 || !ctx.running.load())) {
+            auto until = waitEnd;
+            if (ctx.settings.batching && !ctx.sendQueue.empty() && HasMessageCredit(ctx)) {
+                auto due = std::chrono::steady_clock::time_point(
+                    std::chrono::microseconds(ctx.sendQueue.front().enqueueUs + m_batchConfig.maxDelayUs));
+                until = (std::min)(until, due);
+            }
+            if (ctx.sendCv.wait_until(lk, until) == std::cv_status::timeout
+                && std::chrono::steady_clock::now() >= waitEnd)
                 break;
+        }
+
+        if (!ctx.running.load()) {
+            return false;
+        }
+
+        if (ctx.creditFlow) {
+            bool stalled = !HasMessageCredit(ctx)
+                && (!ctx.backlogQueue.empty() || !ctx.sendQueue.empty() || !ctx.bulkQueue.empty());
+            if (stalled && !ctx.creditStalled) {
+                m_creditStalls.fetch_add(1, std::memory_order_relaxed);
             }
+            ctx.creditStalled = stalled;
+        }
 
-            if (ctx->sendQueue.empty()) {
-                continue;
+        if (!ctx.controlQueue.empty()) {
+            batch.bytes = std::move(ctx.controlQueue.front());
+            ctx.controlQueue.pop();
+            return true;
+        }
+
+        // ѷ䣬ټطŻ
+        if (!ctx.replayQueue.empty()) {
+            OutboundMessage& msg = ctx.replayQueue.front();
+            if (msg.streamId == 0) {
+                batch.direct = std::move(msg.buffer);
+                ctx.replayQueue.pop_front();
             }
+            else {
+                batch.fragments = 1;
+                if (AppendNextFragment(msg, batch.bytes)) {
+                    ctx.replayQueue.pop_front();
+                }
+            }
+            return true;
+        }
 
-            msg = std::move(ctx->sendQueue.front());
-            ctx->sendQueue.pop();
+        // ѹϢԼ FRAGMENT_SIZE ƣʱܶƣ
+        if (!ctx.backlogQueue.empty() && HasMessageCredit(ctx)) {
+            while (!ctx.backlogQueue.empty() && HasMessageCredit(ctx)) {
+                OutboundMessage& msg = ctx.backlogQueue.front();
+                batch.bytes.insert(batch.bytes.end(), msg.buffer->FrameData(), msg.buffer->FrameData() + msg.buffer->FrameSize());
+                RecordSentLocked(ctx, msg.buffer);
+                ChargeCredit(ctx, 1, msg.buffer->FrameSize());
+                ctx.backlogQueue.pop_front();
+                batch.backlog++;
+            }
+            return true;
         }
 
-        // ǰ׺Ϣ
-        uint32_t msgLen = static_cast<uint32_t>(msg.payload.size());
-        std::vector<uint8_t> frame(4 + msgLen);
-        *reinterpret_cast<uint32_t*>(frame.data()) = msgLen;
-        std::copy(msg.payload.begin(), msg.payload.end(), frame.begin() + 4);
+        size_t smallLanes = smallReady() ? 1 : 0;
+        size_t bulkLanes = readyBulk();
+        size_t streamLanes = readyStreams();
+        size_t lanes = smallLanes + bulkLanes + streamLanes;
+        if (lanes == 0) {
+            return false;
+        }
 
-        // 첽д
-        DWORD bytesWritten = 0;
-        BOOL success = WriteFile(
-            ctx->hPipe,
-            frame.data(),
-            static_cast<DWORD>(frame.size()),
-            &bytesWritten,
-            &ctx->ovWrite
-        );
+        batch.bulkActive = !ctx.bulkQueue.empty() || !ctx.outStreams.empty();
+        size_t pick = ctx.turn++ % lanes;
+
+        // СϢֻͨһʱֱдѷ֡壬ʱϲһдЭ Batch һ Batch ǰ׺
+        // - Batch ֻ֡װ Message ֡Compressed ֡ Batchд
+        if (pick < smallLanes) {
+            size_t prefix = ctx.settings.batching ? FRAME_HEADER_SIZE : 0;
+            size_t maxBytes = ctx.settings.batching ? m_batchConfig.maxBytes : FRAGMENT_SIZE;
+            size_t maxMessages = ctx.settings.batching ? m_batchConfig.maxMessages : SIZE_MAX;
+
+            OutboundMessage& first = ctx.sendQueue.front();
+            batch.smallEnqueueUs.push_back(first.enqueueUs);
+            RecordSentLocked(ctx, first.buffer);
+            ChargeCredit(ctx, 1, first.buffer->FrameSize());
+            if (ctx.sendQueue.size() == 1 || !HasMessageCredit(ctx) || maxMessages < 2
+                || first.buffer->FrameSize() + ctx.sendQueue[1].buffer->FrameSize() > maxBytes
+                || (prefix && (!IsMessageFrame(first.buffer) || !IsMessageFrame(ctx.sendQueue[1].buffer)))) {
+                batch.direct = std::move(first.buffer);
+                PopSmall(ctx);
+                return true;
+            }
 
-        if (!success) {
-            DWORD err = GetLastError();
-            if (err == ERROR_IO_PENDING) {
-                DWORD waitResult = WaitForSingleObject(ctx->hWriteEvent, 5000);
-                if (waitResult == WAIT_OBJECT_0) {
-                    if (!GetOverlappedResult(ctx->hPipe, &ctx->ovWrite, &bytesWritten, FALSE)) {
-                        Log("GetOverlappedResult failed on write");
-                        break;
-                    }
-                }
-                else {
-                    Log("Write timeout or error");
-                    CancelIoEx(ctx->hPipe, &ctx->ovWrite);
+            batch.bytes.resize(prefix);
+            ChargeCredit(ctx, 0, prefix);
+            batch.bytes.insert(batch.bytes.end(), first.buffer->FrameData(), first.buffer->FrameData() + first.buffer->FrameSize());
+            PopSmall(ctx);
+            while (!ctx.sendQueue.empty() && HasMessageCredit(ctx) && batch.smallEnqueueUs.size() < maxMessages
+                && batch.bytes.size() + ctx.sendQueue.front().buffer->FrameSize() <= prefix + maxBytes
+                && (!prefix || IsMessageFrame(ctx.sendQueue.front().buffer))) {
+                OutboundMessage& msg = ctx.sendQueue.front();
+                batch.bytes.insert(batch.bytes.end(), msg.buffer->FrameData(), msg.buffer->FrameData() + msg.buffer->FrameSize());
+                batch.smallEnqueueUs.push_back(msg.enqueueUs);
+                RecordSentLocked(ctx, msg.buffer);
+                ChargeCredit(ctx, 1, msg.buffer->FrameSize());
+                PopSmall(ctx);
+            }
+
+            if (prefix) {
+                uint32_t header = MakeFrameHeader(FrameKind::Batch, static_cast<uint32_t>(batch.bytes.size() - prefix));
+                std::memcpy(batch.bytes.data(), &header, sizeof(header));
+                batch.batched = batch.smallEnqueueUs.size();
+            }
+            return true;
+        }
+        pick -= smallLanes;
+
+        // Ϣͨȡ pick ɷ͵ĴϢһƬ
+        if (pick < bulkLanes) {
+            auto it = ctx.bulkQueue.begin();
+            for (;; ++it) {
+                if (CanSendFragment(ctx, *it) && pick-- == 0)
                     break;
+            }
+            batch.fragments = 1;
+            uint64_t starting = it->offset == 0 ? 1 : 0;
+            bool last = AppendNextFragment(*it, batch.bytes);
+            ChargeCredit(ctx, starting, batch.bytes.size());
+            if (last) {
+                RecordSentLocked(ctx, it->buffer);
+                ctx.bulkQueue.erase(it);
+            }
+            return true;
+        }
+        pick -= bulkLanes;
+
+        // ͨȡ pick жȵ
+        for (auto& kv : ctx.outStreams) {
+            if (kv.second.credit == 0)
+                continue;
+            if (pick-- > 0)
+                continue;
+            streamId = kv.first;
+            producer = kv.second.producer;
+            chunkSize = static_cast<size_t>((std::min<uint64_t>)(kv.second.credit, STREAM_CHUNK_SIZE));
+            break;
+        }
+    }
+
+    if (!producer) {
+        return false;
+    }
+
+    // ȡݣֻᱻ̵߳
+    std::vector<uint8_t>& frame = batch.bytes;
+    const size_t prefix = FRAME_HEADER_SIZE + sizeof(uint32_t);
+    frame.resize(prefix + chunkSize);
+
+    size_t produced = 0;
+    bool failed = false;
+    try {
+        produced = producer->Produce(frame.data() + prefix, chunkSize);
+    }
+    catch (...) {
+        failed = true;
+    }
+
+    if (produced == 0) {
+        frame.clear();
+        EncodeStreamControl(frame, FrameKind::StreamEnd, streamId,
+            static_cast<uint32_t>(failed ? StreamStatus::Aborted : StreamStatus::Completed));
+
+        std::lock_guard<std::mutex> lk(ctx.sendMutex);
+        ctx.outStreams.erase(streamId);
+        return true;
+    }
+
+    frame.resize(prefix + produced);
+    uint32_t header = MakeFrameHeader(FrameKind::StreamData, static_cast<uint32_t>(sizeof(uint32_t) + produced));
+    std::memcpy(frame.data(), &header, sizeof(header));
+    std::memcpy(frame.data() + FRAME_HEADER_SIZE, &streamId, sizeof(streamId));
+
+    {
+        std::lock_guard<std::mutex> lk(ctx.sendMutex);
+        auto it = ctx.outStreams.find(streamId);
+        if (it != ctx.outStreams.end()) {
+            it->second.credit -= produced;
+        }
+    }
+    return true;
+}
+
+void PipeServer::RecordWrite(const WriteBatch& batch)
+{
+    m_writes.fetch_add(1, std::memory_order_relaxed);
+    m_bytesSent.fetch_add(batch.direct ? batch.direct->FrameSize() : batch.bytes.size(), std::memory_order_relaxed);
+    m_messagesSent.fetch_add(batch.smallEnqueueUs.size() + batch.backlog, std::memory_order_relaxed);
+    m_fragmentsSent.fetch_add(batch.fragments, std::memory_order_relaxed);
+    if (batch.batched > 0) {
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_batchedMessages.fetch_add(batch.batched, std::memory_order_relaxed);
+    }
+
+    uint64_t now = NowUs();
+    for (uint64_t enqueueUs : batch.smallEnqueueUs) {
+        uint64_t latency = now - enqueueUs;
+        if (batch.bulkActive) {
+            m_smallLatencyUnderBulk.Record(latency);
+        }
+        else {
+            m_smallLatency.Record(latency);
+        }
+    }
+}
+
+bool PipeServer::WriteToPipe(std::shared_ptr<ClientContext> ctx, const uint8_t* data, size_t size)
+{
+    // 첽д
+    DWORD bytesWritten = 0;
+    BOOL success = WriteFile(
+        ctx->hPipe,
+        data,
+        static_cast<DWORD>(size),
+        &bytesWritten,
+        &ctx->ovWrite
+    );
+
+    if (!success) {
+        DWORD err = GetLastError();
+        if (err == ERROR_IO_PENDING) {
+            DWORD waitResult = WaitForSingleObject(ctx->hWriteEvent, 5000);
+            if (waitResult == WAIT_OBJECT_0) {
+                if (!GetOverlappedResult(ctx->hPipe, &ctx->ovWrite, &bytesWritten, FALSE)) {
+                    Log("GetOverlappedResult failed on write");
+                    return false;
                 }
             }
             else {
-                Log("WriteFile failed");
-                break;
+                Log("Write timeout or error");
+                CancelIoEx(ctx->hPipe, &ctx->ovWrite);
+                return false;
             }
         }
+        else {
+            Log("WriteFile failed");
+            return false;
+        }
     }
+    return true;
+}
 
-    ctx->running = false;
+void PipeServer::ProcessStreamFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame)
+{
+    if (frame.Size() < sizeof(uint32_t)) {
+        Log("Malformed stream frame");
+        return;
+    }
+
+    const uint8_t* p = frame.Data();
+    uint32_t streamId = ReadU32(p);
+
+    switch (frame.kind)
+    {
+    case FrameKind::StreamOpen:
+    {
+        if (frame.Size() < sizeof(uint32_t) + sizeof(uint64_t))
+            return;
+
+        std::string meta(reinterpret_cast<const char*>(p) + sizeof(uint32_t) + sizeof(uint64_t),
+            frame.Size() - sizeof(uint32_t) - sizeof(uint64_t));
+        std::shared_ptr<StreamConsumer> consumer;
+        if (m_streamAcceptor) {
+            consumer = m_streamAcceptor(ctx->clientId, streamId, meta);
+        }
+
+        if (!consumer) {
+            std::vector<uint8_t> reset;
+            EncodeStreamControl(reset, FrameKind::StreamReset, streamId, static_cast<uint32_t>(StreamStatus::Rejected));
+            EnqueueControl(ctx, std::move(reset));
+            return;
+        }
+
+        ctx->inStreams[streamId].consumer = std::move(consumer);
+        break;
+    }
+
+    case FrameKind::StreamData:
+    {
+        auto it = ctx->inStreams.find(streamId);
+        if (it == ctx->inStreams.end())
+            return;
+
+        size_t size = frame.Size() - sizeof(uint32_t);
+        if (!it->second.consumer->OnData(p + sizeof(uint32_t), size)) {
+            it->second.consumer->OnEnd(false);
+            ctx->inStreams.erase(it);
+
+            std::vector<uint8_t> reset;
+            EncodeStreamControl(reset, FrameKind::StreamReset, streamId, static_cast<uint32_t>(StreamStatus::Aborted));
+            EnqueueControl(ctx, std::move(reset));
+            return;
+        }
+
+        // ɺ黹ȣܹٷٿ֡
+        it->second.unacked += static_cast<uint32_t>(size);
+        if (it->second.unacked >= STREAM_WINDOW / 2) {
+            std::vector<uint8_t> credit;
+            EncodeStreamControl(credit, FrameKind::StreamCredit, streamId, it->second.unacked);
+            EnqueueControl(ctx, std::move(credit));
+            it->second.unacked = 0;
+        }
+        break;
+    }
+
+    case FrameKind::StreamEnd:
+    {
+        auto it = ctx->inStreams.find(streamId);
+        if (it == ctx->inStreams.end())
+            return;
+
+        bool completed = frame.Size() >= 2 * sizeof(uint32_t)
+            && ReadU32(p + sizeof(uint32_t)) == static_cast<uint32_t>(StreamStatus::Completed);
+        it->second.consumer->OnEnd(completed);
+        ctx->inStreams.erase(it);
+        break;
+    }
+
+    case FrameKind::StreamCredit:
+    case FrameKind::StreamReset:
+    {
+        if (frame.Size() < 2 * sizeof(uint32_t))
+            return;
+
+        uint32_t value = ReadU32(p + sizeof(uint32_t));
+        {
+            std::lock_guard<std::mutex> lk(ctx->sendMutex);
+            auto it = ctx->outStreams.find(streamId);
+            if (it == ctx->outStreams.end())
+                return;
+
+            if (frame.kind == FrameKind::StreamCredit) {
+                it->second.credit += value;
+            }
+            else {
+                ctx->outStreams.erase(it);
+            }
+        }
+        ctx->sendCv.notify_one();
+        break;
+    }
+
+    default:
+        Log("Unknown frame kind, ignored");
+        break;
+    }
+}
+
+// ߼Ƭ
+void PipeServer::ProcessFragment(std::shared_ptr<ClientContext> ctx, FragmentAssembler& fragments, const Frame& frame)
+{
+    BufferLease buffer;
+    switch (fragments.Add(frame, buffer)) {
+    case FragmentAssembler::Result::Complete:
+        ProcessReceivedMessage(ctx, std::move(buffer));
+        break;
+    case FragmentAssembler::Result::Malformed:
+        Log("Malformed fragment frame");
+        break;
+    case FragmentAssembler::Result::TooLarge:
+        Log("Reassembled message too large, disconnecting client");
+        ctx->running = false;
+        break;
+    default:
+        break;
+    }
 }
 
-void PipeServer::ProcessReceivedMessage(std::shared_ptr<ClientContext> ctx, const std::vector<uint8_t>& payload)
+void PipeServer::EnqueueControl(std::shared_ptr<ClientContext> ctx, std::vector<uint8_t> frame)
+{
+    {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        ctx->controlQueue.push(std::move(frame));
+    }
+    ctx->sendCv.notify_one();
+}
+
+void PipeServer::ProcessReceivedMessage(std::shared_ptr<ClientContext> ctx, BufferLease buffer)
 {
     // ͻ˻ûIDԴӵһϢȡϢID
     if (ctx->clientId.empty()) {
-        // ʾһϢǴıID
-        std::string potentialId(payload.begin(), payload.end());
+        // ֡ Hello ʱ֣ ConnectionSettingsHello ţֳɹճϲ
+        if (ProcessHello(ctx, buffer)) {
+            if (!ctx->clientId.empty()) {
+                DeliverReceived(ctx, std::move(buffer));
+            }
+            return;
+        }
+
+        // ģʽһϢǴıID
+        // ֻȷ Resume ֡ѡĿͻ˲ſʼỰյ Session ֡ɿͻֻյ Message ֡
+        std::string potentialId(reinterpret_cast<const char*>(buffer->Data()), buffer->Size());
         if (!potentialId.empty() && potentialId.size() < 256) {
+            bool resumable = false;
+            {
+                std::lock_guard<std::mutex> lk(ctx->sendMutex);
+                resumable = ctx->resumable;
+            }
+            if (resumable) {
+                StartSession(ctx, potentialId, SessionFrame);
+            }
             BindClientId(ctx, potentialId);
+            if (!resumable) {
+                m_legacyClients.fetch_add(1, std::memory_order_relaxed);
+            }
             Log(("Client bound with ID: " + potentialId).c_str());
             return;  // Ϣ֣
         }
     }
 
-    // Ϣ
-    PipeMessage msg;
+    // ѡӰżʱͻطϢзյĲֱӶ
+    //  DetachSession ͬһ£ӶϿỰתŴϢҲӣɿͻʱط
+    uint64_t received = 0;
+    if (!ctx->clientId.empty()) {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        if (ctx->resumable) {
+            if (!ctx->session)
+                return;
+            if (ctx->skipInbound > 0) {
+                ctx->skipInbound--;
+                return;
+            }
+            std::lock_guard<std::mutex> slk(ctx->session->mutex);
+            received = ++ctx->session->received;
+        }
+    }
+    if (received > 0 && received % ACK_INTERVAL == 0) {
+        std::vector<uint8_t> ack;
+        EncodeAck(ack, received);
+        EnqueueControl(ctx, std::move(ack));
+    }
+
+    // Э˶Ʊӣڴ˻ԭΪϲ㴦 JSON ı
+    if (ctx->settings.encoding != PayloadEncoding::Json) {
+        buffer = DecodeInbound(*m_pool, buffer->Data(), buffer->Size(), ctx->settings.encoding);
+        if (!buffer) {
+            Log("Malformed payload for negotiated encoding, dropped");
+            return;
+        }
+    }
+
+    DeliverReceived(ctx, std::move(buffer));
+}
+
+void PipeServer::DeliverReceived(std::shared_ptr<ClientContext> ctx, BufferLease buffer)
+{
+    // ƬõĻڴ˷ֱ֮֡յϢһԭת
+    if (!buffer->IsSealed()) {
+        SealFrame(*buffer, FrameKind::Message);
+    }
+
+    // Ϣͼӣݣ
+    PipeMessageView msg;
     msg.clientId = ctx->clientId;
-    msg.payload = payload;
+    msg.payload = buffer->View();
     msg.timestampMs = NowMs();
+    msg.receivedUs = NowUs();
+    msg.lease = std::move(buffer);
+
+    EnqueueReceived(std::move(msg));
+}
+
+// Resume ֻΪӵ֡֡ Resume ӼѡAck üطŻ
+// - Ϊ 0ûпĻỰĴı֡ʼ»Ự Session ֡֡
+// - ܣ token Ϊ 0  Session ֡ͻ·Ͱ֡ʱʼ»Ự
+void PipeServer::ProcessSessionFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame)
+{
+    const uint8_t* p = frame.Data();
+    if (frame.kind == FrameKind::Ack) {
+        if (frame.Size() < sizeof(uint64_t))
+            return;
+
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        if (ctx->session) {
+            std::lock_guard<std::mutex> slk(ctx->session->mutex);
+            ctx->session->replay.Ack(ReadU64(p));
+        }
+        return;
+    }
+
+    if (frame.Size() < 3 * sizeof(uint64_t) || !ctx->clientId.empty()) {
+        Log("Unexpected Resume frame, ignored");
+        return;
+    }
+
+    uint64_t token = ReadU64(p);
+    {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        ctx->settings.legacy = false;
+        ctx->resumable = true;
+    }
+    if (token == 0)
+        return;
+
+    if (!ResumeSession(ctx, token, ReadU64(p + sizeof(uint64_t)), ReadU64(p + 2 * sizeof(uint64_t)), SessionFrame)) {
+        std::vector<uint8_t> rejected;
+        EncodeSession(rejected, 0, 0);
+        EnqueueControl(ctx, std::move(rejected));
+    }
+}
+
+// ͻ跢Ͷȣ׸ Credit ֡Ϊӿأ֮Ȩۼ
+void PipeServer::ProcessCreditFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame)
+{
+    if (frame.Size() < 2 * sizeof(uint32_t))
+        return;
+
+    const uint8_t* p = frame.Data();
+    {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        ctx->creditFlow = true;
+        ctx->creditMessages += ReadU32(p);
+        ctx->creditBytes += ReadU32(p + sizeof(uint32_t));
+    }
+    ctx->sendCv.notify_one();
+}
+
+// Batch ֡ͨϢԼỰţ
+void PipeServer::ProcessBatchFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame)
+{
+    bool ok = ForEachBatchMessage(frame.Data(), frame.Size(), [&](const uint8_t* data, size_t size) {
+        ProcessReceivedMessage(ctx, m_pool->Copy(data, size));
+        });
+    if (!ok) {
+        Log("Malformed Batch frame, remainder ignored");
+    }
+}
+
+// ѹϢѹͨϢδЭѹӲ
+void PipeServer::ProcessCompressedFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame)
+{
+    if (ctx->settings.compression == PayloadCompression::None) {
+        Log("Unexpected Compressed frame, ignored");
+        return;
+    }
+
+    BufferLease message = Decompress(*m_pool, frame.Data(), frame.Size());
+    if (!message) {
+        Log("Malformed Compressed frame, ignored");
+        return;
+    }
+    ProcessReceivedMessage(ctx, std::move(message));
+}
+
+// ֡ Hello ʱ֣ЭӲ resume ʱʼỰWelcome κ·
+// -  Helloɿͻ˵Ĵı clientIdʱ false
+// - Hello ȱ clientId ʱ Error Ҳ󶨣ͻ˿· Hello
+bool PipeServer::ProcessHello(std::shared_ptr<ClientContext> ctx, const BufferLease& buffer)
+{
+    // ı clientId  '{' ͷʡȥһν
+    if (buffer->Size() == 0 || buffer->Data()[0] != '{')
+        return false;
+
+    auto hello = nlohmann::json::parse(buffer->Data(), buffer->Data() + buffer->Size(), nullptr, false);
+    if (!hello.is_object() || StringField(hello, "type") != "Hello")
+        return false;
+
+    const nlohmann::json& payload = ObjectField(hello, "payload");
+    const nlohmann::json& caps = ObjectField(payload, "capabilities");
+    auto msgIdIt = hello.find("msgId");
+    nlohmann::json msgId = msgIdIt != hello.end() ? *msgIdIt : nlohmann::json();
+
+    ConnectionSettings settings;
+    settings.legacy = false;
+    settings.maxFrameSize = static_cast<uint32_t>(std::clamp<uint64_t>(
+        UintField(caps, "maxFrameSize", MAX_FRAME_LENGTH), MIN_FRAME_SIZE_LIMIT, MAX_FRAME_LENGTH));
+
+    // ѹȡͻƫбеһֵ֧ģ֧ʱΪ JSON / ѹ
+    auto encodings = caps.find("encodings");
+    if (encodings != caps.end() && encodings->is_array()) {
+        for (const auto& name : *encodings) {
+            if (name.is_string() && ParseEncoding(name.get_ref<const std::string&>(), settings.encoding))
+                break;
+        }
+    }
+    auto compression = caps.find("compression");
+    if (compression != caps.end() && compression->is_array()) {
+        for (const auto& name : *compression) {
+            if (name.is_string() && ParseCompression(name.get_ref<const std::string&>(), settings.compression))
+                break;
+        }
+    }
+
+    settings.batching = m_batchConfig.enabled && BoolField(caps, "supportsBatch");
+    uint64_t heartbeatMs = UintField(caps, "heartbeatMs", 0);
+    settings.heartbeatMs = heartbeatMs ? static_cast<uint32_t>(std::clamp<uint64_t>(heartbeatMs, MIN_HEARTBEAT_MS, MAX_HEARTBEAT_MS)) : 0;
+
+    //  resume ֶμѡնΪ 0 ʾʼ»Ự򲻽Ự
+    auto resumeIt = payload.find("resume");
+    bool resumable = resumeIt != payload.end() && resumeIt->is_object();
+    {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        ctx->settings = settings;
+        ctx->resumable = resumable;
+    }
+
+    bool resumed = false;
+    if (resumable && TokenField(*resumeIt, "token") != 0) {
+        resumed = ResumeSession(ctx, TokenField(*resumeIt, "token"), UintField(*resumeIt, "received", 0), UintField(*resumeIt, "resendFrom", 0),
+            [&](const PipeSession& session, uint64_t received) {
+                return EncodeWelcome(msgId, session.clientId, session.token, ctx->settings, true, received);
+            });
+    }
+
+    if (!resumed) {
+        std::string clientId = StringField(payload, "clientIdHint");
+        if (clientId.empty()) {
+            clientId = StringField(hello, "clientId");
+        }
+        if (clientId.empty() || clientId.size() >= 256) {
+            Log("Hello without a usable clientId, rejected");
+            {
+                std::lock_guard<std::mutex> lk(ctx->sendMutex);
+                ctx->settings = ConnectionSettings();
+                ctx->resumable = false;
+            }
+            EnqueueControl(ctx, EncodeJsonFrame({
+                { "ver", "1.0" },
+                { "type", "Error" },
+                { "msgId", msgId },
+                { "timestamp", NowMs() },
+                { "error", { { "code", "BadHello" }, { "message", "clientIdHint is required" } } },
+            }));
+            return true;
+        }
+
+        if (resumable) {
+            StartSession(ctx, clientId, [&](const PipeSession& session, uint64_t) {
+                return EncodeWelcome(msgId, session.clientId, session.token, ctx->settings, false, 0);
+            });
+        }
+        else {
+            EnqueueControl(ctx, EncodeWelcome(msgId, clientId, 0, ctx->settings, false, 0));
+        }
+        BindClientId(ctx, clientId);
+    }
 
-    EnqueueReceived(msg);
+    m_handshakes.fetch_add(1, std::memory_order_relaxed);
+    Log(("Client " + ctx->clientId + (resumed ? " resumed" : " bound") + " via Hello: encoding=" + EncodingName(ctx->settings.encoding)
+        + ", compression=" + CompressionName(ctx->settings.compression) + ", batch=" + (ctx->settings.batching ? "on" : "off")).c_str());
+    return true;
+}
+
+// ѡӰʱʼ»Ự replySession ֡ Welcome· BindClientId ֮ǰеϢŻ
+void PipeServer::StartSession(std::shared_ptr<ClientContext> ctx, const std::string& clientId, const SessionReply& reply)
+{
+    std::shared_ptr<PipeSession> session = m_sessions.Create(clientId, NowMs());
+    {
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        session->encoding = ctx->settings.encoding;
+        session->compression = ctx->settings.compression;
+        ctx->settings.resumeToken = session->token;
+        ctx->controlQueue.push(reply(*session, 0));
+        ctx->session = std::move(session);
+    }
+    ctx->sendCv.notify_one();
+}
+
+// ʱ falseɵ÷δ
+bool PipeServer::ResumeSession(std::shared_ptr<ClientContext> ctx, uint64_t token, uint64_t acked, uint64_t resendFrom,
+    const SessionReply& reply)
+{
+    std::shared_ptr<PipeSession> session = m_sessions.Find(token, NowMs());
+
+    // ӿܻûߣȹرδдϢתỰ
+    if (session) {
+        std::shared_ptr<ClientContext> old;
+        {
+            std::lock_guard<std::mutex> lk(m_clientsMutex);
+            auto it = m_clients.find(session->clientId);
+            if (it != m_clients.end()) {
+                old = it->second;
+            }
+        }
+        if (old && old != ctx) {
+            CloseClient(old);
+        }
+    }
+
+    ResumePlan plan;
+    if (!m_sessions.Resume(session, acked, resendFrom, plan)) {
+        Log("Resume rejected");
+        return false;
+    }
+
+    ctx->skipInbound = plan.duplicates;
+    {
+        // طδдϢѰԭỰĸʽ룬
+        std::lock_guard<std::mutex> lk(ctx->sendMutex);
+        ctx->settings.encoding = session->encoding;
+        ctx->settings.compression = session->compression;
+        ctx->settings.resumeToken = session->token;
+        ctx->session = session;
+        ctx->controlQueue.push(reply(*session, plan.received));
+
+        for (BufferLease& buffer : plan.replay) {
+            OutboundMessage msg;
+            msg.buffer = std::move(buffer);
+            msg.enqueueUs = NowUs();
+            if (IsBulk(*ctx, msg.buffer)) {
+                msg.streamId = ctx->nextStreamId++;
+            }
+            ctx->replayQueue.push_back(std::move(msg));
+        }
+        for (BufferLease& buffer : plan.pending) {
+            QueueBacklogLocked(*ctx, std::move(buffer));
+        }
+    }
+    // ڼ䷢ϢδдϢ֮
+    BindClientId(ctx, session->clientId);
+    ctx->sendCv.notify_one();
+
+    Log(("Client resumed with ID: " + session->clientId).c_str());
+    return true;
+}
+
+// ӶϿֹͣдδдϢεֻһΣ
+void PipeServer::DetachSession(ClientContext& ctx)
+{
+    std::shared_ptr<PipeSession> session;
+    {
+        std::lock_guard<std::mutex> lk(ctx.sendMutex);
+        session = std::move(ctx.session);
+        ctx.session.reset();
+        if (!session)
+            return;
+
+        // ѹϢϴδдġеģȷͶе磬תԱ˳
+        std::lock_guard<std::mutex> slk(session->mutex);
+        for (auto* queue : { &ctx.backlogQueue, &ctx.sendQueue, &ctx.bulkQueue }) {
+            for (OutboundMessage& msg : *queue) {
+                session->pending.push_back(std::move(msg.buffer));
+            }
+            queue->clear();
+        }
+        ctx.conflated.clear();
+        // replayQueue еϢطŻ´ȡ
+        ctx.replayQueue.clear();
+    }
+    m_sessions.Detach(session, NowMs());
 }
 
 void PipeServer::CloseClient(std::shared_ptr<ClientContext> ctx)
 {
-    if (!ctx)
+    // ֻرһΣһ߳ڹرʱֱӷأظ CloseHandle
+    if (!ctx || ctx->closed.exchange(true))
         return;
 
     ctx->running = false;
+    DetachSession(*ctx);
 
     if (ctx->hPipe && ctx->hPipe != INVALID_HANDLE_VALUE) {
         CancelIoEx(ctx->hPipe, NULL);
@@ -485,19 +1631,48 @@ void PipeServer::BindClientId(std::shared_ptr<ClientContext> ctx, const std::str
 
     ctx->clientId = clientId;
 
-    std::lock_guard<std::mutex> lk(m_clientsMutex);
-    m_clients[clientId] = ctx;
+    // Ǽȡͬһ£ѹϢ֮Ϣ
+    bool delivered = false;
+    {
+        std::lock_guard<std::mutex> lk(m_clientsMutex);
+        m_clients[clientId] = ctx;
+
+        //  JSONЭ̵ĸʽת
+        std::vector<BufferLease> frames = m_mailboxes.Take(clientId, NowMs());
+        for (BufferLease& frame : frames) {
+            frame = EncodeFor(ctx->settings, frame);
+        }
+        if (!frames.empty()) {
+            std::lock_guard<std::mutex> slk(ctx->sendMutex);
+            for (BufferLease& frame : frames) {
+                QueueBacklogLocked(*ctx, std::move(frame));
+            }
+            delivered = true;
+        }
+    }
+    if (delivered) {
+        ctx->sendCv.notify_one();
+    }
 }
 
-void PipeServer::EnqueueReceived(const PipeMessage& msg)
+void PipeServer::EnqueueReceived(PipeMessageView msg)
 {
+    // صӿ PipeMessageֻ˻صʱ
+    PipeMessage copy;
+    if (m_handler) {
+        copy.clientId = msg.clientId;
+        copy.payload.assign(msg.payload.begin(), msg.payload.end());
+        copy.timestampMs = msg.timestampMs;
+        copy.receivedUs = msg.receivedUs;
+    }
+
     {
         std::lock_guard<std::mutex> lk(m_recvMutex);
-        m_receiveData.push(msg);
+        m_receiveData.push(std::move(msg));
     }
     m_recvCv.notify_one();
 
     if (m_handler) {
-        m_handler(msg);
+        m_handler(copy);
     }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <unordered_map>
 #include <thread>
 #include <mutex>
@@ -11,6 +12,16 @@
 #include <functional>
 #include <memory>
 #include <chrono>
+#include <map>
+#include <span>
+#include "BufferPool.h"
+#include "FrameCodec.h"
+#include "PipeStream.h"
+#include "SessionStore.h"
+#include "Mailbox.h"
+#include "PayloadCodec.h"
+#include "PipeMessage.h"
+#include "..\Common\LatencyHistogram.h"
 
 /* 
 ϢʽʾJSON ṹο
@@ -20,6 +31,8 @@
         "msgId" : "uuid-...-...",       // ϢΨһIDƥ/Ӧ
         "clientId" : "optional",        // ͻIDֺǰʡԣ
         "timestamp" : 1733800000000,    // ͻĺʱUTC
+        "deadline" : 1733800005000,     // ѡ˿̣UTC 룩ٴֱӻ Error
+        "timeoutMs" : 5000,             // ѡӷյĳʱ deadline ȡ
         "traceId" : "optional",         // IDڿŲ飩
         "flags" : {                     // ѡλ
         "compressed": false,
@@ -36,12 +49,79 @@
 }
 */
 
-// Ϣṹ4ֽڳǰ׺ + ʵ
-struct PipeMessage
+// ϢСϢ֡ͣϢ streamId Ƭ
+struct OutboundMessage
 {
-    std::string              clientId;
-    std::vector<uint8_t>     payload;
-    uint64_t                 timestampMs;
+    BufferLease              buffer;                    // ѷ֡ĳػ壨ɱͻ˹
+    uint64_t                 enqueueUs = 0;             // ʱ̣steady clock΢룩
+    uint32_t                 streamId = 0;              // Ƭ߼
+    size_t                   offset = 0;                // ѷֽ
+    std::string              conflationKey;             // ǿΪֵϢ SendLatestToClient
+};
+
+// Batch ֡ϲڣֻ Hello  supportsBatch Ч
+// - СϢһд׵ maxDelayUsܹ maxMessages  / maxBytes ֽʱΪһ Batch ֡һд
+// - ʡµÿϢһ WriteFileͻÿϢ ReadFile ֡룻 maxDelayUs Ķӳ
+struct BatchConfig
+{
+    bool                     enabled = true;
+    uint64_t                 maxDelayUs = 200;
+    size_t                   maxBytes = FRAGMENT_SIZE;  // Batch ֡
+    size_t                   maxMessages = 256;
+};
+
+// ==============================
+// ֣ͻ Hello Ϊӵ֡洿ı clientId ֡˻ Welcome ſʼ
+//   Hello.payload = {
+//       "clientIdHint": "CLI-001",
+//       "capabilities": {
+//           "maxFrameSize": 1048576,               // ˿ɽյĵ֡
+//           "encodings": ["cbor", "json"],         // ƫ
+//           "compression": ["xpress"],
+//           "supportsBatch": true,
+//           "heartbeatMs": 10000                   // ˷ļ
+//       },
+//       "resume": { "token": "123", "received": 10, "resendFrom": 5 }   // ѡͬ Resume ֡{} ʾʼ»Ự
+//   }
+//   Welcome.payload = {
+//       "clientId": "CLI-001", "resumed": false, "resumeToken": "456", "received": 0,
+//       "settings": { "maxFrameSize": 1048576, "encoding": "cbor", "compression": "xpress", "batch": true, "heartbeatMs": 10000 }
+//   }
+// - Hello/Welcome  JSONWelcome ֮˫ settings շ
+// - ɹʱ encoding/compression ԭỰطŵϢѰ룩ʱ clientIdHint ʼ»Ự
+// -  resume ӲỰš AckWelcome  resumeToken
+// - ֡Ǵı clientId ľɿͻ߼ģʽȫȡĬֵ Welcomeֻյ Message ֡
+//   ƬỰֿ MAX_FRAME_LENGTH Ϣ
+// - ֡ Resume ֡ĿͻͬȡĬֵ WelcomeǼģʽɽշƬSession/Ack ֡
+// ==============================
+struct ConnectionSettings
+{
+    bool                     legacy = true;             // Դı clientId 󶨣ֻշ Message ֡
+    uint32_t                 maxFrameSize = MAX_FRAME_LENGTH;   // ˫֡ޣҲƸյ֡
+    PayloadEncoding          encoding = PayloadEncoding::Json;
+    PayloadCompression       compression = PayloadCompression::None;
+    bool                     batching = false;          // СϢϲΪ Batch ֡ BatchConfig
+    uint32_t                 heartbeatMs = 0;           // ͻ˵ HEARTBEAT_MISSES ղݼϿ0 Ϊ
+    uint64_t                 resumeToken = 0;           // Ự
+};
+
+constexpr uint32_t MIN_FRAME_SIZE_LIMIT = STREAM_CHUNK_SIZE + 64;   // ˻ᷢ֡ݿ飩
+constexpr uint32_t MIN_HEARTBEAT_MS = 1000;
+constexpr uint32_t MAX_HEARTBEAT_MS = 60'000;
+constexpr uint32_t HEARTBEAT_MISSES = 3;
+
+// ͷɷ߳ȡݣ
+struct OutboundStream
+{
+    std::shared_ptr<StreamProducer> producer;
+    uint64_t                 credit = STREAM_WINDOW;    // ʣɷֽ
+};
+
+// շ̷߳ʣ
+struct InboundStream
+{
+    std::shared_ptr<StreamConsumer> consumer;
+    uint32_t                 unacked = 0;               // ѵδ黹Ķ
 };
 
 // ͻ
@@ -56,17 +136,86 @@ struct ClientContext
 
     std::string              clientId;
 
-    std::queue<PipeMessage>  sendQueue;
+    std::deque<OutboundMessage> sendQueue;              // СϢģʽӲƬҲϢ
+    std::unordered_map<std::string, OutboundMessage*> conflated;  // sendQueue δдֵϢ conflationKey 
+    std::deque<OutboundMessage> bulkQueue;              // Ϣÿһͨ
+    std::deque<OutboundMessage> replayQueue;            // ϸ˳ͨϢ
+    std::deque<OutboundMessage> backlogQueue;           // ǰѹСϢδдġеģϲΪһд
+    std::queue<std::vector<uint8_t>> controlQueue;      // ѱĿ֡ȷ
+    size_t                   turn = 0;                  // תα
     std::mutex               sendMutex;
     std::condition_variable  sendCv;
 
+    // ͻķͶȣ sendMutex յ׸ Credit ֡Ч
+    // - ͨϢϢƬѹϢĶȣֿ֡дڣ
+    // - ֽڶȰ֡ۼ͸֧һ֡ǷµĴӺȨеֿۣȺľʱϢڶеȴ
+    bool                     creditFlow = false;
+    uint64_t                 creditMessages = 0;
+    int64_t                  creditBytes = 0;
+    bool                     creditStalled = false;     // ǰǷȺľͣ
+
+    // Э̵Ľ󶨣Ǽǵͻ˱֮ǰɶ߳ sendMutex д룬ֻ֮
+    ConnectionSettings       settings;
+
+    std::map<uint32_t, OutboundStream> outStreams;      //  sendMutex 
+    uint32_t                 nextStreamId = 1;
+    std::unordered_map<uint32_t, InboundStream> inStreams;
+
+    bool                     resumable = false;         //  Resume ֡ Hello.resume ѡ sendMutex 򲻽Ự
+    std::shared_ptr<PipeSession> session;               // 󶨻ã sendMutex 
+    uint64_t                 skipInbound = 0;           // ʱͻطġյ̣߳
+
     std::atomic<bool>        running{ true };
+    std::atomic<bool>        closed{ false };           // CloseClient ִֻһΣStopDisconnectClient ̶߳ܵã
+};
+
+// һдݣܰСϢһƬ/ݿ
+struct WriteBatch
+{
+    std::vector<uint8_t>     bytes;
+    BufferLease              direct;                    // ѷ֡ϢֱӴӻдٿ
+    std::vector<uint64_t>    smallEnqueueUs;            // СϢʱ
+    bool                     bulkActive = false;        // ʱǷдϢڴ
+    size_t                   backlog = 0;               // ѹϢ
+    size_t                   batched = 0;               //  Batch ֡Ϣ
+    size_t                   fragments = 0;
+};
+
+// ͳ
+struct PipeServerStats
+{
+    uint64_t                 messagesSent = 0;
+    uint64_t                 fragmentsSent = 0;
+    uint64_t                 bytesSent = 0;
+    uint64_t                 writes = 0;
+    uint64_t                 creditStalls = 0;          // ͻ˶Ⱥľͣ͵Ĵ
+    uint64_t                 conflated = 0;             // ͬ key ֵԭλ滻δдֵϢ
+    uint64_t                 batches = 0;               // д Batch ֡
+    uint64_t                 batchedMessages = 0;       //  Batch ֡дϢ
+    uint64_t                 handshakes = 0;            //  Hello/Welcome ֵ
+    uint64_t                 legacyClients = 0;         // Դı clientId 󶨣ģʽ
+    uint64_t                 heartbeatTimeouts = 0;     // Э̵δյݶϿ
+
+    // СϢӵдɵӳ٣΢룩ǷдϢ
+    uint64_t                 smallP50Us = 0;
+    uint64_t                 smallP99Us = 0;
+    uint64_t                 smallP99UsUnderBulk = 0;
+
+    // ռãֽڣ
+    uint64_t                 poolLeasedBytes = 0;
+    uint64_t                 poolIdleBytes = 0;
+
+    SessionStats             sessions;
+    MailboxStats             mailbox;
 };
 
 class PipeServer
 {
 public:
     using MessageHandler = std::function<void(const PipeMessage&)>;
+    // ͻ˷ʱص nullptr ʾܾ
+    using StreamAcceptor = std::function<std::shared_ptr<StreamConsumer>(
+        const std::string& clientId, uint32_t streamId, const std::string& meta)>;
 
     PipeServer(const std::wstring& pipeName,
         size_t maxInstances = 20,
@@ -79,31 +228,86 @@ public:
     bool Start();
     void Stop();
 
+    // ͻδӻδʱϢ䣨 Mailbox.hʱʹʱ false
     bool SendToClient(const std::string& clientId, const std::vector<uint8_t>& payload);
     bool SendJsonToClient(const std::string& clientId, const std::string& jsonUtf8);
 
     size_t Broadcast(const std::vector<uint8_t>& payload);
     size_t BroadcastJson(const std::string& jsonUtf8);
 
+    // ͳػ壨յ PipeMessageView::leaseͻ˹ͬһ
+    bool SendToClient(const std::string& clientId, BufferLease buffer);
+    size_t Broadcast(BufferLease buffer);
+
+    // ֵϢȡ״̬ңֵֻ Notify
+    // - ÿͻͬһ conflationKey һϢδдʱϢԭλ滻Ŷλã
+    //   ͻյֵռð key ĸⶥ
+    // -  FRAGMENT_SIZE ϢճƬŶӣ滻ģʽӲƬ֡ճ滻
+    // - ͻδʱͨϢһ䣻conflationKey Ϊյͬ SendToClient/Broadcast
+    bool SendLatestToClient(const std::string& clientId, const std::string& conflationKey, BufferLease buffer);
+    bool SendLatestJsonToClient(const std::string& clientId, const std::string& conflationKey, const std::string& jsonUtf8);
+    size_t BroadcastLatest(const std::string& conflationKey, BufferLease buffer);
+
     bool TryPopReceived(PipeMessage& msg);
     bool WaitAndPopReceived(PipeMessage& msg);
 
+    // 㿽գֻͼ + Լ payload
+    bool TryPopReceivedView(PipeMessageView& msg);
+    bool WaitAndPopReceivedView(PipeMessageView& msg);
+
+    std::shared_ptr<BufferPool> Pool() const { return m_pool; }
+
     void SetMessageHandler(MessageHandler handler);
+    //  Start ֮ǰ
+    void SetBatchConfig(BatchConfig config);
+
+    // ֿͻ˷Сݣ streamIdʧܻͻ˴ڼģʽʱ 0
+    uint32_t OpenStream(const std::string& clientId, const std::string& metaJson,
+        std::shared_ptr<StreamProducer> producer);
+    void SetStreamAcceptor(StreamAcceptor acceptor);
 
     std::vector<std::string> ListClients() const;
     size_t GetClientCount() const;
     void DisconnectClient(const std::string& clientId);
 
+    PipeServerStats GetStats() const;
+
 private:
     HANDLE CreatePipeInstance();
     void   AcceptLoop();
     void   HandleClientCommunication(std::shared_ptr<ClientContext> ctx);
     void   HandleClientRead(std::shared_ptr<ClientContext> ctx);
     void   HandleClientWrite(std::shared_ptr<ClientContext> ctx);
-    void   ProcessReceivedMessage(std::shared_ptr<ClientContext> ctx, const std::vector<uint8_t>& payload);
+    void   ProcessReceivedMessage(std::shared_ptr<ClientContext> ctx, BufferLease buffer);
+    void   DeliverReceived(std::shared_ptr<ClientContext> ctx, BufferLease buffer);
+    void   ProcessStreamFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame);
+    void   ProcessFragment(std::shared_ptr<ClientContext> ctx, FragmentAssembler& fragments, const Frame& frame);
+    void   ProcessSessionFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame);
+    void   ProcessCreditFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame);
+    void   ProcessBatchFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame);
+    // ỰҪκ·֡Session ֡ Welcome sendMutex 
+    using SessionReply = std::function<std::vector<uint8_t>(const PipeSession& session, uint64_t received)>;
+
+    bool   ProcessHello(std::shared_ptr<ClientContext> ctx, const BufferLease& buffer);
+    void   ProcessCompressedFrame(std::shared_ptr<ClientContext> ctx, const Frame& frame);
+    void   StartSession(std::shared_ptr<ClientContext> ctx, const std::string& clientId, const SessionReply& reply);
+    bool   ResumeSession(std::shared_ptr<ClientContext> ctx, uint64_t token, uint64_t acked, uint64_t resendFrom,
+        const SessionReply& reply);
+    BufferLease EncodeFor(const ConnectionSettings& settings, const BufferLease& buffer);
+    void   DetachSession(ClientContext& ctx);
+    void   EnqueueControl(std::shared_ptr<ClientContext> ctx, std::vector<uint8_t> frame);
+    void   EnqueueOutbound(ClientContext& ctx, BufferLease buffer, const std::string& conflationKey = {});
+    void   QueueOutboundLocked(ClientContext& ctx, BufferLease buffer, const std::string& conflationKey = {});
+    bool   ConflateLocked(ClientContext& ctx, const std::string& conflationKey, BufferLease& buffer);
+    void   QueueBacklogLocked(ClientContext& ctx, BufferLease buffer);
+    void   RecordSentLocked(ClientContext& ctx, const BufferLease& buffer);
+    BufferLease MakeOutbound(const std::vector<uint8_t>& payload);
+    bool   NextWriteBatch(ClientContext& ctx, WriteBatch& batch);
+    void   RecordWrite(const WriteBatch& batch);
+    bool   WriteToPipe(std::shared_ptr<ClientContext> ctx, const uint8_t* data, size_t size);
     void   CloseClient(std::shared_ptr<ClientContext> ctx);
     void   BindClientId(std::shared_ptr<ClientContext> ctx, const std::string& clientId);
-    void   EnqueueReceived(const PipeMessage& msg);
+    void   EnqueueReceived(PipeMessageView msg);
 
 private:
     std::wstring            m_pipeName;
@@ -116,9 +320,29 @@ private:
     mutable std::mutex      m_clientsMutex;
     std::unordered_map<std::string, std::shared_ptr<ClientContext>> m_clients;
 
-    std::queue<PipeMessage> m_receiveData;
+    std::shared_ptr<BufferPool> m_pool;
+    SessionStore            m_sessions;
+    MailboxStore            m_mailboxes;
+
+    std::queue<PipeMessageView> m_receiveData;
     mutable std::mutex      m_recvMutex;
     std::condition_variable m_recvCv;
 
     MessageHandler          m_handler = nullptr;
+    StreamAcceptor          m_streamAcceptor = nullptr;
+    BatchConfig             m_batchConfig;
+
+    std::atomic<uint64_t>   m_messagesSent{ 0 };
+    std::atomic<uint64_t>   m_fragmentsSent{ 0 };
+    std::atomic<uint64_t>   m_bytesSent{ 0 };
+    std::atomic<uint64_t>   m_writes{ 0 };
+    std::atomic<uint64_t>   m_creditStalls{ 0 };
+    std::atomic<uint64_t>   m_conflated{ 0 };
+    std::atomic<uint64_t>   m_batches{ 0 };
+    std::atomic<uint64_t>   m_batchedMessages{ 0 };
+    std::atomic<uint64_t>   m_handshakes{ 0 };
+    std::atomic<uint64_t>   m_legacyClients{ 0 };
+    std::atomic<uint64_t>   m_heartbeatTimeouts{ 0 };
+    Common::Metrics::LatencyHistogram m_smallLatency;
+    Common::Metrics::LatencyHistogram m_smallLatencyUnderBulk;
 };
\ No newline at end of file
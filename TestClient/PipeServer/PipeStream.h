@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include "FrameCodec.h"
+
+// ==============================
+// ֿ䣨ͻƵ֡ 10MB ޣ
+// ֡УStreamOpen -> StreamData * N -> StreamEnd
+// أͷʼӵ STREAM_WINDOW ֽڶȣշѺ StreamCredit 黹
+//       ÿռõڴֻ봰ڴСйأܴС޹
+// ==============================
+constexpr uint32_t STREAM_WINDOW       = 256 * 1024;
+constexpr uint32_t STREAM_CHUNK_SIZE   = 64 * 1024;
+constexpr uint64_t STREAM_SIZE_UNKNOWN = UINT64_MAX;
+
+enum class StreamStatus : uint32_t
+{
+    Completed = 0,
+    Aborted   = 1,
+    Rejected  = 2,
+};
+
+// ߣɷ̰߳ȡҪһԳ
+class StreamProducer
+{
+public:
+    virtual ~StreamProducer() = default;
+
+    //  buffer д capacity ֽڣʵд 0 ʾݽ
+    virtual size_t Produce(uint8_t* buffer, size_t capacity) = 0;
+
+    // ܴСδ֪ʱ STREAM_SIZE_UNKNOWNڸ֪Զ
+    virtual uint64_t TotalSize() const { return STREAM_SIZE_UNKNOWN; }
+};
+
+// ߣڶ߳бλص
+class StreamConsumer
+{
+public:
+    virtual ~StreamConsumer() = default;
+
+    //  false ʾֹ
+    virtual bool OnData(const uint8_t* data, size_t size) = 0;
+
+    // completed Ϊ false ʾֹӶϿ
+    virtual void OnEnd(bool completed) = 0;
+};
+
+// ļȡߣ־ȳ
+class FileStreamProducer : public StreamProducer
+{
+public:
+    explicit FileStreamProducer(const std::filesystem::path& path)
+        : m_file(path, std::ios::binary)
+    {
+        if (m_file) {
+            m_file.seekg(0, std::ios::end);
+            m_size = static_cast<uint64_t>(m_file.tellg());
+            m_file.seekg(0, std::ios::beg);
+        }
+    }
+
+    bool IsOpen() const { return m_file.is_open(); }
+
+    size_t Produce(uint8_t* buffer, size_t capacity) override
+    {
+        if (!m_file)
+            return 0;
+        m_file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(capacity));
+        return static_cast<size_t>(m_file.gcount());
+    }
+
+    uint64_t TotalSize() const override { return m_size; }
+
+private:
+    std::ifstream   m_file;
+    uint64_t        m_size = STREAM_SIZE_UNKNOWN;
+};
+
+// ---------- ֡ ----------
+
+inline void EncodeStreamOpen(std::vector<uint8_t>& out, uint32_t streamId, uint64_t totalSize, const std::string& meta)
+{
+    uint32_t length = static_cast<uint32_t>(sizeof(uint32_t) + sizeof(uint64_t) + meta.size());
+    AppendU32(out, MakeFrameHeader(FrameKind::StreamOpen, length));
+    AppendU32(out, streamId);
+    AppendU64(out, totalSize);
+    out.insert(out.end(), meta.begin(), meta.end());
+}
+
+// kind Ϊ StreamEnd / StreamCredit / StreamReset߶ [u32 streamId][u32 value]
+inline void EncodeStreamControl(std::vector<uint8_t>& out, FrameKind kind, uint32_t streamId, uint32_t value)
+{
+    AppendU32(out, MakeFrameHeader(kind, 2 * sizeof(uint32_t)));
+    AppendU32(out, streamId);
+    AppendU32(out, value);
+}
@@ -0,0 +1,176 @@
+#include "SessionStore.h"
+
+ReplayBuffer::ReplayBuffer(size_t maxMessages, size_t maxBytes)
+    : m_maxMessages(maxMessages)
+    , m_maxBytes(maxBytes)
+{
+
+}
+
+uint64_t ReplayBuffer::Append(BufferLease message)
+{
+    m_bytes += message->Size();
+    m_messages.push_back(std::move(message));
+    m_lastSeq++;
+
+    while (!m_messages.empty() && (m_messages.size() > m_maxMessages || m_bytes > m_maxBytes)) {
+        m_bytes -= m_messages.front()->Size();
+        m_messages.pop_front();
+        m_firstSeq++;
+    }
+    return m_lastSeq;
+}
+
+void ReplayBuffer::Ack(uint64_t seq)
+{
+    while (!m_messages.empty() && m_firstSeq <= seq) {
+        m_bytes -= m_messages.front()->Size();
+        m_messages.pop_front();
+        m_firstSeq++;
+    }
+}
+
+bool ReplayBuffer::Since(uint64_t acked, std::vector<BufferLease>& out) const
+{
+    if (acked + 1 < m_firstSeq || acked > m_lastSeq)
+        return false;
+
+    for (size_t i = static_cast<size_t>(acked + 1 - m_firstSeq); i < m_messages.size(); ++i) {
+        out.push_back(m_messages[i]);
+    }
+    return true;
+}
+
+void ReplayBuffer::Reset()
+{
+    m_messages.clear();
+    m_firstSeq = 1;
+    m_lastSeq = 0;
+    m_bytes = 0;
+}
+
+SessionStore::SessionStore(uint64_t ttlMs)
+    : m_ttlMs(ttlMs)
+{
+
+}
+
+std::shared_ptr<PipeSession> SessionStore::Create(const std::string& clientId, uint64_t nowMs)
+{
+    auto session = std::make_shared<PipeSession>();
+    session->clientId = clientId;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    ExpireLocked(nowMs);
+
+    auto old = m_byClient.find(clientId);
+    if (old != m_byClient.end()) {
+        m_sessions.erase(old->second);
+        m_byClient.erase(old);
+    }
+
+    //  0 ܡ
+    do {
+        session->token = m_random();
+    } while (session->token == 0 || m_sessions.count(session->token));
+
+    m_sessions.emplace(session->token, session);
+    m_byClient.emplace(clientId, session->token);
+    return session;
+}
+
+std::shared_ptr<PipeSession> SessionStore::Find(uint64_t token, uint64_t nowMs)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    ExpireLocked(nowMs);
+
+    auto it = m_sessions.find(token);
+    return it != m_sessions.end() ? it->second : nullptr;
+}
+
+bool SessionStore::Resume(const std::shared_ptr<PipeSession>& session, uint64_t acked, uint64_t resendFrom, ResumePlan& plan)
+{
+    bool ok = false;
+    if (session) {
+        std::lock_guard<std::mutex> slk(session->mutex);
+        // ͻֻյ Ack üresendFrom ֮ǰзûյϢ˵˫״̬һ
+        ok = resendFrom >= 1 && resendFrom <= session->received + 1
+            && session->replay.Since(acked, plan.replay);
+        if (ok) {
+            session->replay.Ack(acked);
+            plan.pending.swap(session->pending);
+            plan.received = session->received;
+            plan.duplicates = session->received + 1 - resendFrom;
+        }
+        else {
+            plan.replay.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!ok) {
+        if (session) {
+            RemoveLocked(*session);
+        }
+        m_resumeFailures++;
+        return false;
+    }
+
+    session->attached = true;
+    m_resumed++;
+    m_replayed += plan.replay.size() + plan.pending.size();
+    return true;
+}
+
+void SessionStore::Detach(const std::shared_ptr<PipeSession>& session, uint64_t nowMs)
+{
+    if (!session)
+        return;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    session->attached = false;
+    session->detachedMs = nowMs;
+}
+
+SessionStats SessionStore::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    SessionStats stats;
+    stats.sessions = m_sessions.size();
+    stats.resumed = m_resumed;
+    stats.resumeFailures = m_resumeFailures;
+    stats.replayed = m_replayed;
+    stats.expired = m_expired;
+    return stats;
+}
+
+void SessionStore::ExpireLocked(uint64_t nowMs)
+{
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        const PipeSession& session = *it->second;
+        if (!session.attached && nowMs - session.detachedMs > m_ttlMs) {
+            auto byClient = m_byClient.find(session.clientId);
+            if (byClient != m_byClient.end() && byClient->second == session.token) {
+                m_byClient.erase(byClient);
+            }
+            it = m_sessions.erase(it);
+            m_expired++;
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void SessionStore::RemoveLocked(const PipeSession& session)
+{
+    auto it = m_sessions.find(session.token);
+    if (it == m_sessions.end() || it->second.get() != &session)
+        return;
+
+    auto byClient = m_byClient.find(session.clientId);
+    if (byClient != m_byClient.end() && byClient->second == session.token) {
+        m_byClient.erase(byClient);
+    }
+    m_sessions.erase(it);
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include "BufferPool.h"
+#include "PayloadCodec.h"
+
+// ==============================
+// Ự
+// - 󶨺ÿϢţ 1 ʼ֡ƣFragment ɲյ
+// - ͷдδȷϵϢԶÿյ ACK_INTERVAL һ Ack ֡ͷݴ˲ü
+// - ʱͻ֡ Resume + յķϢ + طʼţ
+//   ԼδȷϵϢ˻ Session ֻ֡طȱʧϢͻطյĲ
+// - δ֪ỰѹڻطŻѲõϢʱ token Ϊ 0  Session ֡ͻ°
+// - ֻѡӲŽỰ״Ϊ 0  Resume ֡ͷ󷢰֡˻ Session ֡·ƣ
+//   ֱԴı clientId 󶨵ľɿͻ˲Ựֻյ Message ֡
+// ==============================
+
+constexpr uint64_t ACK_INTERVAL = 32;
+
+// ReplayBufferдȴԶȷϵϢ̰߳ȫʹ÷
+// - ֽʱɵϢ֮Ӹʧ
+class ReplayBuffer
+{
+public:
+    explicit ReplayBuffer(size_t maxMessages = 4096, size_t maxBytes = 8 * 1024 * 1024);
+
+    // ¼һдϢѷ֡ĳػ壩
+    uint64_t Append(BufferLease message);
+
+    // Զյ seq ֮ǰϢ
+    void Ack(uint64_t seq);
+
+    // ȡ acked ֮ȫϢϢѱ acked ѷͷΧʱ false
+    bool Since(uint64_t acked, std::vector<BufferLease>& out) const;
+
+    // »Ựղ 1 ¿ʼ
+    void Reset();
+
+    uint64_t FirstSeq() const { return m_firstSeq; }  // δȷϢ
+    uint64_t LastSeq() const { return m_lastSeq; }
+    size_t   Count() const { return m_messages.size(); }
+    size_t   Bytes() const { return m_bytes; }
+
+private:
+    size_t                  m_maxMessages;
+    size_t                  m_maxBytes;
+
+    std::deque<BufferLease> m_messages;                 // Ϊ m_firstSeq
+    uint64_t                m_firstSeq = 1;
+    uint64_t                m_lastSeq = 0;
+    size_t                  m_bytes = 0;
+};
+
+// һĻỰ״̬ӶϿ TTL ʱ
+struct PipeSession
+{
+    uint64_t                 token = 0;
+    std::string              clientId;
+
+    // ỰʱЭ̵ĸظʽֻ֮طδдϢѰ˱룬
+    PayloadEncoding          encoding = PayloadEncoding::Json;
+    PayloadCompression       compression = PayloadCompression::None;
+
+    std::mutex               mutex;                     // ֶΣӵ sendMutex ֮
+    ReplayBuffer             replay;                    //  -> ͻ
+    std::deque<BufferLease>  pending;                   // ʱδдϢŷ
+    uint64_t                 received = 0;              // յĿͻϢ
+
+    //  SessionStore 
+    bool                     attached = true;
+    uint64_t                 detachedMs = 0;
+};
+
+// ʱҪ
+struct ResumePlan
+{
+    std::vector<BufferLease> replay;                    // дͻδյ˳
+    std::deque<BufferLease>  pending;                   // ʱδд
+    uint64_t                 received = 0;              // յĿͻϢظͻˣ
+    uint64_t                 duplicates = 0;            // ͻطзյӦ
+};
+
+struct SessionStats
+{
+    uint64_t                 sessions = 0;              // ǰĻỰѶϿģ
+    uint64_t                 resumed = 0;
+    uint64_t                 resumeFailures = 0;
+    uint64_t                 replayed = 0;              // ʱطϢ
+    uint64_t                 expired = 0;
+};
+
+// ==============================
+// SessionStore -> ỰϿĻỰ TTL һ Create/Find ʱ
+// ͬһ clientId °ʱ滻ɻỰ
+// ==============================
+class SessionStore
+{
+public:
+    explicit SessionStore(uint64_t ttlMs = 60'000);
+
+    std::shared_ptr<PipeSession> Create(const std::string& clientId, uint64_t nowMs);
+
+    // ƲңıỰ״̬δ֪ѹڷ nullptr
+    std::shared_ptr<PipeSession> Find(uint64_t token, uint64_t nowMs);
+
+    // ͻյ acked  resendFrom طԼϢ
+    // ɹʱȡ貹ϢỰ¹ҵӣǰֹͣд
+    // һ޷ʱʧܲƳỰsession ΪҲΪʧܣ
+    bool Resume(const std::shared_ptr<PipeSession>& session, uint64_t acked, uint64_t resendFrom, ResumePlan& plan);
+
+    void Detach(const std::shared_ptr<PipeSession>& session, uint64_t nowMs);
+
+    SessionStats GetStats() const;
+
+private:
+    void ExpireLocked(uint64_t nowMs);
+    void RemoveLocked(const PipeSession& session);
+
+private:
+    uint64_t                m_ttlMs;
+
+    mutable std::mutex      m_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<PipeSession>> m_sessions;
+    std::unordered_map<std::string, uint64_t> m_byClient;
+    std::mt19937_64         m_random{ std::random_device{}() };
+
+    uint64_t                m_resumed = 0;
+    uint64_t                m_resumeFailures = 0;
+    uint64_t                m_replayed = 0;
+    uint64_t                m_expired = 0;
+};
@@ -0,0 +1,346 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <variant>
+#include <type_traits>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include "WorkerPool.h"
+#include "..\PipeServer\PipeStream.h"
+
+// ==============================
+// Э̴֧֣C++20
+// - Task<T> co_await ʱſʼִУԳתƻصȴ
+// - DetachedTask٣ڴ̷ͨ߳һЭ
+// - ȴ壨SwitchTo/SleepFor/Offload/AsyncStreamConsumer::ReadChunk WorkerPool ϻָ
+// ЭֻռһЭ֡ռ߳
+// ע⣺Э̲밴ֵݣòڵһιʧЧ
+// ==============================
+
+template <typename T = void>
+class Task;
+
+namespace AsyncDetail
+{
+    class PromiseBase
+    {
+    public:
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+            {
+                auto continuation = h.promise().m_continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { m_error = std::current_exception(); }
+
+        std::coroutine_handle<> m_continuation;
+        std::exception_ptr      m_error;
+    };
+
+    template <typename T>
+    class Promise : public PromiseBase
+    {
+    public:
+        Task<T> get_return_object();
+
+        template <typename U>
+        void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+
+        T TakeResult()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+            return std::move(*m_value);
+        }
+
+    private:
+        std::optional<T>        m_value;
+    };
+
+    template <>
+    class Promise<void> : public PromiseBase
+    {
+    public:
+        Task<void> get_return_object();
+
+        void return_void() {}
+
+        void TakeResult()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+        }
+    };
+}
+
+template <typename T>
+class Task
+{
+public:
+    using promise_type = AsyncDetail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle h) : m_handle(h) {}
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool Valid() const { return static_cast<bool>(m_handle); }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            Handle handle;
+
+            bool await_ready() noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().m_continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().TakeResult(); }
+        };
+        return Awaiter{ m_handle };
+    }
+
+private:
+    Handle                  m_handle;
+};
+
+namespace AsyncDetail
+{
+    template <typename T>
+    Task<T> Promise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+}
+
+// Э̣쳣Эڴδ쳣ᱻ
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+    };
+};
+
+// co_await SwitchTo(pool)лִ̼߳
+inline auto SwitchTo(WorkerPool& pool)
+{
+    struct Awaiter
+    {
+        WorkerPool& pool;
+
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { pool.Post(h); }
+        void await_resume() noexcept {}
+    };
+    return Awaiter{ pool };
+}
+
+// co_await SleepFor(pool, delay)ڷ trueֹ̳߳ͣʱǰ false
+inline auto SleepFor(WorkerPool& pool, std::chrono::milliseconds delay)
+{
+    struct Awaiter
+    {
+        WorkerPool&             pool;
+        std::chrono::milliseconds delay;
+        bool                    expired = false;
+
+        bool await_ready() noexcept { return delay.count() <= 0; }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            pool.PostAfter(delay, [this, h](bool ok) {
+                expired = ok;
+                h.resume();
+                });
+        }
+
+        bool await_resume() noexcept { return delay.count() <= 0 || expired; }
+    };
+    return Awaiter{ pool, delay };
+}
+
+// co_await Offload(cpuPool, resumePool, fn) cpuPool ִкʱ㣬ص resumePool ϵЭ
+// ڶ̳߳أⳤʱռô߳
+template <typename F>
+auto Offload(WorkerPool& cpuPool, WorkerPool& resumePool, F fn)
+{
+    using Result = std::invoke_result_t<F&>;
+    using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    struct Awaiter
+    {
+        WorkerPool&             cpuPool;
+        WorkerPool&             resumePool;
+        F                       fn;
+        std::optional<Storage>  result;
+        std::exception_ptr      error;
+
+        bool await_ready() noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            cpuPool.Post([this, h]() {
+                try {
+                    if constexpr (std::is_void_v<Result>) {
+                        fn();
+                        result.emplace();
+                    }
+                    else {
+                        result.emplace(fn());
+                    }
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+                resumePool.Post(h);
+                });
+        }
+
+        Result await_resume()
+        {
+            if (error)
+                std::rethrow_exception(error);
+            if constexpr (!std::is_void_v<Result>)
+                return std::move(*result);
+        }
+    };
+    return Awaiter{ cpuPool, resumePool, std::move(fn) };
+}
+
+// ==============================
+// AsyncStreamConsumerѿͻϴתɿɵȴݿ
+// -  StreamAcceptor ظ PipeServer̻߳ص OnData/OnEnd
+// - Эѭ co_await ReadChunk() nullopt ʾCompleted() /ֹ
+// - ÿֻһЭ̵ȴ泬 maxBuffered ʱֹֹѹʱ޶ѻ
+// ==============================
+class AsyncStreamConsumer : public StreamConsumer
+{
+public:
+    explicit AsyncStreamConsumer(WorkerPool& pool, size_t maxBuffered = 4 * STREAM_WINDOW)
+        : m_pool(pool)
+        , m_maxBuffered(maxBuffered)
+    {
+    }
+
+    bool OnData(const uint8_t* data, size_t size) override
+    {
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (m_buffered + size > m_maxBuffered)
+                return false;
+            m_chunks.emplace_back(data, data + size);
+            m_buffered += size;
+            waiter = std::exchange(m_waiter, {});
+        }
+        if (waiter)
+            m_pool.Post(waiter);
+        return true;
+    }
+
+    void OnEnd(bool completed) override
+    {
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_ended = true;
+            m_completed = completed;
+            waiter = std::exchange(m_waiter, {});
+        }
+        if (waiter)
+            m_pool.Post(waiter);
+    }
+
+    bool Completed() const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        return m_completed;
+    }
+
+    auto ReadChunk()
+    {
+        struct Awaiter
+        {
+            AsyncStreamConsumer& self;
+
+            bool await_ready() noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> h)
+            {
+                std::lock_guard<std::mutex> lk(self.m_mutex);
+                if (!self.m_chunks.empty() || self.m_ended)
+                    return false;
+                self.m_waiter = h;
+                return true;
+            }
+
+            std::optional<std::vector<uint8_t>> await_resume()
+            {
+                std::lock_guard<std::mutex> lk(self.m_mutex);
+                if (self.m_chunks.empty())
+                    return std::nullopt;
+                std::vector<uint8_t> chunk = std::move(self.m_chunks.front());
+                self.m_chunks.pop_front();
+                self.m_buffered -= chunk.size();
+                return chunk;
+            }
+        };
+        return Awaiter{ *this };
+    }
+
+private:
+    WorkerPool&             m_pool;
+    size_t                  m_maxBuffered;
+
+    mutable std::mutex      m_mutex;
+    std::deque<std::vector<uint8_t>> m_chunks;
+    size_t                  m_buffered = 0;
+    bool                    m_ended = false;
+    bool                    m_completed = false;
+    std::coroutine_handle<> m_waiter;
+};
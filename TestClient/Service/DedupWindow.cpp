@@ -0,0 +1,150 @@
+#include "DedupWindow.h"
+
+DedupWindow::DedupWindow(size_t maxPerClient, std::chrono::milliseconds ttl,
+    size_t maxResponseBytes, size_t maxClientBytes)
+    : m_maxPerClient(maxPerClient)
+    , m_ttl(ttl)
+    , m_maxResponseBytes(maxResponseBytes)
+    , m_maxClientBytes(maxClientBytes)
+{
+
+}
+
+DedupWindow::Verdict DedupWindow::Check(const std::string& clientId, const std::string& msgId, std::vector<uint8_t>& replay)
+{
+    Clock::time_point start = Clock::now();
+    Verdict verdict = Verdict::New;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stats.lookups++;
+
+        ClientWindow& window = m_clients[clientId];
+        window.lastUsed = start;
+
+        auto it = window.entries.find(msgId);
+        if (it != window.entries.end() && start - it->second.time < m_ttl) {
+            m_stats.duplicates++;
+            if (it->second.hasResponse) {
+                replay = it->second.response;
+                m_stats.replays++;
+                verdict = Verdict::Replay;
+            }
+            else {
+                verdict = Verdict::Pending;
+            }
+        }
+        else {
+            if (it != window.entries.end()) {
+                // ڵͬĿ
+                window.bytes -= it->second.response.size();
+                m_bytes -= it->second.response.size();
+                window.entries.erase(it);
+                m_entries--;
+            }
+
+            Entry e;
+            e.seq = ++m_inserts;
+            e.time = start;
+            window.entries.emplace(msgId, std::move(e));
+            window.order.emplace_back(m_inserts, msgId);
+            m_entries++;
+            TrimLocked(window, start);
+
+            // ʱϢĿͻ
+            if (m_inserts % 1024 == 0) {
+                SweepLocked(start);
+            }
+        }
+    }
+
+    m_lookupNs.Record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    return verdict;
+}
+
+void DedupWindow::Complete(const std::string& clientId, const std::string& msgId, std::span<const uint8_t> response)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto cw = m_clients.find(clientId);
+    if (cw == m_clients.end())
+        return;
+
+    ClientWindow& window = cw->second;
+    auto it = window.entries.find(msgId);
+    if (it == window.entries.end() || it->second.done)
+        return;
+
+    it->second.done = true;
+    if (!response.empty() && response.size() <= m_maxResponseBytes) {
+        it->second.response.assign(response.begin(), response.end());
+        it->second.hasResponse = true;
+        window.bytes += response.size();
+        m_bytes += response.size();
+        TrimLocked(window, Clock::now());
+    }
+}
+
+void DedupWindow::Abandon(const std::string& clientId, const std::string& msgId)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto cw = m_clients.find(clientId);
+    if (cw == m_clients.end())
+        return;
+
+    ClientWindow& window = cw->second;
+    auto it = window.entries.find(msgId);
+    if (it != window.entries.end() && !it->second.done) {
+        window.entries.erase(it);
+        m_entries--;
+    }
+}
+
+DedupStats DedupWindow::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    DedupStats stats = m_stats;
+    stats.entries = m_entries;
+    stats.bytes = m_bytes;
+    stats.lookupP50Ns = m_lookupNs.Percentile(50);
+    stats.lookupP99Ns = m_lookupNs.Percentile(99);
+    return stats;
+}
+
+// ɵĿʼƳֱĿֽɵδ
+void DedupWindow::TrimLocked(ClientWindow& window, Clock::time_point now)
+{
+    while (!window.order.empty())
+    {
+        auto it = window.entries.find(window.order.front().second);
+        if (it == window.entries.end() || it->second.seq != window.order.front().first) {
+            window.order.pop_front();       // ѱ Abandon ں²
+            continue;
+        }
+
+        bool over = window.entries.size() > m_maxPerClient
+            || window.bytes > m_maxClientBytes
+            || now - it->second.time >= m_ttl;
+        if (!over)
+            break;
+
+        window.bytes -= it->second.response.size();
+        m_bytes -= it->second.response.size();
+        window.entries.erase(it);
+        window.order.pop_front();
+        m_entries--;
+        m_stats.evictions++;
+    }
+}
+
+void DedupWindow::SweepLocked(Clock::time_point now)
+{
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+        TrimLocked(it->second, now);
+        if (it->second.entries.empty() && now - it->second.lastUsed >= m_ttl) {
+            it = m_clients.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <span>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include "..\Common\LatencyHistogram.h"
+
+struct DedupStats
+{
+    uint64_t                 lookups = 0;
+    uint64_t                 duplicates = 0;            // дڵظ msgId
+    uint64_t                 replays = 0;               // лط˻ӦĴ
+    uint64_t                 evictions = 0;             // /ֽ޻ڱƳ
+    uint64_t                 entries = 0;
+    uint64_t                 bytes = 0;
+
+    // βҺʱ룬
+    uint64_t                 lookupP50Ns = 0;
+    uint64_t                 lookupP99Ns = 0;
+};
+
+// ==============================
+// DedupWindowͻ˼¼ msgIdطµظִ
+// - ÿͻౣ maxPerClient  msgId˳̭ ttl ͬƳ
+// - еظֱӶԭӦᷢɵĻطŻӦ
+// - Ӧ maxResponseBytes ʱֻ msgId ģظ󱻶
+// - ÿͻ˻ maxClientBytes
+// ==============================
+class DedupWindow
+{
+public:
+    enum class Verdict
+    {
+        New,                    // ״γ֣ɺ Complete
+        Pending,                // ԭڴ޿ɻطŵӦ
+        Replay,                 // replay ΪӦ
+    };
+
+    explicit DedupWindow(size_t maxPerClient = 256,
+        std::chrono::milliseconds ttl = std::chrono::seconds(60),
+        size_t maxResponseBytes = 64 * 1024,
+        size_t maxClientBytes = 1024 * 1024);
+
+    Verdict Check(const std::string& clientId, const std::string& msgId, std::vector<uint8_t>& replay);
+    void Complete(const std::string& clientId, const std::string& msgId, std::span<const uint8_t> response);
+    // ʧܣ쳣ûпɻطŵӦʱƳִ
+    void Abandon(const std::string& clientId, const std::string& msgId);
+
+    DedupStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        uint64_t                seq = 0;
+        bool                    done = false;
+        bool                    hasResponse = false;
+        std::vector<uint8_t>    response;
+        Clock::time_point       time;
+    };
+
+    struct ClientWindow
+    {
+        std::unordered_map<std::string, Entry> entries;
+        std::deque<std::pair<uint64_t, std::string>> order; // ˳seq, msgIdܺƳĿ
+        size_t                  bytes = 0;
+        Clock::time_point       lastUsed;
+    };
+
+    void TrimLocked(ClientWindow& window, Clock::time_point now);
+    void SweepLocked(Clock::time_point now);
+
+private:
+    size_t                  m_maxPerClient;
+    std::chrono::milliseconds m_ttl;
+    size_t                  m_maxResponseBytes;
+    size_t                  m_maxClientBytes;
+
+    mutable std::mutex      m_mutex;
+    std::unordered_map<std::string, ClientWindow> m_clients;
+    uint64_t                m_inserts = 0;
+    size_t                  m_entries = 0;
+    size_t                  m_bytes = 0;
+
+    DedupStats              m_stats;
+    Common::Metrics::LatencyHistogram m_lookupNs;
+};
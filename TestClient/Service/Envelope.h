@@ -0,0 +1,186 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <charconv>
+#include <span>
+#include <string_view>
+#include "../PipeServer/PipeMessage.h"
+
+// ==============================
+// ŷֶεȡֻɨ趥ļ DOMڳʱĿж
+// - ֵֶԭʼ JSON ıأַţԭƴӦ
+// - УϢĺϷԣṹʱΪδҵ
+//
+// deadline
+// - "deadline"UTC ʱ timestamp ͬһʱӣ
+// - "timeoutMs"ӷյϢPipeMessage::timestampMsĺ0 ʾ
+// - ͬʱȡߣûбʾʱ
+// ==============================
+
+namespace EnvelopeDetail
+{
+    constexpr size_t NPOS = std::string_view::npos;
+
+    inline size_t SkipSpace(std::string_view s, size_t i)
+    {
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\n' || s[i] == '\r'))
+            ++i;
+        return i;
+    }
+
+    // i ָʼţؽ֮λ
+    inline size_t SkipString(std::string_view s, size_t i)
+    {
+        for (++i; i < s.size(); ++i) {
+            if (s[i] == '\\')
+                ++i;
+            else if (s[i] == '"')
+                return i + 1;
+        }
+        return NPOS;
+    }
+
+    inline size_t SkipValue(std::string_view s, size_t i)
+    {
+        if (i >= s.size())
+            return NPOS;
+        if (s[i] == '"')
+            return SkipString(s, i);
+
+        if (s[i] == '{' || s[i] == '[') {
+            size_t depth = 0;
+            while (i < s.size()) {
+                char c = s[i];
+                if (c == '"') {
+                    i = SkipString(s, i);
+                    if (i == NPOS)
+                        return NPOS;
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                }
+                else if ((c == '}' || c == ']') && --depth == 0) {
+                    return i + 1;
+                }
+                ++i;
+            }
+            return NPOS;
+        }
+
+        //  / true / false / null
+        while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ']'
+            && s[i] != ' ' && s[i] != '\t' && s[i] != '\n' && s[i] != '\r')
+            ++i;
+        return i;
+    }
+}
+
+// λصֶ (name, rawValue)ص false ʱֹͣ
+template <typename F>
+bool ForEachEnvelopeField(std::string_view json, F&& fn)
+{
+    using namespace EnvelopeDetail;
+
+    size_t i = SkipSpace(json, 0);
+    if (i >= json.size() || json[i] != '{')
+        return false;
+
+    i = SkipSpace(json, i + 1);
+    while (i < json.size() && json[i] == '"') {
+        size_t nameEnd = SkipString(json, i);
+        if (nameEnd == NPOS)
+            return false;
+        std::string_view name = json.substr(i + 1, nameEnd - i - 2);
+
+        i = SkipSpace(json, nameEnd);
+        if (i >= json.size() || json[i] != ':')
+            return false;
+        i = SkipSpace(json, i + 1);
+
+        size_t valueEnd = SkipValue(json, i);
+        if (valueEnd == NPOS || valueEnd == i)
+            return false;
+        if (!fn(name, json.substr(i, valueEnd - i)))
+            return true;
+
+        i = SkipSpace(json, valueEnd);
+        if (i >= json.size() || json[i] != ',')
+            break;
+        i = SkipSpace(json, i + 1);
+    }
+    return true;
+}
+
+inline bool FindEnvelopeField(std::string_view json, std::string_view key, std::string_view& value)
+{
+    bool found = false;
+    ForEachEnvelopeField(json, [&](std::string_view name, std::string_view raw) {
+        if (name != key)
+            return true;
+        value = raw;
+        found = true;
+        return false;
+        });
+    return found;
+}
+
+inline std::string_view AsText(std::span<const uint8_t> bytes)
+{
+    return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+//  type ǷΪ "Error"ֻŷⱾpayload ͬļӰж
+inline bool IsErrorEnvelope(std::span<const uint8_t> envelope)
+{
+    std::string_view type;
+    return FindEnvelopeField(AsText(envelope), "type", type) && type == "\"Error\"";
+}
+
+// UTC 루Unix Ԫ PipeMessage::timestampMsŷе deadline ͬһʱ
+inline uint64_t UtcNowMs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+//  PipeMessage::receivedUs ͬһʱ
+inline uint64_t SteadyNowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//  deadlineUTC 룩ûл޷ʶʱ 0
+inline uint64_t ReadDeadline(std::span<const uint8_t> envelope, uint64_t receivedMs)
+{
+    uint64_t deadline = 0;
+    auto tighten = [&deadline](uint64_t value) {
+        if (value != 0 && (deadline == 0 || value < deadline))
+            deadline = value;
+    };
+
+    ForEachEnvelopeField(AsText(envelope), [&](std::string_view name, std::string_view raw) {
+        if (name != "deadline" && name != "timeoutMs")
+            return true;
+
+        uint64_t value = 0;
+        auto result = std::from_chars(raw.data(), raw.data() + raw.size(), value);
+        if (result.ec != std::errc() || result.ptr == raw.data())
+            return true;
+
+        if (name == "deadline")
+            tighten(value);
+        else if (value > 0)
+            tighten(receivedMs + value);
+        return true;
+        });
+    return deadline;
+}
+
+// пʱ飬 deadline ͻѲٵȴ
+inline bool DeadlineExceeded(const PipeMessage& msg)
+{
+    return msg.deadlineMs != 0 && UtcNowMs() >= msg.deadlineMs;
+}
@@ -0,0 +1,102 @@
+#include "LoadShedder.h"
+#include <cmath>
+
+LoadShedder::LoadShedder(LoadShedConfig config)
+    : m_config(config)
+{
+
+}
+
+void LoadShedder::Configure(LoadShedConfig config)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_config = config;
+    m_firstAboveUs = 0;
+    m_dropping = false;
+}
+
+bool LoadShedder::Enabled() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_config.enabled;
+}
+
+bool LoadShedder::IsSheddableType(MessageType type) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return type != MessageType::Unknown && (m_config.sheddableTypes >> static_cast<uint32_t>(type)) & 1u;
+}
+
+bool LoadShedder::OnDequeue(uint64_t sojournUs, uint64_t nowUs, bool sheddable)
+{
+    m_sojournUs.Record(sojournUs);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_config.enabled) {
+        bool okToDrop = OkToDropLocked(sojournUs, nowUs);
+        if (m_dropping) {
+            if (!okToDrop) {
+                m_dropping = false;
+            }
+            else if (sheddable && nowUs >= m_dropNextUs) {
+                // ʱǲɶϢƽһɶĲ
+                m_count++;
+                m_dropNextUs = ControlLawLocked(m_dropNextUs);
+                m_stats.shed++;
+                return true;
+            }
+        }
+        else if (okToDrop) {
+            m_dropping = true;
+            m_stats.episodes++;
+
+            // ϴζ״̬սãýӽʱĶ
+            uint32_t delta = m_count - m_lastCount;
+            bool recent = static_cast<int64_t>(nowUs - m_dropNextUs) < static_cast<int64_t>(16 * m_config.intervalUs);
+            m_count = (delta > 1 && recent) ? delta : 1;
+            m_lastCount = m_count;
+            if (sheddable) {
+                m_dropNextUs = ControlLawLocked(nowUs);
+                m_stats.shed++;
+                return true;
+            }
+
+            // ʱɶһɶϢϣճƽ
+            m_count--;
+            m_lastCount = m_count;
+            m_dropNextUs = nowUs;
+        }
+    }
+
+    m_stats.admitted++;
+    return false;
+}
+
+LoadShedStats LoadShedder::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    LoadShedStats stats = m_stats;
+    stats.dropping = m_dropping ? 1 : 0;
+    stats.sojournP50Us = m_sojournUs.Percentile(50);
+    stats.sojournP99Us = m_sojournUs.Percentile(99);
+    return stats;
+}
+
+// ʱӵ target λ target  interval ݵͻ
+bool LoadShedder::OkToDropLocked(uint64_t sojournUs, uint64_t nowUs)
+{
+    if (sojournUs < m_config.targetUs) {
+        m_firstAboveUs = 0;
+        return false;
+    }
+    if (m_firstAboveUs == 0) {
+        m_firstAboveUs = nowUs + m_config.intervalUs;
+        return false;
+    }
+    return nowUs >= m_firstAboveUs;
+}
+
+uint64_t LoadShedder::ControlLawLocked(uint64_t t) const
+{
+    return t + static_cast<uint64_t>(static_cast<double>(m_config.intervalUs) / std::sqrt(static_cast<double>(m_count)));
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include "MessageDispatch.h"
+#include "..\Common\LatencyHistogram.h"
+
+struct LoadShedConfig
+{
+    bool                     enabled = false;
+    uint64_t                 targetUs = 5'000;          // ɽܵŶʱ
+    uint64_t                 intervalUs = 100'000;      // ʱӳ target ôòſʼ
+    uint32_t                 sheddableTypes = 1u << static_cast<uint32_t>(MessageType::Request);  //  MessageType λ
+};
+
+struct LoadShedStats
+{
+    uint64_t                 admitted = 0;
+    uint64_t                 shed = 0;                  // ظ Busy Ϣ
+    uint64_t                 episodes = 0;              // 붪״̬Ĵ
+    uint64_t                 dropping = 0;              // ǰǷڶ״̬0/1
+
+    // նеʼʱӣ΢룩
+    uint64_t                 sojournP50Us = 0;
+    uint64_t                 sojournP99Us = 0;
+};
+
+// ==============================
+// LoadShedderŶʱӵCoDel
+// - ÿϢʼʱŶʱӣʱӳ interval  target ʱ붪״̬
+// - ״̬° interval / sqrt(count) ļʱӻ䵽 target ¼˳
+// - ֻ sheddable ϢĬֻ Request flags.urgent ĳ⣩
+//   ֵʱɶϢ˳ӵһɶģ֡ӦӰ
+// - ĬϹرգ Configure ʽ
+// ==============================
+class LoadShedder
+{
+public:
+    explicit LoadShedder(LoadShedConfig config = {});
+
+    void Configure(LoadShedConfig config);
+    bool Enabled() const;
+    bool IsSheddableType(MessageType type) const;
+
+    //  true ʾӦ Busy ܾδʱǷ false
+    bool OnDequeue(uint64_t sojournUs, uint64_t nowUs, bool sheddable);
+
+    LoadShedStats GetStats() const;
+
+private:
+    bool OkToDropLocked(uint64_t sojournUs, uint64_t nowUs);
+    uint64_t ControlLawLocked(uint64_t t) const;
+
+private:
+    mutable std::mutex      m_mutex;
+    LoadShedConfig          m_config;
+
+    uint64_t                m_firstAboveUs = 0;         // ʱ״γ target ٹ interval ʱ
+    uint64_t                m_dropNextUs = 0;
+    uint32_t                m_count = 0;                // ζ״̬ڵĶ
+    uint32_t                m_lastCount = 0;
+    bool                    m_dropping = false;
+
+    LoadShedStats           m_stats;
+    Common::Metrics::LatencyHistogram m_sojournUs;
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ==============================
+// Ϣַ
+// -  typeHello..Goodbyeӵõϣһιϣ + һȷϱȽϼɶλ
+// - payload.actionѰַϣעʱԤȼϣʱȱȹϣȷ
+// ==============================
+
+enum class MessageType : uint8_t
+{
+    Hello,
+    Welcome,
+    Auth,
+    Heartbeat,
+    Request,
+    Response,
+    Notify,
+    Error,
+    Goodbye,
+    Unknown,
+};
+
+constexpr size_t MESSAGE_TYPE_COUNT = static_cast<size_t>(MessageType::Unknown);
+
+inline constexpr std::array<std::string_view, MESSAGE_TYPE_COUNT> MESSAGE_TYPE_NAMES = {
+    "Hello", "Welcome", "Auth", "Heartbeat", "Request", "Response", "Notify", "Error", "Goodbye",
+};
+
+// FNV-1aseed ƫƻ
+constexpr uint32_t HashName(std::string_view s, uint32_t seed = 2166136261u)
+{
+    uint32_t h = seed;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+namespace DispatchDetail
+{
+    constexpr size_t TYPE_SLOTS = 16;
+
+    constexpr bool IsPerfect(uint32_t seed)
+    {
+        bool used[TYPE_SLOTS] = {};
+        for (auto name : MESSAGE_TYPE_NAMES) {
+            size_t slot = HashName(name, seed) & (TYPE_SLOTS - 1);
+            if (used[slot])
+                return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    constexpr uint32_t FindSeed()
+    {
+        for (uint32_t i = 0; i < 100000; ++i) {
+            uint32_t seed = 2166136261u ^ i;
+            if (IsPerfect(seed))
+                return seed;
+        }
+        return 0;
+    }
+
+    constexpr uint32_t TYPE_SEED = FindSeed();
+    static_assert(TYPE_SEED != 0, "no perfect hash seed for message types");
+
+    constexpr std::array<MessageType, TYPE_SLOTS> BuildSlots()
+    {
+        std::array<MessageType, TYPE_SLOTS> slots{};
+        for (auto& s : slots)
+            s = MessageType::Unknown;
+        for (size_t i = 0; i < MESSAGE_TYPE_COUNT; ++i)
+            slots[HashName(MESSAGE_TYPE_NAMES[i], TYPE_SEED) & (TYPE_SLOTS - 1)] = static_cast<MessageType>(i);
+        return slots;
+    }
+
+    inline constexpr std::array<MessageType, TYPE_SLOTS> TYPE_TABLE = BuildSlots();
+}
+
+constexpr MessageType ParseMessageType(std::string_view s)
+{
+    MessageType t = DispatchDetail::TYPE_TABLE[HashName(s, DispatchDetail::TYPE_SEED) & (DispatchDetail::TYPE_SLOTS - 1)];
+    if (t == MessageType::Unknown || MESSAGE_TYPE_NAMES[static_cast<size_t>(t)] != s)
+        return MessageType::Unknown;
+    return t;
+}
+
+static_assert(ParseMessageType("Request") == MessageType::Request);
+static_assert(ParseMessageType("Goodbye") == MessageType::Goodbye);
+static_assert(ParseMessageType("request") == MessageType::Unknown);
+
+// ==============================
+// ActionTableaction  -> 
+// - ̽⣬Ӳ 1/2Ϊ 2 
+// - Ӧڷǰעϣֻɶ̲߳
+// ==============================
+template <typename Handler>
+class ActionTable
+{
+public:
+    // ͬظעʱ滻ԭ
+    void Register(std::string_view name, Handler handler)
+    {
+        if ((m_count + 1) * 2 > m_slots.size()) {
+            Grow();
+        }
+
+        uint32_t hash = HashName(name);
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = m_slots[i];
+            if (!slot.used) {
+                slot.used = true;
+                slot.hash = hash;
+                slot.name = std::string(name);
+                slot.handler = std::move(handler);
+                ++m_count;
+                return;
+            }
+            if (slot.hash == hash && slot.name == name) {
+                slot.handler = std::move(handler);
+                return;
+            }
+        }
+    }
+
+    const Handler* Find(std::string_view name) const
+    {
+        if (m_count == 0)
+            return nullptr;
+
+        uint32_t hash = HashName(name);
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = m_slots[i];
+            if (!slot.used)
+                return nullptr;
+            if (slot.hash == hash && slot.name == name)
+                return &slot.handler;
+        }
+    }
+
+    size_t Size() const { return m_count; }
+
+private:
+    struct Slot
+    {
+        bool                    used = false;
+        uint32_t                hash = 0;
+        std::string             name;
+        Handler                 handler;
+    };
+
+    void Grow()
+    {
+        std::vector<Slot> old = std::move(m_slots);
+        m_slots.clear();
+        m_slots.resize(old.empty() ? 16 : old.size() * 2);
+
+        size_t mask = m_slots.size() - 1;
+        for (auto& s : old) {
+            if (!s.used)
+                continue;
+            size_t i = s.hash & mask;
+            while (m_slots[i].used)
+                i = (i + 1) & mask;
+            m_slots[i] = std::move(s);
+        }
+    }
+
+private:
+    std::vector<Slot>       m_slots;
+    size_t                  m_count = 0;
+};
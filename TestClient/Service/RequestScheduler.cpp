@@ -0,0 +1,213 @@
+#include "RequestScheduler.h"
+#include "Envelope.h"
+#include <algorithm>
+
+static RequestClass Classify(const PipeMessage& msg)
+{
+    std::string_view flags;
+    std::string_view urgent;
+    if (FindEnvelopeField(AsText(msg.payload), "flags", flags)
+        && FindEnvelopeField(flags, "urgent", urgent) && urgent == "true")
+        return RequestClass::Urgent;
+    return msg.deadlineMs != 0 ? RequestClass::Deadline : RequestClass::Normal;
+}
+
+RequestScheduler::RequestScheduler(SchedulerConfig config)
+    : m_config(config)
+{
+
+}
+
+void RequestScheduler::Configure(SchedulerConfig config)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_config = config;
+}
+
+void RequestScheduler::SetWeight(const std::string& clientId, uint32_t weight)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_weights[clientId] = weight;
+}
+
+void RequestScheduler::SetWeightFunction(WeightFunction fn)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_weightFn = std::move(fn);
+}
+
+void RequestScheduler::SetMaxRunners(size_t count)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_maxRunners = count ? count : 1;
+}
+
+bool RequestScheduler::Push(PipeMessage msg)
+{
+    // ɨŷ
+    Entry entry;
+    entry.cls = Classify(msg);
+    entry.msg = std::move(msg);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    entry.seq = m_seq++;
+    m_queued++;
+
+    if (m_config.policy == SchedulePolicy::Deadline) {
+        const PipeMessage& m = entry.msg;
+        entry.dueUs = m.receivedUs + (entry.cls == RequestClass::Urgent ? m_config.urgentSlackUs : m_config.normalSlackUs);
+        if (m.deadlineMs != 0) {
+            // deadlineMs  timestampMs ͬΪ UTC 룺ʱʣʱ㵽 receivedUs ڵ steady clock
+            uint64_t budgetMs = m.deadlineMs > m.timestampMs ? m.deadlineMs - m.timestampMs : 0;
+            entry.dueUs = (std::min)(entry.dueUs, m.receivedUs + budgetMs * 1000);
+        }
+        m_heap.push_back(std::move(entry));
+        std::push_heap(m_heap.begin(), m_heap.end(), Later());
+    }
+    else {
+        Flow& flow = FlowLocked(entry.msg.clientId);
+        flow.queue.push_back(std::move(entry));
+
+        // ¼ѯĿͻ˴һݶȣżһĿͻ˲ضһ֣Ƿ
+        if (!flow.active) {
+            flow.active = true;
+            if (flow.deficit >= 0) {
+                flow.deficit = static_cast<int64_t>(flow.quantum);
+            }
+            m_active.push_back(&flow);
+        }
+    }
+
+    if (m_runners < m_maxRunners) {
+        m_runners++;
+        return true;
+    }
+    return false;
+}
+
+bool RequestScheduler::Pop(PipeMessage& msg)
+{
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        bool found = m_config.policy == SchedulePolicy::Deadline ? PopDeadlineLocked(entry) : PopFairLocked(entry);
+        if (!found) {
+            m_runners--;
+            return false;
+        }
+        m_queued--;
+        m_dispatched++;
+    }
+
+    uint64_t now = SteadyNowUs();
+    m_waitUs[static_cast<size_t>(entry.cls)].Record(now > entry.msg.receivedUs ? now - entry.msg.receivedUs : 0);
+    msg = std::move(entry.msg);
+    return true;
+}
+
+bool RequestScheduler::PopFairLocked(Entry& entry)
+{
+    while (!m_active.empty()) {
+        Flow& flow = *m_active.front();
+        if (flow.deficit <= 0) {
+            // ֶ꣬ŵβǷޣѭн
+            flow.deficit += static_cast<int64_t>(flow.quantum);
+            m_active.splice(m_active.end(), m_active, m_active.begin());
+            m_rounds++;
+            continue;
+        }
+
+        entry = std::move(flow.queue.front());
+        flow.queue.pop_front();
+        flow.running++;
+        ChargeLocked(flow, entry.msg.payload.size());
+
+        if (flow.queue.empty()) {
+            m_active.pop_front();
+            flow.active = false;
+            if (flow.deficit > 0) {
+                flow.deficit = 0;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool RequestScheduler::PopDeadlineLocked(Entry& entry)
+{
+    if (m_heap.empty())
+        return false;
+
+    std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+    entry = std::move(m_heap.back());
+    m_heap.pop_back();
+    return true;
+}
+
+void RequestScheduler::Complete(const std::string& clientId, uint64_t handlerUs)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_flows.find(clientId);
+    if (it == m_flows.end())
+        return;
+
+    Flow& flow = it->second;
+    ChargeLocked(flow, handlerUs * m_config.costPerUs);
+    if (flow.running > 0) {
+        flow.running--;
+    }
+    if (!flow.active && flow.running == 0) {
+        m_flows.erase(it);
+    }
+}
+
+SchedulerStats RequestScheduler::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    SchedulerStats stats;
+    stats.queued = m_queued;
+    stats.flows = m_active.size();
+    stats.runners = m_runners;
+    stats.dispatched = m_dispatched;
+    stats.rounds = m_rounds;
+
+    auto& urgent = m_waitUs[static_cast<size_t>(RequestClass::Urgent)];
+    auto& deadline = m_waitUs[static_cast<size_t>(RequestClass::Deadline)];
+    auto& normal = m_waitUs[static_cast<size_t>(RequestClass::Normal)];
+    stats.urgentWaitP50Us = urgent.Percentile(50);
+    stats.urgentWaitP99Us = urgent.Percentile(99);
+    stats.deadlineWaitP50Us = deadline.Percentile(50);
+    stats.deadlineWaitP99Us = deadline.Percentile(99);
+    stats.normalWaitP50Us = normal.Percentile(50);
+    stats.normalWaitP99Us = normal.Percentile(99);
+    return stats;
+}
+
+RequestScheduler::Flow& RequestScheduler::FlowLocked(const std::string& clientId)
+{
+    auto [it, inserted] = m_flows.try_emplace(clientId);
+    Flow& flow = it->second;
+    if (inserted) {
+        uint32_t weight = 1;
+        auto w = m_weights.find(clientId);
+        if (w != m_weights.end()) {
+            weight = w->second;
+        }
+        else if (m_weightFn) {
+            weight = m_weightFn(clientId);
+        }
+        flow.clientId = clientId;
+        flow.quantum = m_config.quantum * (weight ? weight : 1);
+    }
+    return flow;
+}
+
+void RequestScheduler::ChargeLocked(Flow& flow, uint64_t cost)
+{
+    int64_t floor = -static_cast<int64_t>(flow.quantum * m_config.maxDebtRounds);
+    flow.deficit -= static_cast<int64_t>(cost);
+    if (flow.deficit < floor) {
+        flow.deficit = floor;
+    }
+}
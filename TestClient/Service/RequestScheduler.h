@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include "../PipeServer/PipeMessage.h"
+#include "../Common/LatencyHistogram.h"
+
+enum class SchedulePolicy : uint8_t
+{
+    FairShare,                  // ͻ˼ȨѯDRR
+    Deadline,                   // ȫֹʱȣEDFʱϻ
+};
+
+// ȼֻ Deadline Եͷͳ
+enum class RequestClass : uint8_t
+{
+    Urgent,                     // ŷ flags.urgent Ϊ true
+    Deadline,                   //  deadline / timeoutMs
+    Normal,
+    Count,
+};
+
+struct SchedulerConfig
+{
+    SchedulePolicy           policy = SchedulePolicy::FairShare;
+
+    // FairShare
+    uint64_t                 quantum = 4096;            // ÿ֡ÿλȨزĶȣֽڵ
+    uint64_t                 costPerUs = 16;            // ÿ΢ʱۺϵֽ
+    uint32_t                 maxDebtRounds = 8;         // Ƿۼôֹ֣һÿͻ˳ڶ
+
+    // Deadlineû deadline  ʱ + slack Ϊֹʱ
+    uint64_t                 urgentSlackUs = 20'000;
+    uint64_t                 normalSlackUs = 1'000'000; // ͨ౻󵽵ô
+};
+
+struct SchedulerStats
+{
+    uint64_t                 queued = 0;                // ǰŶӵ
+    uint64_t                 flows = 0;                 // ǰŶĿͻˣFairShare
+    uint64_t                 runners = 0;               // ڴִ
+    uint64_t                 dispatched = 0;
+    uint64_t                 rounds = 0;                // ȲFairShare
+
+    // նеȵĵȴʱ䣨΢룩
+    uint64_t                 urgentWaitP50Us = 0;
+    uint64_t                 urgentWaitP99Us = 0;
+    uint64_t                 deadlineWaitP50Us = 0;
+    uint64_t                 deadlineWaitP99Us = 0;
+    uint64_t                 normalWaitP50Us = 0;
+    uint64_t                 normalWaitP99Us = 0;
+};
+
+// ==============================
+// RequestSchedulerִһ
+// FairShareĬϣ
+// - ͻ˷ֶУԼȨѯDRRѡֵĳͻҶΪʱȡһ payload ֽڿ۶
+// - ɺ󰴴ʱٲۣCompleteĿͻȻٷִֵл
+// - ȨأSetWeight  clientId ָ SetWeightFunction簴𣩣ûΪ 1
+// - ͻ˶ûڴʱƳ֮ǰǷ֮
+// Deadline
+// - ͬһСѣֹʱȡģͬһʱ̰˳
+// -  deadline 䱾urgent Ϊ  + urgentSlackΪ  + normalSlack
+// - ֹʱ浽ʱ̶̹ȴԽԽǰͨ󲻻ᱻڶ
+// ֲִޣͨڹ߳ѹǹ̵߳ FIFO 
+// ==============================
+class RequestScheduler
+{
+public:
+    using WeightFunction = std::function<uint32_t(const std::string& clientId)>;
+
+    explicit RequestScheduler(SchedulerConfig config = {});
+
+    // Ӧڷǰ
+    void Configure(SchedulerConfig config);
+    // ֻӰ֮½Ŀͻ˶
+    void SetWeight(const std::string& clientId, uint32_t weight);
+    void SetWeightFunction(WeightFunction fn);
+    void SetMaxRunners(size_t count);
+
+    // ӣ true ʾ÷Ӧһµִ
+    bool Push(PipeMessage msg);
+
+    // ִȡһûпɴʱ falseִ漴˳
+    bool Pop(PipeMessage& msg);
+
+    // һϣhandlerUs Ϊʱ
+    void Complete(const std::string& clientId, uint64_t handlerUs);
+
+    SchedulerStats GetStats() const;
+
+private:
+    struct Entry
+    {
+        PipeMessage              msg;
+        RequestClass             cls = RequestClass::Normal;
+        uint64_t                 dueUs = 0;             // Deadline Եsteady clock
+        uint64_t                 seq = 0;
+    };
+
+    // std::push_heap Ϊ󶥶ѣȽϵõֹʱڶѶ
+    struct Later
+    {
+        bool operator()(const Entry& a, const Entry& b) const
+        {
+            return a.dueUs != b.dueUs ? a.dueUs > b.dueUs : a.seq > b.seq;
+        }
+    };
+
+    struct Flow
+    {
+        std::string              clientId;
+        std::deque<Entry>        queue;
+        int64_t                  deficit = 0;
+        uint64_t                 quantum = 0;           // quantum * Ȩ
+        size_t                   running = 0;
+        bool                     active = false;        // Ƿѯ
+    };
+
+    Flow& FlowLocked(const std::string& clientId);
+    void ChargeLocked(Flow& flow, uint64_t cost);
+    bool PopFairLocked(Entry& entry);
+    bool PopDeadlineLocked(Entry& entry);
+
+private:
+    SchedulerConfig         m_config;
+
+    mutable std::mutex      m_mutex;
+    std::unordered_map<std::string, Flow> m_flows;
+    std::list<Flow*>        m_active;                   // ѯ˳򣬶ΪǰֵĿͻ
+    std::unordered_map<std::string, uint32_t> m_weights;
+    WeightFunction          m_weightFn;
+    std::vector<Entry>      m_heap;                     // Deadline 
+    uint64_t                m_seq = 0;
+
+    size_t                  m_maxRunners = 1;
+    size_t                  m_runners = 0;
+    size_t                  m_queued = 0;
+    uint64_t                m_dispatched = 0;
+    uint64_t                m_rounds = 0;
+
+    std::array<Common::Metrics::LatencyHistogram, static_cast<size_t>(RequestClass::Count)> m_waitUs;
+};
@@ -0,0 +1,150 @@
+#include "ResponseCache.h"
+
+ResponseCache::ResponseCache(size_t maxBytes)
+    : m_maxBytes(maxBytes)
+{
+
+}
+
+void ResponseCache::EnableAction(std::string_view action, std::chrono::milliseconds ttl)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_actions[std::string(action)].ttl = ttl;
+}
+
+void ResponseCache::InvalidateOn(std::string_view writeAction, std::vector<std::string> cachedActions)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& list = m_invalidates[std::string(writeAction)];
+    list.insert(list.end(), cachedActions.begin(), cachedActions.end());
+}
+
+bool ResponseCache::IsCacheable(std::string_view action) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_actions.find(std::string(action)) != m_actions.end();
+}
+
+std::string ResponseCache::MakeKey(std::string_view action, const nlohmann::json& params)
+{
+    std::string key(action);
+    key.push_back('\0');
+    key += params.dump();
+    return key;
+}
+
+std::optional<ResponseTemplate> ResponseCache::Lookup(const std::string& key, std::string_view action,
+    uint64_t& generation)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    auto cfg = m_actions.find(std::string(action));
+    generation = cfg != m_actions.end() ? cfg->second.generation : 0;
+
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        m_stats.misses++;
+        return std::nullopt;
+    }
+
+    Entry& e = *it->second;
+    if (e.generation != generation || std::chrono::steady_clock::now() >= e.expires) {
+        EraseLocked(it->second);
+        m_stats.expirations++;
+        m_stats.misses++;
+        return std::nullopt;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    m_stats.hits++;
+    return e.response;
+}
+
+void ResponseCache::Store(std::string key, std::string_view action, uint64_t generation, ResponseTemplate response)
+{
+    Entry e;
+    e.key = std::move(key);
+    e.action = std::string(action);
+    e.generation = generation;
+    e.response = std::move(response);
+
+    size_t cost = Cost(e);
+    if (cost > m_maxBytes)
+        return;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    auto cfg = m_actions.find(e.action);
+    if (cfg == m_actions.end() || cfg->second.generation != generation)
+        return;     // ڼ䱻дϣѹʱ
+    e.expires = std::chrono::steady_clock::now() + cfg->second.ttl;
+
+    auto old = m_index.find(e.key);
+    if (old != m_index.end()) {
+        EraseLocked(old->second);
+    }
+
+    while (!m_lru.empty() && m_bytes + cost > m_maxBytes) {
+        EraseLocked(std::prev(m_lru.end()));
+        m_stats.evictions++;
+    }
+
+    m_lru.push_front(std::move(e));
+    m_index[m_lru.front().key] = m_lru.begin();
+    m_bytes += cost;
+    m_stats.stores++;
+}
+
+void ResponseCache::OnActionCompleted(std::string_view action)
+{
+    std::vector<std::string> targets;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_invalidates.find(std::string(action));
+        if (it == m_invalidates.end())
+            return;
+        targets = it->second;
+    }
+
+    for (auto& target : targets) {
+        Invalidate(target);
+    }
+}
+
+void ResponseCache::Invalidate(std::string_view action)
+{
+    // ֻĿ´βһ LRU ̭ʱͷ
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_actions.find(std::string(action));
+    if (it != m_actions.end()) {
+        it->second.generation++;
+        m_stats.invalidations++;
+    }
+}
+
+void ResponseCache::Clear()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+    for (auto& kv : m_actions) {
+        kv.second.generation++;
+    }
+}
+
+ResponseCacheStats ResponseCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    ResponseCacheStats stats = m_stats;
+    stats.entries = m_index.size();
+    stats.bytes = m_bytes;
+    return stats;
+}
+
+void ResponseCache::EraseLocked(EntryList::iterator it)
+{
+    m_bytes -= Cost(*it);
+    m_index.erase(it->key);
+    m_lru.erase(it);
+}
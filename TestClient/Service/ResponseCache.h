@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <optional>
+#include <mutex>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include "ResponseTemplate.h"
+
+struct ResponseCacheStats
+{
+    uint64_t                 hits = 0;
+    uint64_t                 misses = 0;
+    uint64_t                 stores = 0;
+    uint64_t                 evictions = 0;             // ڴޱ̭
+    uint64_t                 expirations = 0;           // TTL ڻѱд
+    uint64_t                 invalidations = 0;         // дϴ
+    uint64_t                 entries = 0;
+    uint64_t                 bytes = 0;
+
+    double HitRate() const
+    {
+        uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+};
+
+// ==============================
+// ResponseCacheݵ action Ӧ棨 action ʽ
+// - Ϊ action + 淶 paramsnlohmann::json 󰴼dump Ψһ
+// - ÿ action  TTLд SetConfigɺ InvalidateOn  action
+// - ֽʱ LRU ̭
+// - ĿΪ ResponseTemplateʱɵ÷ǰ msgId Ӧ
+// EnableAction/InvalidateOn Ӧڷǰãӿ̰߳ȫ
+// ==============================
+class ResponseCache
+{
+public:
+    explicit ResponseCache(size_t maxBytes = 16 * 1024 * 1024);
+
+    void EnableAction(std::string_view action, std::chrono::milliseconds ttl);
+    void InvalidateOn(std::string_view writeAction, std::vector<std::string> cachedActions);
+
+    bool IsCacheable(std::string_view action) const;
+    static std::string MakeKey(std::string_view action, const nlohmann::json& params);
+
+    // generation ǰ Store жϴڼǷ
+    std::optional<ResponseTemplate> Lookup(const std::string& key, std::string_view action, uint64_t& generation);
+    void Store(std::string key, std::string_view action, uint64_t generation, ResponseTemplate response);
+
+    //  action ɺãΪдĻ
+    void OnActionCompleted(std::string_view action);
+    void Invalidate(std::string_view action);
+    void Clear();
+
+    ResponseCacheStats GetStats() const;
+
+private:
+    struct ActionConfig
+    {
+        std::chrono::milliseconds ttl{ 0 };
+        uint64_t                generation = 0;         // ÿ +1ɴĿΪʧЧ
+    };
+
+    struct Entry
+    {
+        std::string             key;
+        std::string             action;
+        uint64_t                generation = 0;
+        std::chrono::steady_clock::time_point expires;
+        ResponseTemplate        response;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    static size_t Cost(const Entry& e) { return e.key.size() + e.response.Size() + sizeof(Entry); }
+    void EraseLocked(EntryList::iterator it);
+
+private:
+    size_t                  m_maxBytes;
+
+    mutable std::mutex      m_mutex;
+    std::unordered_map<std::string, ActionConfig> m_actions;
+    std::unordered_map<std::string, std::vector<std::string>> m_invalidates;
+    EntryList               m_lru;                      // ͷΪʹ
+    std::unordered_map<std::string, EntryList::iterator> m_index;
+    size_t                  m_bytes = 0;
+
+    ResponseCacheStats      m_stats;
+};
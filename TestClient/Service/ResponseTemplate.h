@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include "..\PipeServer\BufferPool.h"
+#include "..\PipeServer\FrameCodec.h"
+
+// ==============================
+// ActionResponseصӦ
+// - ֽ飨ԭдʱһν
+// -  JsonFrameWriter::Finish õ֡壬ԭ SendToClientٿ
+// - ĬϹ죨return {}ʾظ
+// ==============================
+class ActionResponse
+{
+public:
+    ActionResponse() = default;
+    ActionResponse(std::vector<uint8_t> bytes) : m_bytes(std::move(bytes)) {}
+    ActionResponse(BufferLease frame) : m_frame(std::move(frame)) {}
+
+    bool Empty() const { return m_frame ? m_frame->Size() == 0 : m_bytes.empty(); }
+
+    // ģ֡ǰ׺ڻ桢ȥؼ¼
+    std::span<const uint8_t> Body() const
+    {
+        if (m_frame)
+            return { m_frame->Data(), m_frame->Size() };
+        return m_bytes;
+    }
+
+    const BufferLease& Frame() const { return m_frame; }
+    const std::vector<uint8_t>& Bytes() const { return m_bytes; }
+
+private:
+    std::vector<uint8_t>    m_bytes;
+    BufferLease             m_frame;
+};
+
+// ==============================
+// ResponseTemplateɸõӦ桢ϲã
+// - Ӧֻһݣɱ䣬
+// - ¼ "msgId":<ֵ> λãͬʱֻ滻һ
+// - Ĳ msgId ʱ Render ֱӷͬһѷ֡壬ٿ
+// ҪӦΪ JSONnlohmann dump / JsonFrameWriter 㣩
+// ==============================
+class ResponseTemplate
+{
+public:
+    ResponseTemplate() = default;
+
+    ResponseTemplate(std::span<const uint8_t> response, const nlohmann::json& msgId)
+        : m_body(std::make_shared<const std::vector<uint8_t>>(response.begin(), response.end()))
+    {
+        if (msgId.is_null())
+            return;
+
+        std::string id = msgId.dump();
+        std::string needle = "\"msgId\":" + id;
+        std::string_view body(reinterpret_cast<const char*>(m_body->data()), m_body->size());
+        size_t pos = body.find(needle);
+        if (pos != std::string_view::npos) {
+            m_idOffset = pos + needle.size() - id.size();
+            m_idLength = id.size();
+        }
+    }
+
+    // JsonFrameWriter дõ֡壬ֻȡ
+    ResponseTemplate(const BufferLease& frame, const nlohmann::json& msgId)
+        : ResponseTemplate(std::span<const uint8_t>(frame->Data(), frame->Size()), msgId)
+    {
+    }
+
+    bool Empty() const { return !m_body || m_body->empty(); }
+    size_t Size() const { return m_body ? m_body->size() : 0; }
+
+    // Ŀ msgId Ӧֽ
+    std::vector<uint8_t> Render(const nlohmann::json& msgId) const
+    {
+        if (m_idLength == 0)
+            return *m_body;
+
+        std::string id = msgId.dump();
+        std::vector<uint8_t> out;
+        out.reserve(m_body->size() - m_idLength + id.size());
+        out.insert(out.end(), m_body->begin(), m_body->begin() + m_idOffset);
+        out.insert(out.end(), id.begin(), id.end());
+        out.insert(out.end(), m_body->begin() + m_idOffset + m_idLength, m_body->end());
+        return out;
+    }
+
+    // ֱѷ֡ĳػ壻shared Ϊ msgId ʱɸõĻ壨״εʱ䣩
+    BufferLease RenderFrame(BufferPool& pool, const nlohmann::json& msgId, BufferLease& shared) const
+    {
+        if (m_idLength == 0)
+            return RenderFrame(pool, std::string_view(), shared);
+
+        std::string id = msgId.dump();
+        return RenderFrame(pool, std::string_view(id), shared);
+    }
+
+    // id Ϊ msgId ԭʼ JSON ı FindEnvelopeField Ľֱƴ
+    BufferLease RenderFrame(BufferPool& pool, std::string_view id, BufferLease& shared) const
+    {
+        if (m_idLength == 0) {
+            if (!shared) {
+                shared = pool.Copy(m_body->data(), m_body->size());
+                SealFrame(*shared, FrameKind::Message);
+            }
+            return shared;
+        }
+
+        size_t tail = m_body->size() - m_idOffset - m_idLength;
+        BufferLease frame = pool.Acquire(m_idOffset + id.size() + tail);
+        uint8_t* p = frame->Data();
+        std::memcpy(p, m_body->data(), m_idOffset);
+        std::memcpy(p + m_idOffset, id.data(), id.size());
+        std::memcpy(p + m_idOffset + id.size(), m_body->data() + m_idOffset + m_idLength, tail);
+        SealFrame(*frame, FrameKind::Message);
+        return frame;
+    }
+
+private:
+    std::shared_ptr<const std::vector<uint8_t>> m_body;
+    size_t                  m_idOffset = 0;
+    size_t                  m_idLength = 0;
+};
@@ -4,8 +4,15 @@
 ServiceManager::ServiceManager(const std::wstring& pipeName, size_t maxInstances, size_t bufferSize)
 	: m_PipeServer(pipeName, maxInstances, bufferSize)
 	, ServiceBase(L"AAAService", L"AAA Service", TRUE, TRUE, FALSE)
+	, m_expiredResponse(MakeErrorResponse({ { "msgId", 0 } }, "DeadlineExceeded", "request expired before dispatch"), 0)
+	, m_busyResponse(MakeErrorResponse({ { "msgId", 0 } }, "Busy", "server overloaded, retry later"), 0)
 {
-
+	for (const char* action : { "State.Subscribe", "State.Unsubscribe", "State.Resync" }) {
+		std::string name = action;
+		RegisterAction(name, [this, name](const PipeMessage& Message, const nlohmann::json& request) {
+			return HandleStateAction(name, Message, request);
+		});
+	}
 }
 
 ServiceManager::~ServiceManager()
@@ -20,22 +27,314 @@ ServiceManager::~ServiceManager()
 
 void ServiceManager::SetRequestHandler(RequestHandler handler)
 {
+	m_handler = std::move(handler);
+}
+
+void ServiceManager::SetAsyncRequestHandler(AsyncRequestHandler handler)
+{
+	m_asyncHandler = std::move(handler);
+}
 
+void ServiceManager::RegisterAction(std::string_view action, ActionHandler handler)
+{
+	m_actions.Register(action, std::move(handler));
 }
 
-std::vector<uint8_t> ServiceManager::RequestHandle(const PipeMessage& Message)
+void ServiceManager::RegisterTypeHandler(MessageType type, ActionHandler handler)
+{
+	if (type != MessageType::Unknown) {
+		m_typeHandlers[static_cast<size_t>(type)] = std::move(handler);
+	}
+}
+
+ActionResponse ServiceManager::RequestHandle(const PipeMessage& Message)
 {
 	if (m_handler) {
 		return m_handler(Message);
 	}
 
-	std::string s(Message.payload.begin(), Message.payload.end());
+	auto request = nlohmann::json::parse(Message.payload.begin(), Message.payload.end(), nullptr, false);
+	if (request.is_discarded() || !request.is_object()) {
+		return MakeErrorResponse(nlohmann::json::object(), "BadRequest", "invalid json");
+	}
+
+	auto typeIt = request.find("type");
+	if (typeIt == request.end() || !typeIt->is_string()) {
+		return MakeErrorResponse(request, "BadRequest", "missing type");
+	}
+
+	MessageType type = ParseMessageType(typeIt->get_ref<const std::string&>());
+	if (type == MessageType::Request) {
+		const std::string* action = nullptr;
+		auto payloadIt = request.find("payload");
+		if (payloadIt != request.end() && payloadIt->is_object()) {
+			auto actionIt = payloadIt->find("action");
+			if (actionIt != payloadIt->end() && actionIt->is_string()) {
+				action = &actionIt->get_ref<const std::string&>();
+			}
+		}
+		if (!action) {
+			return MakeErrorResponse(request, "BadRequest", "missing action");
+		}
+
+		const ActionHandler* handler = m_actions.Find(*action);
+		if (!handler) {
+			return MakeErrorResponse(request, "UnknownAction", *action);
+		}
+
+		// طͬ clientId + msgIdִУطӦ
+		auto msgIdIt = request.find("msgId");
+		bool deferred = false;
+		if (msgIdIt == request.end()) {
+			return HandleAction(*handler, *action, Message, request, deferred);
+		}
+
+		std::string msgId = msgIdIt->dump();
+		std::vector<uint8_t> replay;
+		switch (m_dedup.Check(Message.clientId, msgId, replay)) {
+		case DedupWindow::Verdict::Replay:
+			return replay;
+		case DedupWindow::Verdict::Pending:
+			return {};
+		default:
+			break;
+		}
+
+		ActionResponse response;
+		try {
+			response = HandleAction(*handler, *action, Message, request, deferred);
+		}
+		catch (...) {
+			m_dedup.Abandon(Message.clientId, msgId);
+			throw;
+		}
+		// ϲ; leader ַʱɣûӦ綩ʧܣʱƳ
+		if (deferred)
+			return response;
+		if (response.Empty()) {
+			m_dedup.Abandon(Message.clientId, msgId);
+		}
+		else {
+			m_dedup.Complete(Message.clientId, msgId, response.Body());
+		}
+		return response;
+	}
+
+	if (type != MessageType::Unknown && m_typeHandlers[static_cast<size_t>(type)]) {
+		return m_typeHandlers[static_cast<size_t>(type)](Message, request);
+	}
+	return {};
+}
+
+ActionResponse ServiceManager::HandleAction(const ActionHandler& handler, const std::string& action,
+	const PipeMessage& Message, const nlohmann::json& request, bool& deferred)
+{
+	deferred = false;
+	bool cacheable = m_cache.IsCacheable(action);
+	bool coalesce = m_singleFlight.IsEnabled(action);
+	if (!cacheable && !coalesce) {
+		ActionResponse response = handler(Message, request);
+		m_cache.OnActionCompleted(action);
+		return response;
+	}
+
+	static const nlohmann::json NULL_JSON;
+	const nlohmann::json& payload = request["payload"];
+	auto paramsIt = payload.find("params");
+	const nlohmann::json& params = paramsIt != payload.end() ? *paramsIt : NULL_JSON;
+	auto msgIdIt = request.find("msgId");
+	const nlohmann::json& msgId = msgIdIt != request.end() ? *msgIdIt : NULL_JSON;
 
-	auto ReceiveJaon = nlohmann::json::parse(s);
+	std::string key = ResponseCache::MakeKey(action, params);
+	uint64_t generation = 0;
+	if (cacheable) {
+		if (auto hit = m_cache.Lookup(key, action, generation)) {
+			BufferLease frame;
+			return hit->RenderFrame(*m_PipeServer.Pool(), msgId, frame);
+		}
+	}
+
+	// ִͬУֻǼǣ leader ַ
+	if (coalesce && !m_singleFlight.Join(key, { Message.clientId, msgId })) {
+		deferred = true;
+		return {};
+	}
+
+	ActionResponse response;
+	try {
+		response = handler(Message, request);
+	}
+	catch (...) {
+		if (!coalesce)
+			throw;
+		response = MakeErrorResponse(request, "InternalError", "handler failed");
+	}
+	m_cache.OnActionCompleted(action);
+
+	ResponseTemplate shared(response.Body(), msgId);
+
+	// Ӧ
+	if (cacheable && !response.Empty() && !IsErrorEnvelope(response.Body())) {
+		m_cache.Store(key, action, generation, shared);
+	}
+
+	// ַϲĹֻ滻Ե msgIdͬʱɸԵȥĿطʱط
+	if (coalesce) {
+		BufferLease frame;
+		for (auto& waiter : m_singleFlight.Complete(key)) {
+			std::string waiterId = waiter.msgId.dump();
+			if (shared.Empty()) {
+				m_dedup.Abandon(waiter.clientId, waiterId);
+				continue;
+			}
+			m_dedup.Complete(waiter.clientId, waiterId, shared.Render(waiter.msgId));
+			m_PipeServer.SendToClient(waiter.clientId, shared.RenderFrame(*m_PipeServer.Pool(), waiter.msgId, frame));
+		}
+	}
+	return response;
+}
+
+ServiceStats ServiceManager::GetStats() const
+{
+	ServiceStats stats;
+	stats.pipe = m_PipeServer.GetStats();
+	stats.cache = m_cache.GetStats();
+	stats.singleFlight = m_singleFlight.GetStats();
+	stats.dedup = m_dedup.GetStats();
+	stats.states = m_states.GetStats();
+	stats.shed = m_shedder.GetStats();
+	stats.scheduler = m_scheduler.GetStats();
+	stats.expired = m_expired.load(std::memory_order_relaxed);
+	return stats;
+}
+
+ActionResponse ServiceManager::HandleStateAction(const std::string& action, const PipeMessage& Message,
+	const nlohmann::json& request)
+{
+	const nlohmann::json& payload = request["payload"];
+	auto paramsIt = payload.find("params");
+	if (paramsIt == payload.end() || !paramsIt->is_object()
+		|| !paramsIt->contains("topic") || !(*paramsIt)["topic"].is_string()) {
+		return MakeErrorResponse(request, "BadRequest", "missing topic");
+	}
+	const std::string& topic = (*paramsIt)["topic"].get_ref<const std::string&>();
+
+	// ڱӦӣͻյӦʱѳ seq Ӧ״̬
+	if (action == "State.Unsubscribe") {
+		m_states.Unsubscribe(Message.clientId, topic);
+	}
+	else if (!m_states.Subscribe(Message.clientId, topic)) {
+		return {};
+	}
+
+	JsonFrameWriter w(m_PipeServer.Pool(), 256);
+	w.BeginObject().Field("ver", "1.0").Field("type", "Response");
+	WriteMsgId(w, request);
+	w.Key("payload").BeginObject()
+		.Field("topic", topic)
+		.Field("seq", m_states.Seq(topic))
+		.EndObject();
+	return w.EndObject().Finish();
+}
+
+BufferLease ServiceManager::MakeErrorResponse(const nlohmann::json& request,
+	std::string_view code, std::string_view message) const
+{
+	JsonFrameWriter w(m_PipeServer.Pool(), 256);
+	w.BeginObject().Field("ver", "1.0").Field("type", "Error");
+	WriteMsgId(w, request);
+	w.Key("error").BeginObject()
+		.Field("code", code)
+		.Field("message", message)
+		.EndObject();
+	return w.EndObject().Finish();
+}
+
+//  msgId ʱԭдأ JSON ֵոʽResponseTemplate ˶λ
+void ServiceManager::WriteMsgId(JsonFrameWriter& w, const nlohmann::json& request)
+{
+	if (!request.is_object())
+		return;
+	auto it = request.find("msgId");
+	if (it != request.end()) {
+		w.Key("msgId").Raw(it->dump());
+	}
+}
+
+// ֡ԭֽ PipeServer 
+void ServiceManager::SendResponse(const std::string& clientId, ActionResponse response)
+{
+	if (response.Empty())
+		return;
+	if (response.Frame()) {
+		m_PipeServer.SendToClient(clientId, response.Frame());
+	}
+	else {
+		m_PipeServer.SendToClient(clientId, response.Bytes());
+	}
+}
+
+// 󲻽ִ
+bool ServiceManager::DropIfExpired(const PipeMessage& msg)
+{
+	if (!DeadlineExceeded(msg))
+		return false;
+
+	m_expired.fetch_add(1, std::memory_order_relaxed);
+	ReplyFast(msg, m_expiredResponse);
+	return true;
+}
+
+// ʼǰ׼飺ȿ deadlineٰŶʱӾǷ Busy ܾ
+bool ServiceManager::Admit(const PipeMessage& msg)
+{
+	if (DropIfExpired(msg))
+		return false;
+	if (!m_shedder.Enabled())
+		return true;
+
+	uint64_t now = SteadyNowUs();
+	uint64_t sojourn = now > msg.receivedUs ? now - msg.receivedUs : 0;
+	if (!m_shedder.OnDequeue(sojourn, now, IsSheddable(msg)))
+		return true;
+
+	ReplyFast(msg, m_busyResponse);
+	return false;
+}
+
+// ŷ type  flags.urgent жϣ payload
+bool ServiceManager::IsSheddable(const PipeMessage& msg) const
+{
+	MessageType type = MessageType::Unknown;
+	bool urgent = false;
+	ForEachEnvelopeField(AsText(msg.payload), [&](std::string_view name, std::string_view raw) {
+		if (name == "type" && raw.size() >= 2) {
+			type = ParseMessageType(raw.substr(1, raw.size() - 2));
+		}
+		else if (name == "flags") {
+			std::string_view value;
+			urgent = FindEnvelopeField(raw, "urgent", value) && value == "true";
+		}
+		return true;
+		});
+	return !urgent && m_shedder.IsSheddableType(type);
+}
+
+// ԤɵĴӦֻƴ msgIdû msgId ʱ޴ӹظ
+void ServiceManager::ReplyFast(const PipeMessage& msg, const ResponseTemplate& response)
+{
+	std::string_view msgId;
+	if (FindEnvelopeField(AsText(msg.payload), "msgId", msgId)) {
+		BufferLease frame;
+		m_PipeServer.SendToClient(msg.clientId, response.RenderFrame(*m_PipeServer.Pool(), msgId, frame));
+	}
 }
 
 void ServiceManager::OnStart(DWORD argc, LPWSTR* argv)
 {
+	m_scheduler.SetMaxRunners(m_workers.ThreadCount());
+	m_workers.Start();
+	m_cpuPool.Start();
 	m_PipeServer.Start();
 	m_running = true;
 	m_worker = std::thread(&ServiceManager::WorkerLoop, this);
@@ -49,6 +348,11 @@ void ServiceManager::OnStop()
 	{
 		m_worker.join();
 	}
+
+	// ȻѵȴͻӦЭ̣̳ͣ߳أδڵ SleepFor  false أ
+	CancelPendingRequests();
+	m_workers.Stop();
+	m_cpuPool.Stop();
 }
 
 void ServiceManager::OnPause()
@@ -81,10 +385,145 @@ void ServiceManager::WorkerLoop()
 			break;
 		}
 
-		std::vector<uint8_t> response = RequestHandle(msg);
+		// ѹʱŶѳʱͱռù߳
+		msg.deadlineMs = ReadDeadline(msg.payload, msg.timestampMs);
+		if (DropIfExpired(msg))
+		{
+			continue;
+		}
+
+		// ˷ Request ӦȴеЭ
+		if (TryCompleteRequest(msg))
+		{
+			continue;
+		}
+
+		if (m_asyncHandler)
+		{
+			RunAsyncHandler(std::move(msg));
+			continue;
+		}
+
+		// 崦ԭĴ壻ַڹ߳ϲִУͬܺϲ
+		if (m_handler)
+		{
+			if (!Admit(msg))
+			{
+				continue;
+			}
+			SendResponse(msg.clientId, RequestHandle(msg));
+			continue;
+		}
+
+		if (m_scheduler.Push(std::move(msg)))
+		{
+			m_workers.Post([this]() { RunScheduled(); });
+		}
+	}
+}
+
+// ִߣÿδӵȡһ֮ͶԼЭָ̻񲻱صȻѹſ
+void ServiceManager::RunScheduled()
+{
+	PipeMessage msg;
+	while (m_scheduler.Pop(msg))
+	{
+		uint64_t start = SteadyNowUs();
+		try {
+			// ѹҪڵУﰴŶʱж
+			if (Admit(msg))
+			{
+				SendResponse(msg.clientId, RequestHandle(msg));
+			}
+		}
+		catch (...) {}
+		m_scheduler.Complete(msg.clientId, SteadyNowUs() - start);
+
+		// ֹ̳ͣ߳ڵֱִ߳ PostΪ͵ѭݹ
+		if (m_running.load())
+		{
+			m_workers.Post([this]() { RunScheduled(); });
+			return;
+		}
+	}
+}
+
+DetachedTask ServiceManager::RunAsyncHandler(PipeMessage msg)
+{
+	// ֻ߳ڹִ߳
+	co_await SwitchTo(m_workers);
+	if (!Admit(msg))
+		co_return;
+
+	try {
+		std::string clientId = msg.clientId;
+		std::vector<uint8_t> response = co_await m_asyncHandler(std::move(msg));
 		if (!response.empty())
 		{
-			m_PipeServer.SendToClient(msg.clientId, response);
+			m_PipeServer.SendToClient(clientId, response);
 		}
 	}
+	catch (...) {}
+}
+
+bool ServiceManager::TryCompleteRequest(const PipeMessage& msg)
+{
+	{
+		std::lock_guard<std::mutex> lk(m_pendingMutex);
+		if (m_pending.empty())
+			return false;
+	}
+
+	// ֶͲʱͨ󽻸 json 쳣Ϲ߳
+	auto json = nlohmann::json::parse(msg.payload.begin(), msg.payload.end(), nullptr, false);
+	if (json.is_discarded() || !json.is_object())
+		return false;
+
+	auto typeIt = json.find("type");
+	auto msgIdIt = json.find("msgId");
+	if (typeIt == json.end() || !typeIt->is_string() || typeIt->get_ref<const std::string&>() != "Response"
+		|| msgIdIt == json.end() || !msgIdIt->is_string())
+		return false;
+
+	std::string msgId = msgIdIt->get<std::string>();
+	{
+		std::lock_guard<std::mutex> lk(m_pendingMutex);
+		if (m_pending.find(msgId) == m_pending.end())
+			return false;
+	}
+
+	CompleteRequest(msgId, std::move(json));
+	return true;
+}
+
+void ServiceManager::CompleteRequest(const std::string& msgId, std::optional<nlohmann::json> response)
+{
+	std::shared_ptr<PendingRequest> pending;
+	{
+		std::lock_guard<std::mutex> lk(m_pendingMutex);
+		auto it = m_pending.find(msgId);
+		if (it == m_pending.end())
+			return;
+		pending = it->second;
+		m_pending.erase(it);
+	}
+
+	if (!pending->Claim())
+		return;
+
+	pending->response = std::move(response);
+	m_workers.Post(pending->waiter);
+}
+
+void ServiceManager::CancelPendingRequests()
+{
+	std::vector<std::string> ids;
+	{
+		std::lock_guard<std::mutex> lk(m_pendingMutex);
+		for (auto& kv : m_pending)
+			ids.push_back(kv.first);
+	}
+
+	for (auto& id : ids)
+		CompleteRequest(id, std::nullopt);
 }
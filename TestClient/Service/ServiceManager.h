@@ -1,20 +1,59 @@
 #pragma once
 #include "..\Service\ServiceBase.h"
 #include "..\PipeServer\PipeServer.h"
+#include "..\PipeServer\JsonFrameWriter.h"
+#include "WorkerPool.h"
+#include "AsyncTask.h"
+#include "MessageDispatch.h"
+#include "ResponseCache.h"
+#include "SingleFlight.h"
+#include "DedupWindow.h"
+#include "StatePublisher.h"
+#include "Envelope.h"
+#include "LoadShedder.h"
+#include "RequestScheduler.h"
+#include <nlohmann/json.hpp>
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <optional>
+#include <unordered_map>
+#include <array>
+
+// ͳ
+struct ServiceStats
+{
+    PipeServerStats          pipe;
+    ResponseCacheStats       cache;
+    SingleFlightStats        singleFlight;
+    DedupStats               dedup;
+    StatePublisherStats      states;
+    LoadShedStats            shed;
+    SchedulerStats           scheduler;
+    uint64_t                 expired = 0;               // ʱѹ deadlineδִе
+};
 
 // ==============================
 // ServiceManagerҵ
 // - ʱʼ PipeServer
 // - ڲ߳ WaitAndPopReceived Ϣ
 // - ɺʹ SendToClient ظ
+// - δ崦ʱ type / payload.action ַ MessageDispatch.h m_workers ϲִУ
+//   ִ˳ RequestScheduler ͻ˹ƽѯֹʱȣͬʱ߳
+// - Э̴ʱÿϢһЭ̣/ָ m_workers 
+// - ŷ deadline / timeoutMs ʱ Envelope.hӺͿʼִǰһΣڵֱӻ DeadlineExceeded
+//    DeadlineExceeded(Message) ǰ
+// -  Shedder Ŷʱӳʱ CoDel  Busy ֵܾȼ󣨼 LoadShedder.h
 // ==============================
 class ServiceManager : public ServiceBase
 {
 public:
     using RequestHandler = std::function<std::vector<uint8_t>(const PipeMessage&)>;
+    // Э̴Ϣֵ룬صӦǿʱظͷ
+    using AsyncRequestHandler = std::function<Task<std::vector<uint8_t>>(PipeMessage)>;
+    // ַrequest ΪѽϢؿձʾظ
+    // ɷֽ飬 JsonFrameWriter ֱдõ֡壨ʱٿ
+    using ActionHandler = std::function<ActionResponse(const PipeMessage&, const nlohmann::json& request)>;
 
     explicit ServiceManager(const std::wstring& pipeName,
         size_t maxInstances = 20,
@@ -25,8 +64,36 @@ public:
 
 public:
     void SetRequestHandler(RequestHandler handler);
+    void SetAsyncRequestHandler(AsyncRequestHandler handler);
+
+    // ַ OnStart ֮ǰע
+    void RegisterAction(std::string_view action, ActionHandler handler);
+    void RegisterTypeHandler(MessageType type, ActionHandler handler);
+
+    // Ӧ棨Ĭϲκ action Cache().EnableAction ʽ
+    ResponseCache& Cache() { return m_cache; }
+    // ϲͬʱ;ͬ SingleFlights().Enable ʽ
+    SingleFlight& SingleFlights() { return m_singleFlight; }
+    // 汾ŵ״̬ͣͻͨ State.Subscribe / State.Unsubscribe / State.Resync 
+    StatePublisher& States() { return m_states; }
+    // رĬϹرգ Shedder().Configure ʽ
+    LoadShedder& Shedder() { return m_shedder; }
+    // ͻ֮ĹƽȣȨ OnStart ֮ǰ
+    RequestScheduler& Scheduler() { return m_scheduler; }
+    ServiceStats GetStats() const;
     PipeServer& Server() { return m_PipeServer; }
-    std::vector<uint8_t> RequestHandle(const PipeMessage& Message);
+    WorkerPool& Workers() { return m_workers; }
+    ActionResponse RequestHandle(const PipeMessage& Message);
+
+    // Э̴пɵȴĲ
+    // - RequestClientͻ˷ Requestȴ msgId ͬ Responseʱ/Ͽ/ֹͣ nullopt
+    // - SleepForʱֹͣʱǰ false
+    // - Offloadڼִ̳߳ fnص߳
+    auto RequestClient(const std::string& clientId, const std::string& action,
+        nlohmann::json params, std::chrono::milliseconds timeout = std::chrono::seconds(10));
+    auto SleepFor(std::chrono::milliseconds delay) { return ::SleepFor(m_workers, delay); }
+    template <typename F>
+    auto Offload(F fn) { return ::Offload(m_cpuPool, m_workers, std::move(fn)); }
 
 public:
 	void OnStart(DWORD argc, LPWSTR* argv) override;
@@ -37,7 +104,36 @@ public:
 	void OnError(const std::wstring& function, DWORD error) override;
 
 private:
+    // ȴͻӦЭ̣Ӧʱֹͣ˭ Claim ˭ָ
+    struct PendingRequest
+    {
+        std::coroutine_handle<>          waiter;
+        std::optional<nlohmann::json>    response;
+        std::atomic<bool>                claimed{ false };
+
+        bool Claim() { return !claimed.exchange(true); }
+    };
+
     void WorkerLoop();
+    // deferredѺϲ;ͬӦȥĿ leader 
+    ActionResponse HandleAction(const ActionHandler& handler, const std::string& action,
+        const PipeMessage& Message, const nlohmann::json& request, bool& deferred);
+    ActionResponse HandleStateAction(const std::string& action, const PipeMessage& Message,
+        const nlohmann::json& request);
+    // Ӧ JsonFrameWriter ֱдػ֡
+    BufferLease MakeErrorResponse(const nlohmann::json& request,
+        std::string_view code, std::string_view message) const;
+    static void WriteMsgId(JsonFrameWriter& w, const nlohmann::json& request);
+    void SendResponse(const std::string& clientId, ActionResponse response);
+    bool DropIfExpired(const PipeMessage& msg);
+    bool Admit(const PipeMessage& msg);
+    bool IsSheddable(const PipeMessage& msg) const;
+    void ReplyFast(const PipeMessage& msg, const ResponseTemplate& response);
+    DetachedTask RunAsyncHandler(PipeMessage msg);
+    void RunScheduled();
+    bool TryCompleteRequest(const PipeMessage& msg);
+    void CompleteRequest(const std::string& msgId, std::optional<nlohmann::json> response);
+    void CancelPendingRequests();
 
 private:
     PipeServer            m_PipeServer;
@@ -45,4 +141,83 @@ private:
     std::thread           m_worker;
 
     RequestHandler        m_handler;
+    AsyncRequestHandler   m_asyncHandler;
+    ActionTable<ActionHandler> m_actions;
+    ResponseCache         m_cache;
+    SingleFlight          m_singleFlight;
+    DedupWindow           m_dedup;                      //  msgId ط Request
+    StatePublisher        m_states{ m_PipeServer.Pool(),
+        [this](const std::string& clientId, const BufferLease& frame) { return m_PipeServer.SendToClient(clientId, frame); } };
+    std::array<ActionHandler, MESSAGE_TYPE_COUNT> m_typeHandlers;
+    LoadShedder           m_shedder;
+    RequestScheduler      m_scheduler;
+    ResponseTemplate      m_expiredResponse;            // Ԥɵ DeadlineExceeded / Busyֻ滻 msgId
+    ResponseTemplate      m_busyResponse;
+    std::atomic<uint64_t> m_expired{ 0 };
+
+    WorkerPool            m_workers;                    // Эָ̻
+    WorkerPool            m_cpuPool;                    // Offload 
+
+    std::mutex            m_pendingMutex;
+    std::unordered_map<std::string, std::shared_ptr<PendingRequest>> m_pending;
+    std::atomic<uint64_t> m_nextRequestId{ 1 };
 };
+
+inline auto ServiceManager::RequestClient(const std::string& clientId, const std::string& action,
+    nlohmann::json params, std::chrono::milliseconds timeout)
+{
+    struct Awaiter
+    {
+        ServiceManager&                  self;
+        std::string                      clientId;
+        std::string                      action;
+        nlohmann::json                   params;
+        std::chrono::milliseconds        timeout;
+        std::shared_ptr<PendingRequest>  pending = std::make_shared<PendingRequest>();
+
+        bool await_ready() noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            // ʱӦڱǰͻָЭֻ̣֮ʹþֲ
+            ServiceManager& mgr = self;
+            std::shared_ptr<PendingRequest> p = pending;
+            std::string msgId = "srv-" + std::to_string(mgr.m_nextRequestId.fetch_add(1));
+
+            // ŷֱд֡壬ʱٿ
+            JsonFrameWriter writer(mgr.m_PipeServer.Pool());
+            writer.BeginObject()
+                .Field("ver", "1.0")
+                .Field("type", "Request")
+                .Field("msgId", msgId)
+                .Field("clientId", clientId)
+                .Key("payload").BeginObject()
+                    .Field("action", action)
+                    .Key("params").Raw(params.dump())
+                .EndObject()
+                .EndObject();
+            BufferLease frame = writer.Finish();
+            std::string target = clientId;
+
+            p->waiter = h;
+            {
+                std::lock_guard<std::mutex> lk(mgr.m_pendingMutex);
+                mgr.m_pending[msgId] = p;
+            }
+
+            mgr.m_workers.PostAfter(timeout, [&mgr, msgId](bool) {
+                mgr.CompleteRequest(msgId, std::nullopt);
+                });
+
+            if (!mgr.m_PipeServer.SendToClient(target, std::move(frame)) && p->Claim()) {
+                std::lock_guard<std::mutex> lk(mgr.m_pendingMutex);
+                mgr.m_pending.erase(msgId);
+                return false;
+            }
+            return true;
+        }
+
+        std::optional<nlohmann::json> await_resume() { return std::move(pending->response); }
+    };
+    return Awaiter{ *this, clientId, action, std::move(params), timeout };
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+struct SingleFlightStats
+{
+    uint64_t                 leaders = 0;               // ʵִдĴ
+    uint64_t                 coalesced = 0;             // ϲδظִе
+    uint64_t                 inFlight = 0;
+};
+
+// ==============================
+// SingleFlightϲͬʱ;ͬ󣨰 action ʽ
+// -  ResponseCache ͬaction + 淶 params
+// - һΪ leader ִдִڼ䵽ֻͬǼǣռ߳
+// - leader ɺ Complete ȡеȴߣɵ÷ͬһӦַ
+//  TTL ޹أֻϲʱصɺ
+// ==============================
+class SingleFlight
+{
+public:
+    struct Waiter
+    {
+        std::string             clientId;
+        nlohmann::json          msgId;
+    };
+
+    // Ӧڷǰ
+    void Enable(std::string_view action)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_enabled.insert(std::string(action));
+    }
+
+    bool IsEnabled(std::string_view action) const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        return m_enabled.find(std::string(action)) != m_enabled.end();
+    }
+
+    //  true ʾ÷ leaderִдɺ Complete
+    bool Join(const std::string& key, Waiter waiter)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_flights.find(key);
+        if (it == m_flights.end()) {
+            m_flights.emplace(key, std::vector<Waiter>());
+            m_stats.leaders++;
+            return true;
+        }
+        it->second.push_back(std::move(waiter));
+        m_stats.coalesced++;
+        return false;
+    }
+
+    std::vector<Waiter> Complete(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        auto it = m_flights.find(key);
+        if (it == m_flights.end())
+            return {};
+        std::vector<Waiter> waiters = std::move(it->second);
+        m_flights.erase(it);
+        return waiters;
+    }
+
+    SingleFlightStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        SingleFlightStats stats = m_stats;
+        stats.inFlight = m_flights.size();
+        return stats;
+    }
+
+private:
+    mutable std::mutex      m_mutex;
+    std::unordered_set<std::string> m_enabled;
+    std::unordered_map<std::string, std::vector<Waiter>> m_flights;
+    SingleFlightStats       m_stats;
+};
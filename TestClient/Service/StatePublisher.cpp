@@ -0,0 +1,132 @@
+#include "StatePublisher.h"
+#include "../PipeServer/FrameCodec.h"
+
+StatePublisher::StatePublisher(std::shared_ptr<BufferPool> pool, SendFunction send)
+    : m_pool(std::move(pool))
+    , m_send(std::move(send))
+{
+
+}
+
+uint64_t StatePublisher::Publish(const std::string& topic, nlohmann::json state)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Topic& t = m_topics[topic];
+
+    nlohmann::json patch = nlohmann::json::diff(t.state, state);
+    if (patch.empty())
+        return t.seq;
+
+    uint64_t baseSeq = t.seq;
+    t.state = std::move(state);
+    t.seq++;
+    m_stats.updates++;
+
+    if (t.subscribers.empty())
+        return t.seq;
+
+    nlohmann::json message = {
+        { "type", "Notify" },
+        { "payload", {
+            { "topic", topic },
+            { "kind", "patch" },
+            { "baseSeq", baseSeq },
+            { "seq", t.seq },
+            { "patch", std::move(patch) },
+        } },
+    };
+    BufferLease frame = Encode(message);
+
+    // ԿղС滻ʱ
+    bool usePatch = frame->Size() * 2 <= t.snapshotSize;
+    if (!usePatch) {
+        frame = EncodeSnapshot(topic, t);
+    }
+
+    // ж߹ͬһѷ֡
+    for (auto it = t.subscribers.begin(); it != t.subscribers.end();) {
+        if (!SendLocked(*it, frame)) {
+            it = t.subscribers.erase(it);       // ͻѶϿ
+            continue;
+        }
+        m_stats.bytesFull += t.snapshotSize;
+        (usePatch ? m_stats.patches : m_stats.snapshots)++;
+        ++it;
+    }
+    return t.seq;
+}
+
+bool StatePublisher::Subscribe(const std::string& clientId, const std::string& topic)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Topic& t = m_topics[topic];
+    t.subscribers.insert(clientId);
+
+    BufferLease frame = EncodeSnapshot(topic, t);
+    if (!SendLocked(clientId, frame)) {
+        t.subscribers.erase(clientId);
+        return false;
+    }
+    m_stats.bytesFull += frame->Size();
+    m_stats.snapshots++;
+    return true;
+}
+
+void StatePublisher::Unsubscribe(const std::string& clientId, const std::string& topic)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_topics.find(topic);
+    if (it != m_topics.end()) {
+        it->second.subscribers.erase(clientId);
+    }
+}
+
+bool StatePublisher::Resync(const std::string& clientId, const std::string& topic)
+{
+    return Subscribe(clientId, topic);
+}
+
+uint64_t StatePublisher::Seq(const std::string& topic) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_topics.find(topic);
+    return it != m_topics.end() ? it->second.seq : 0;
+}
+
+StatePublisherStats StatePublisher::GetStats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_stats;
+}
+
+BufferLease StatePublisher::EncodeSnapshot(const std::string& topic, Topic& t)
+{
+    nlohmann::json message = {
+        { "type", "Notify" },
+        { "payload", {
+            { "topic", topic },
+            { "kind", "snapshot" },
+            { "seq", t.seq },
+            { "state", t.state },
+        } },
+    };
+    BufferLease frame = Encode(message);
+    t.snapshotSize = frame->Size();
+    return frame;
+}
+
+BufferLease StatePublisher::Encode(const nlohmann::json& message)
+{
+    std::string text = message.dump();
+    BufferLease frame = m_pool->Copy(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    SealFrame(*frame, FrameKind::Message);
+    return frame;
+}
+
+bool StatePublisher::SendLocked(const std::string& clientId, const BufferLease& frame)
+{
+    if (!m_send(clientId, frame))
+        return false;
+    m_stats.bytesSent += frame->Size();
+    return true;
+}
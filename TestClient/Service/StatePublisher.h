@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include "../PipeServer/BufferPool.h"
+
+struct StatePublisherStats
+{
+    uint64_t                 updates = 0;               // ʵʷ仯 Publish 
+    uint64_t                 patches = 0;               //  JSON Patch 
+    uint64_t                 snapshots = 0;             // /ͬ/ʱ͵ȫ
+    uint64_t                 bytesSent = 0;             // ʵʷ͵ֽڣۼƣ
+    uint64_t                 bytesFull = 0;             // ÿζȫҪֽڣʱһοմС㣩
+
+    double SavedRatio() const
+    {
+        return bytesFull ? 1.0 - static_cast<double>(bytesSent) / static_cast<double>(bytesFull) : 0.0;
+    }
+};
+
+// ==============================
+// StatePublisher汾ŵ״̬
+// - ʱȫգ֮ÿα仯ֻ RFC 6902 JSON Patchnlohmann json::diff
+// - ÿ topic ά seqЯ baseSeqͻ˷ baseSeq 뱾زΪʧ
+//   Ӧ Request{action:"State.Resync", params:{topic}} »ȡ
+// - һοմСһʱķգСʱлȫ
+// - ֻ뷢ͺͨ PipeServer::Pool  PipeServer::SendToClientʧΪͻѶϿ
+// Ϣʽ
+//   {"type":"Notify","payload":{"topic":t,"kind":"snapshot","seq":n,"state":{...}}}
+//   {"type":"Notify","payload":{"topic":t,"kind":"patch","baseSeq":n-1,"seq":n,"patch":[...]}}
+// ==============================
+class StatePublisher
+{
+public:
+    //  clientId ѷ֡Ļ壬ͻ˲ɴʱ false
+    using SendFunction = std::function<bool(const std::string& clientId, const BufferLease& frame)>;
+
+    StatePublisher(std::shared_ptr<BufferPool> pool, SendFunction send);
+
+    // ״̬жͲ죻µ seqޱ仯ʱԭ seq
+    uint64_t Publish(const std::string& topic, nlohmann::json state);
+
+    // Ĳյգظĵͬͬ
+    bool Subscribe(const std::string& clientId, const std::string& topic);
+    void Unsubscribe(const std::string& clientId, const std::string& topic);
+    bool Resync(const std::string& clientId, const std::string& topic);
+
+    uint64_t Seq(const std::string& topic) const;
+    StatePublisherStats GetStats() const;
+
+private:
+    struct Topic
+    {
+        nlohmann::json          state = nlohmann::json::object();
+        uint64_t                seq = 0;
+        size_t                  snapshotSize = 0;       // һαĿֽ
+        std::unordered_set<std::string> subscribers;
+    };
+
+    BufferLease EncodeSnapshot(const std::string& topic, Topic& t);
+    BufferLease Encode(const nlohmann::json& message);
+    bool SendLocked(const std::string& clientId, const BufferLease& frame);
+
+private:
+    std::shared_ptr<BufferPool> m_pool;
+    SendFunction            m_send;
+
+    mutable std::mutex      m_mutex;                    // Ҳڣ֤ͬһ topic Ŀ벹 seq ˳
+    std::unordered_map<std::string, Topic> m_topics;
+
+    StatePublisherStats     m_stats;
+};
@@ -0,0 +1,141 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t threadCount)
+    : m_threadCount(threadCount ? threadCount : (std::max)(2u, std::thread::hardware_concurrency()))
+{
+
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+void WorkerPool::Start()
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_running)
+        return;
+    m_running = true;
+
+    for (size_t i = 0; i < m_threadCount; ++i) {
+        m_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+    m_timerThread = std::thread(&WorkerPool::TimerLoop, this);
+}
+
+void WorkerPool::Stop()
+{
+    std::vector<Timer> pending;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+
+        while (!m_timers.empty()) {
+            pending.push_back(m_timers.top());
+            m_timers.pop();
+        }
+        // δڵĶʱ false صõȴеЭ̵Խ
+        for (auto& timer : pending) {
+            m_tasks.push([cb = std::move(timer.callback)]() { cb(false); });
+        }
+    }
+
+    m_timerCv.notify_all();
+    m_cv.notify_all();
+
+    if (m_timerThread.joinable()) {
+        m_timerThread.join();
+    }
+    for (auto& t : m_threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    m_threads.clear();
+}
+
+void WorkerPool::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_running) {
+            m_tasks.push(std::move(task));
+            m_cv.notify_one();
+            return;
+        }
+    }
+    task();
+}
+
+void WorkerPool::Post(std::coroutine_handle<> handle)
+{
+    Post(Task([handle]() { handle.resume(); }));
+}
+
+void WorkerPool::PostAfter(std::chrono::milliseconds delay, TimerCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_running) {
+            Timer timer;
+            timer.due = std::chrono::steady_clock::now() + delay;
+            timer.seq = m_timerSeq++;
+            timer.callback = std::move(callback);
+            m_timers.push(std::move(timer));
+            m_timerCv.notify_one();
+            return;
+        }
+    }
+    callback(false);
+}
+
+void WorkerPool::WorkerLoop()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_cv.wait(lk, [&] { return !m_tasks.empty() || !m_running; });
+
+            // ֹͣ԰Ѷִ꣬ͶݵЭ̶ᱻָ
+            if (m_tasks.empty())
+                break;
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        try {
+            task();
+        }
+        catch (...) {
+        }
+    }
+}
+
+void WorkerPool::TimerLoop()
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (m_running)
+    {
+        if (m_timers.empty()) {
+            m_timerCv.wait(lk);
+            continue;
+        }
+
+        auto due = m_timers.top().due;
+        if (std::chrono::steady_clock::now() < due) {
+            m_timerCv.wait_until(lk, due);
+            continue;
+        }
+
+        Timer timer = m_timers.top();
+        m_timers.pop();
+        m_tasks.push([cb = std::move(timer.callback)]() { cb(true); });
+        m_cv.notify_one();
+    }
+}
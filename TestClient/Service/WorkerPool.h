@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <coroutine>
+
+// ==============================
+// WorkerPool̶߳ + ʱ
+// - Post  FIFO ڹִ߳УЭ̾ҲΪͶݣڳϻָ
+// - PostAfter ںѻصͶݵ̣߳ true ʾ
+// - Stop ʱδڵĶʱ false صеִ߳˳
+// - δֹͣʱ Post ڵֱִ߳У֤Э̲
+// ==============================
+class WorkerPool
+{
+public:
+    using Task = std::function<void()>;
+    using TimerCallback = std::function<void(bool expired)>;
+
+    explicit WorkerPool(size_t threadCount = 0);    // 0 ʾ CPU 
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Start();
+    void Stop();
+
+    void Post(Task task);
+    void Post(std::coroutine_handle<> handle);
+    void PostAfter(std::chrono::milliseconds delay, TimerCallback callback);
+
+    size_t ThreadCount() const { return m_threadCount; }
+
+private:
+    void WorkerLoop();
+    void TimerLoop();
+
+private:
+    struct Timer
+    {
+        std::chrono::steady_clock::time_point due;
+        uint64_t                seq = 0;
+        TimerCallback           callback;
+
+        // СѣȵڵڶѶͬһʱ̰ύ˳
+        bool operator>(const Timer& other) const
+        {
+            return due != other.due ? due > other.due : seq > other.seq;
+        }
+    };
+
+    size_t                  m_threadCount;
+    bool                    m_running = false;          //  m_mutex 
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::queue<Task>        m_tasks;
+    std::vector<std::thread> m_threads;
+
+    std::condition_variable m_timerCv;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+    uint64_t                m_timerSeq = 0;
+    std::thread             m_timerThread;
+};
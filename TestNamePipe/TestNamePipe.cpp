@@ -1,7 +1,7 @@
 
 // main.cpp - ܵ JSON ЭԿͻˣWindows
 // Visual Studio / MSVC̨Ӧã/std:c++17
-// ÷PipeClient.exe \\.\pipe\MyPipe
+// ÷PipeClient.exe \\.\pipe\MyPipe [uploadFile]
 // ĬϹܵΪ \\.\pipe\PipeSrv
 
 #include <windows.h>
@@ -14,6 +14,12 @@
 #include <chrono>
 #include <iomanip>
 #include <cstring>
+#include <cstdlib>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <fstream>
 
 static uint64_t NowMs() {
     FILETIME ft;
@@ -32,22 +38,53 @@ static void Log(const std::string& s) {
     std::cout << s << std::endl;
 }
 
-// =============== ֡д4ֽС˳ǰ׺ + payload =================
-
-bool WriteFrame(HANDLE hPipe, const std::string& payload) {
+// =============== ֡д4ֽСǰ׺24λ + 8λ֡ͣ =================
+// ֡ FrameCodec.h һ£ 0 Ϊͨ JSON Ϣ
+enum FrameKind : uint8_t {
+    FRAME_MESSAGE       = 0,
+    FRAME_STREAM_OPEN   = 1,   // [u32 streamId][u64 totalSize][meta...]
+    FRAME_STREAM_DATA   = 2,   // [u32 streamId][data...]
+    FRAME_STREAM_END    = 3,   // [u32 streamId][u32 status]
+    FRAME_STREAM_CREDIT = 4,   // [u32 streamId][u32 bytes]
+    FRAME_STREAM_RESET  = 5,   // [u32 streamId][u32 reason]
+    FRAME_FRAGMENT      = 6,   // [u32 streamId][u8 flags][data...]flags&1 ΪһƬ
+    FRAME_SESSION       = 7,   // [u64 token][u64 received]   󶨻·
+    FRAME_RESUME        = 8,   // [u64 token][u64 received][u64 resendFrom]
+    FRAME_ACK           = 9,   // [u64 received]
+    FRAME_CREDIT        = 10,  // [u32 messages][u32 bytes]  ׷ӷ˵ķͶȣ״ηͼ
+    FRAME_BATCH         = 11,  // [frame][frame]...  Ϣ֡ǰ׺Hello  supportsBatch ˲Żᷢ
+    FRAME_COMPRESSED    = 12,  // [u32 originalSize][XPRESS_HUFF data]  Hello ЭѹŻ֣ͻ˲Э̣
+};
+
+const uint32_t FRAME_LENGTH_MASK = 0x00FFFFFF;
+const uint32_t STREAM_WINDOW     = 256 * 1024;   // ʼڣһ£
+const uint32_t STREAM_CHUNK_SIZE = 64 * 1024;
+const uint64_t ACK_INTERVAL      = 32;           // ÿյôϢȷһΣ˾ݴ˲üطŻ
+const uint32_t CREDIT_MESSAGES   = 64;           // ˵Ϣ
+const uint32_t CREDIT_BYTES      = 256 * 1024;   // ˵ֽڴڣ֡ƣǰ׺
+const uint32_t MAX_FRAME_SIZE    = 1024 * 1024;  // ˿ɽյĵ֡ޣHello 
+const uint32_t HEARTBEAT_MS      = 10000;        // ϣ Welcome зȷϵΪ׼
+const uint64_t WELCOME_TIMEOUT_MS = 5000;
+const uint64_t REQUEST_TIMEOUT_MS = 5000;        // ŷ timeoutMsŶӳʱֱӻ DeadlineExceeded
+
+// ̹߳黹ȡ߳ܲд贮л
+static std::mutex g_writeMutex;
+
+bool WriteFrame(HANDLE hPipe, const std::string& payload, uint8_t kind = FRAME_MESSAGE) {
     if (hPipe == INVALID_HANDLE_VALUE) return false;
     uint32_t len = static_cast<uint32_t>(payload.size());
+    uint32_t header = (static_cast<uint32_t>(kind) << 24) | (len & FRAME_LENGTH_MASK);
     std::vector<uint8_t> buf(4 + len);
     // Сֱд뼴ɣ memcpy
-    std::memcpy(buf.data(), &len, sizeof(uint32_t));
+    std::memcpy(buf.data(), &header, sizeof(uint32_t));
     if (len > 0) {
         std::memcpy(buf.data() + 4, payload.data(), len);
     }
+    std::lock_guard<std::mutex> lk(g_writeMutex);
     DWORD written = 0;
     BOOL ok = WriteFile(hPipe, buf.data(), (DWORD)buf.size(), &written, NULL);
-	DWORD err = GetLastError();
     if (!ok || written != buf.size()) {
-        Log("WriteFrame failed");
+        Log("WriteFrame failed, err=" + std::to_string(GetLastError()));
         return false;
     }
     return true;
@@ -78,13 +115,17 @@ bool ReadExact(HANDLE hPipe, void* out, DWORD need) {
     return true;
 }
 
-bool ReadFrame(HANDLE hPipe, std::string& outPayload) {
+bool ReadFrame(HANDLE hPipe, std::string& outPayload, uint8_t* outKind = nullptr) {
     outPayload.clear();
-    uint32_t len = 0;
-    if (!ReadExact(hPipe, &len, sizeof(uint32_t))) {
+    uint32_t header = 0;
+    if (!ReadExact(hPipe, &header, sizeof(uint32_t))) {
         return false;
     }
-    // ȫޣһ»С
+    uint32_t len = header & FRAME_LENGTH_MASK;
+    if (outKind) {
+        *outKind = static_cast<uint8_t>(header >> 24);
+    }
+    // ȫޣһ»С߷ֿ
     const uint32_t MAX_FRAME = 10 * 1024 * 1024; // 10MB
     if (len > MAX_FRAME) {
         Log("Frame too large, len=" + std::to_string(len));
@@ -103,6 +144,245 @@ bool ReadFrame(HANDLE hPipe, std::string& outPayload) {
     return true;
 }
 
+// =============== ֿοʵ֣ =================
+
+static void PutU32(std::string& s, uint32_t v) { s.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+static void PutU64(std::string& s, uint64_t v) { s.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+static uint32_t GetU32(const std::string& s, size_t off) {
+    uint32_t v = 0;
+    if (s.size() >= off + sizeof(v)) std::memcpy(&v, s.data() + off, sizeof(v));
+    return v;
+}
+static uint64_t GetU64(const std::string& s, size_t off) {
+    uint64_t v = 0;
+    if (s.size() >= off + sizeof(v)) std::memcpy(&v, s.data() + off, sizeof(v));
+    return v;
+}
+
+static bool WriteStreamControl(HANDLE hPipe, uint8_t kind, uint32_t streamId, uint32_t value) {
+    std::string body;
+    PutU32(body, streamId);
+    PutU32(body, value);
+    return WriteFrame(hPipe, body, kind);
+}
+
+static bool WriteCredit(HANDLE hPipe, uint32_t messages, uint32_t bytes) {
+    std::string body;
+    PutU32(body, messages);
+    PutU32(body, bytes);
+    return WriteFrame(hPipe, body, FRAME_CREDIT);
+}
+
+// Batch ֡ fn
+template <typename F>
+static size_t UnpackBatch(const std::string& payload, F&& fn) {
+    size_t off = 0;
+    size_t count = 0;
+    while (off < payload.size()) {
+        uint32_t header = GetU32(payload, off);
+        uint32_t len = header & FRAME_LENGTH_MASK;
+        if (payload.size() - off < 4 || (header >> 24) != FRAME_MESSAGE || len > payload.size() - off - 4) {
+            Log("Malformed Batch frame.");
+            break;
+        }
+        fn(payload.substr(off + 4, len));
+        off += 4 + len;
+        ++count;
+    }
+    return count;
+}
+
+// Ϣ֡ƬĶȣ̷߳ʣ곬ں黹˲ȴȶͣ
+// Ƭ黹ֽڣֽڴڵϢԶղ
+struct CreditWindow {
+    uint32_t messages = 0;
+    uint32_t bytes = 0;
+
+    void Consume(HANDLE hPipe, uint32_t msgs, size_t frameBytes) {
+        messages += msgs;
+        bytes += static_cast<uint32_t>(frameBytes);
+        if (messages >= CREDIT_MESSAGES / 2 || bytes >= CREDIT_BYTES / 2) {
+            WriteCredit(hPipe, messages, bytes);
+            messages = 0;
+            bytes = 0;
+        }
+    }
+};
+
+// ֽ߳յ Welcome 룬̵߳ȵſʼҵϢ
+struct WelcomeState {
+    std::mutex              m;
+    std::condition_variable cv;
+    bool                    received = false;
+    std::string             clientId;
+    std::string             resumeToken;
+    std::string             batch;
+    uint32_t                heartbeatMs = HEARTBEAT_MS;
+};
+
+// ȡ JSON  "key": ֵַ֮ȥţֻ Welcome ƽֶΣ
+static std::string FindJsonValue(const std::string& json, const std::string& key) {
+    size_t pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return {};
+    pos = json.find(':', pos + key.size() + 2);
+    if (pos == std::string::npos) return {};
+    pos = json.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos) return {};
+    if (json[pos] == '"') {
+        size_t end = json.find('"', pos + 1);
+        return end == std::string::npos ? std::string() : json.substr(pos + 1, end - pos - 1);
+    }
+    size_t end = json.find_first_of(",}] \t\r\n", pos);
+    return json.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+// շÿ̵ stream_<id>.binڴֻռһݿ
+struct InboundStream {
+    std::ofstream file;
+    uint64_t      received = 0;
+    uint32_t      unacked = 0;
+};
+static std::map<uint32_t, InboundStream> g_inStreams; // ̷߳
+
+// ͷ򣺶ɶ߳յ StreamCredit 󲹳
+struct UploadState {
+    std::mutex              m;
+    std::condition_variable cv;
+    uint64_t                credit = STREAM_WINDOW;
+    bool                    reset = false;
+};
+static std::mutex g_uploadsMutex;
+static std::map<uint32_t, std::shared_ptr<UploadState>> g_uploads;
+
+// ϢƬ߼飬ͨϢ
+static std::map<uint32_t, std::string> g_fragments; // ̷߳
+
+static bool ReassembleFragment(const std::string& payload, std::string& outMessage) {
+    if (payload.size() < 5) return false;
+    uint32_t streamId = GetU32(payload, 0);
+    bool last = (static_cast<uint8_t>(payload[4]) & 0x01) != 0;
+    std::string& buf = g_fragments[streamId];
+    buf.append(payload, 5, std::string::npos);
+    if (!last) return false;
+    outMessage.swap(buf);
+    g_fragments.erase(streamId);
+    return true;
+}
+
+// ̵߳ãص֡
+static void HandleStreamFrame(HANDLE hPipe, uint8_t kind, const std::string& payload) {
+    uint32_t streamId = GetU32(payload, 0);
+    switch (kind) {
+    case FRAME_STREAM_OPEN: {
+        std::string meta = payload.size() > 12 ? payload.substr(12) : std::string();
+        InboundStream& st = g_inStreams[streamId];
+        st.file.open("stream_" + std::to_string(streamId) + ".bin", std::ios::binary);
+        Log("<< StreamOpen id=" + std::to_string(streamId) + " meta=" + meta);
+        break;
+    }
+    case FRAME_STREAM_DATA: {
+        auto it = g_inStreams.find(streamId);
+        if (it == g_inStreams.end() || payload.size() < 4) break;
+        size_t n = payload.size() - 4;
+        it->second.file.write(payload.data() + 4, static_cast<std::streamsize>(n));
+        it->second.received += n;
+        it->second.unacked += static_cast<uint32_t>(n);
+        // д̺黹ȣܹٷ
+        if (it->second.unacked >= STREAM_WINDOW / 2) {
+            WriteStreamControl(hPipe, FRAME_STREAM_CREDIT, streamId, it->second.unacked);
+            it->second.unacked = 0;
+        }
+        break;
+    }
+    case FRAME_STREAM_END: {
+        auto it = g_inStreams.find(streamId);
+        if (it == g_inStreams.end()) break;
+        Log("<< StreamEnd id=" + std::to_string(streamId) + " status=" + std::to_string(GetU32(payload, 4))
+            + " bytes=" + std::to_string(it->second.received));
+        g_inStreams.erase(it);
+        break;
+    }
+    case FRAME_STREAM_CREDIT:
+    case FRAME_STREAM_RESET: {
+        std::shared_ptr<UploadState> up;
+        {
+            std::lock_guard<std::mutex> lk(g_uploadsMutex);
+            auto it = g_uploads.find(streamId);
+            if (it == g_uploads.end()) break;
+            up = it->second;
+        }
+        {
+            std::lock_guard<std::mutex> lk(up->m);
+            if (kind == FRAME_STREAM_CREDIT) up->credit += GetU32(payload, 4);
+            else up->reset = true;
+        }
+        up->cv.notify_one();
+        break;
+    }
+    default:
+        Log("Unknown frame kind " + std::to_string(kind));
+        break;
+    }
+}
+
+static std::string Escape(const std::string& s);
+
+// Էֿϴļļڴ棬Ȳʱȴ
+static bool UploadFile(HANDLE hPipe, uint32_t streamId, const std::string& path, std::atomic<bool>& running) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        Log("Cannot open upload file: " + path);
+        return false;
+    }
+    in.seekg(0, std::ios::end);
+    uint64_t total = static_cast<uint64_t>(in.tellg());
+    in.seekg(0, std::ios::beg);
+
+    auto up = std::make_shared<UploadState>();
+    {
+        std::lock_guard<std::mutex> lk(g_uploadsMutex);
+        g_uploads[streamId] = up;
+    }
+
+    std::string open;
+    PutU32(open, streamId);
+    PutU64(open, total);
+    open += R"({"name":")" + Escape(path) + R"("})";
+    bool ok = WriteFrame(hPipe, open, FRAME_STREAM_OPEN);
+
+    std::string chunk;
+    while (ok && running.load()) {
+        uint64_t allowed = 0;
+        {
+            std::unique_lock<std::mutex> lk(up->m);
+            up->cv.wait(lk, [&] { return up->credit > 0 || up->reset || !running.load(); });
+            if (up->reset || !running.load()) { ok = false; break; }
+            allowed = (std::min<uint64_t>)(up->credit, STREAM_CHUNK_SIZE);
+        }
+
+        chunk.assign(4 + static_cast<size_t>(allowed), '\0');
+        std::memcpy(&chunk[0], &streamId, sizeof(streamId));
+        in.read(&chunk[4], static_cast<std::streamsize>(allowed));
+        size_t n = static_cast<size_t>(in.gcount());
+        if (n == 0) break;
+        chunk.resize(4 + n);
+
+        {
+            std::lock_guard<std::mutex> lk(up->m);
+            up->credit -= n;
+        }
+        ok = WriteFrame(hPipe, chunk, FRAME_STREAM_DATA);
+    }
+
+    WriteStreamControl(hPipe, FRAME_STREAM_END, streamId, ok ? 0 : 1);
+    {
+        std::lock_guard<std::mutex> lk(g_uploadsMutex);
+        g_uploads.erase(streamId);
+    }
+    Log(std::string("Upload ") + (ok ? "completed: " : "aborted: ") + path);
+    return ok;
+}
+
 // ===============  UUIDʾã֤Ψһԣ =================
 static std::string MakeMsgId(const char* prefix) {
     std::ostringstream oss;
@@ -139,8 +419,11 @@ static std::string MakeHelloJson(const std::string& clientIdHint) {
         << R"("pid":)" << GetCurrentProcessId() << R"(,)"
         << R"("machine":{)"
         << R"("host":"N/A","os":"Windows","user":"N/A","locale":"zh-CN"},)"
-        << R"("capabilities":{"canReceiveNotify":true,"supportsCompression":false,"supportsAuth":true}"
-        })"
+        << R"("capabilities":{"canReceiveNotify":true,"supportsAuth":true,)"
+        << R"("maxFrameSize":)" << MAX_FRAME_SIZE << R"(,)"
+        << R"("encodings":["json"],"compression":["none"],"supportsBatch":true,)"
+        << R"("heartbeatMs":)" << HEARTBEAT_MS << R"(})"
+        << "}"
         << "}";
     return oss.str();
 }
@@ -171,6 +454,8 @@ static std::string MakeRequestJson(const std::string& clientId,
     oss << R"({"ver":"1.0","type":"Request",)"
         << R"("msgId":")" << Escape(MakeMsgId("uuid-req")) << R"(",)"
         << R"("clientId":")" << Escape(clientId) << R"(",)"
+        << R"("timestamp":)" << NowMs() << R"(,)"
+        << R"("timeoutMs":)" << REQUEST_TIMEOUT_MS << R"(,)"
         << R"("payload":{"action":")" << Escape(action) << R"(","params":)" << paramsJson << "}}";
     return oss.str();
 }
@@ -235,16 +520,8 @@ int main(int argc, char* argv[]) {
         Log("SetNamedPipeHandleState failed");
     }
 
-    // 1) ֡ı ClientIdԴ Bind
+    // 1) ֡ Hello洿ı ClientIdЭӲ Welcome
     std::string clientId = "CLI-Console-001";
-    Log("Sending plain ClientId to bind: " + clientId);
-    if (!WriteFrame(hPipe, clientId)) {
-        Log("Failed to send plain ClientId frame.");
-        CloseHandle(hPipe);
-        return 1;
-    }
-
-    // 2)  Hello JSON
     std::string hello = MakeHelloJson(clientId);
     Log("Sending Hello JSON:\n" + hello);
     if (!WriteFrame(hPipe, hello)) {
@@ -253,33 +530,113 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    //  -> ͻ˵أֻڶ̴ͣ߳ٹ黹
+    if (!WriteCredit(hPipe, CREDIT_MESSAGES, CREDIT_BYTES)) {
+        Log("Failed to send Credit.");
+        CloseHandle(hPipe);
+        return 1;
+    }
+
     std::atomic<bool> running{ true };
+    WelcomeState welcome;
 
     // ȡ̣߳ӡ˷ص֡
     std::thread reader([&] {
+        uint64_t received = 0;
+        CreditWindow credit;
+        // һϢϢ֡ɵķƬ Batch еһ
+        // Hello δ resumeWelcome · resumeToken˲ỰҲȷ
+        auto onMessage = [&](const std::string& payload) {
+            if (!welcome.resumeToken.empty() && ++received % ACK_INTERVAL == 0) {
+                std::string ack;
+                PutU64(ack, received);
+                WriteFrame(hPipe, ack, FRAME_ACK);
+            }
+            Log("<< Received payload (" + std::to_string(payload.size()) + " bytes):");
+            std::cout << payload << std::endl;
+            PrintHex(payload);
+        };
         while (running.load()) {
             std::string payload;
-            if (!ReadFrame(hPipe, payload)) {
+            uint8_t kind = FRAME_MESSAGE;
+            if (!ReadFrame(hPipe, payload, &kind)) {
                 Log("ReadFrame failed or pipe closed.");
                 break;
             }
-            Log("<< Received payload (" + std::to_string(payload.size()) + " bytes):");
-            std::cout << payload << std::endl;
-            PrintHex(payload);
+            if (kind == FRAME_FRAGMENT) {
+                std::string whole;
+                bool complete = ReassembleFragment(payload, whole);
+                if (complete) onMessage(whole);
+                credit.Consume(hPipe, complete ? 1 : 0, 4 + payload.size());
+                continue;
+            }
+            else if (kind == FRAME_BATCH) {
+                size_t count = UnpackBatch(payload, onMessage);
+                credit.Consume(hPipe, static_cast<uint32_t>(count), 4 + payload.size());
+                continue;
+            }
+            else if (kind == FRAME_SESSION) {
+                if (payload.size() >= 16) {
+                    Log("<< Session token=" + std::to_string(GetU64(payload, 0)));
+                }
+                continue;
+            }
+            else if (kind == FRAME_ACK) {
+                continue;       // ͻ˲ط账
+            }
+            else if (kind != FRAME_MESSAGE) {
+                HandleStreamFrame(hPipe, kind, payload);
+                continue;
+            }
+            // Welcome Ӧ𣬲Ϣ
+            if (!welcome.received && FindJsonValue(payload, "type") == "Welcome") {
+                Log("<< Welcome:\n" + payload);
+                std::lock_guard<std::mutex> lk(welcome.m);
+                welcome.clientId = FindJsonValue(payload, "clientId");
+                welcome.resumeToken = FindJsonValue(payload, "resumeToken");
+                welcome.batch = FindJsonValue(payload, "batch");
+                uint32_t heartbeatMs = static_cast<uint32_t>(std::strtoul(FindJsonValue(payload, "heartbeatMs").c_str(), nullptr, 10));
+                if (heartbeatMs) welcome.heartbeatMs = heartbeatMs;
+                welcome.received = true;
+                welcome.cv.notify_all();
+                continue;
+            }
+            onMessage(payload);
+            credit.Consume(hPipe, 1, 4 + payload.size());
         }
         running = false;
+        welcome.cv.notify_all();
+        std::lock_guard<std::mutex> lk(g_uploadsMutex);
+        for (auto& kv : g_uploads) kv.second->cv.notify_all();
         });
 
+    // 2) ȴ Welcome֮Э̽շ
+    {
+        std::unique_lock<std::mutex> lk(welcome.m);
+        welcome.cv.wait_for(lk, std::chrono::milliseconds(WELCOME_TIMEOUT_MS),
+            [&] { return welcome.received || !running.load(); });
+        if (!welcome.received) {
+            lk.unlock();
+            Log("No Welcome from server, giving up.");
+            running = false;
+            CloseHandle(hPipe);
+            if (reader.joinable()) reader.join();
+            return 1;
+        }
+        Log("Handshake done: clientId=" + welcome.clientId + ", resumeToken=" + welcome.resumeToken
+            + ", batch=" + welcome.batch + ", heartbeatMs=" + std::to_string(welcome.heartbeatMs));
+    }
+
     // 3) ѡ AuthķҪ
     std::string auth = MakeAuthJson(clientId, "dummy-token-123");
     Log("Sending Auth JSON:\n" + auth);
     WriteFrame(hPipe, auth);
 
-    // 4) ̣߳ÿ 10 룩
+    // 4) ̣߳ Welcome ȷϵļ 3 ղݻϿ
     std::thread heartbeater([&] {
         int64_t seq = 1;
         while (running.load()) {
-            std::this_thread::sleep_for(std::chrono::seconds(10));
+            std::this_thread::sleep_for(std::chrono::milliseconds(welcome.heartbeatMs));
             if (!running.load()) break;
             std::string hb = MakeHeartbeatJson(clientId, seq++);
             Log("Sending Heartbeat:\n" + hb);
@@ -296,6 +653,11 @@ int main(int argc, char* argv[]) {
     Log("Sending Request:\n" + req);
     WriteFrame(hPipe, req);
 
+    // 5.1) ѡԷֿϴļ 10MB ֡ƣ
+    if (argc >= 3) {
+        UploadFile(hPipe, 1, argv[2], running);
+    }
+
     // һʱԹ۲콻
     std::this_thread::sleep_for(std::chrono::seconds(25));
 
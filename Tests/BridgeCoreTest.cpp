@@ -0,0 +1,354 @@
+// BridgeCoreٴ + ¼ UI ̺߳ʱļ UI Ͷ
+// - ǰ -> ֡Ϊ Resume(0)ǰ֡ UTF-8 Ϣ֡
+// -  -> ǰˣϢתͶݣUI ֻ߳ DeliverǷ UTF-8 
+// - Resume δȷϵϢ֡޵Ϣ·Ƭǰδ֡Ļ帴
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../WebViewHost/Bridge/BridgeCore.h"
+#include "TestCheck.h"
+
+// ڴеĴ䣺дֽȫ¼ȡɲι룻Break ģܵϿ´ζʧܡ´д·֡
+class FakeTransport : public IBridgeTransport
+{
+public:
+    void SetGreeting(Greeting greeting) override { m_greeting = std::move(greeting); }
+
+    bool Write(const uint8_t* data, size_t size) override
+    {
+        std::vector<uint8_t> frames;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelled)
+                return false;
+            if (m_greeted) {
+                m_written.insert(m_written.end(), data, data + size);
+                return true;
+            }
+            m_greeted = true;
+        }
+        m_greeting(frames);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written.insert(m_written.end(), frames.begin(), frames.end());
+        m_written.insert(m_written.end(), data, data + size);
+        return true;
+    }
+
+    bool Read(uint8_t* target, size_t capacity, size_t& bytesRead) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return !m_inbound.empty() || m_broken || m_cancelled; });
+        bytesRead = 0;
+        if (m_cancelled)
+            return false;
+        if (m_broken) {
+            m_broken = false;
+            m_inbound.clear();
+            return false;
+        }
+        bytesRead = (std::min)(capacity, m_inbound.size());
+        std::copy_n(m_inbound.begin(), bytesRead, target);
+        m_inbound.erase(m_inbound.begin(), m_inbound.begin() + bytesRead);
+        return true;
+    }
+
+    void Disconnect() override { Break(); }
+
+    void Cancel() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        m_cv.notify_all();
+    }
+
+    void Feed(const std::vector<uint8_t>& bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inbound.insert(m_inbound.end(), bytes.begin(), bytes.end());
+        m_cv.notify_all();
+    }
+
+    void Break()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_broken = true;
+        m_greeted = false;
+        m_cv.notify_all();
+    }
+
+    std::vector<uint8_t> TakeWritten()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<uint8_t> out;
+        out.swap(m_written);
+        return out;
+    }
+
+    size_t WrittenSize()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written.size();
+    }
+
+private:
+    Greeting                m_greeting;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::vector<uint8_t>    m_written;
+    std::deque<uint8_t>     m_inbound;
+    bool                    m_greeted = false;
+    bool                    m_broken = false;
+    bool                    m_cancelled = false;
+};
+
+//  UIPost ֻӣɵ"UI ߳" Deliver¼ÿϢ UI ߳ϵĺʱ
+class RecordingUiSink : public IUiSink
+{
+public:
+    bool Post(BridgeMessage* msg) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_posted.push_back(msg);
+        m_cv.notify_all();
+        return true;
+    }
+
+    void Run(BridgeCore& core)
+    {
+        m_ui = std::thread([this, &core] {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_cv.wait(lock, [&] { return !m_posted.empty() || m_stopped; });
+                if (m_posted.empty())
+                    break;
+                BridgeMessage* msg = m_posted.front();
+                m_posted.pop_front();
+                lock.unlock();
+
+                std::u16string text;
+                auto start = std::chrono::steady_clock::now();
+                core.Deliver(msg, [&](const char16_t* p, size_t n) { text.assign(p, n); });
+                auto elapsed = std::chrono::steady_clock::now() - start;
+
+                lock.lock();
+                m_texts.push_back(std::move(text));
+                m_uiNs.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+            });
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+            m_cv.notify_all();
+        }
+        if (m_ui.joinable())
+            m_ui.join();
+    }
+
+    // Ͷƴһ𣨺ʽӰԣ
+    std::u16string Delivered()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::u16string all;
+        for (const std::u16string& text : m_texts)
+            all += text;
+        return all;
+    }
+
+    std::vector<uint64_t> UiNs()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_uiNs;
+    }
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::deque<BridgeMessage*> m_posted;
+    std::vector<std::u16string> m_texts;
+    std::vector<uint64_t>   m_uiNs;
+    bool                    m_stopped = false;
+    std::thread             m_ui;
+};
+
+struct WrittenFrame
+{
+    FrameKind               kind = FrameKind::Message;
+    std::string             data;
+};
+
+// ֡дֽڣƬ ID Ϊһ MessageδдķƬʱ false
+static bool ParseFrames(const std::vector<uint8_t>& bytes, std::vector<WrittenFrame>& frames)
+{
+    frames.clear();
+    std::map<uint32_t, std::string> partial;
+    size_t pos = 0;
+    while (pos + FRAME_HEADER_SIZE <= bytes.size()) {
+        uint32_t header = ReadU32(bytes.data() + pos);
+        size_t length = HeaderLength(header);
+        CHECK(pos + FRAME_HEADER_SIZE + length <= bytes.size());
+        const char* data = reinterpret_cast<const char*>(bytes.data() + pos + FRAME_HEADER_SIZE);
+        pos += FRAME_HEADER_SIZE + length;
+
+        if (HeaderKind(header) != FrameKind::Fragment) {
+            frames.push_back({ HeaderKind(header), std::string(data, length) });
+            continue;
+        }
+        CHECK(length >= FRAGMENT_HEADER_SIZE);
+        uint32_t streamId = ReadU32(reinterpret_cast<const uint8_t*>(data));
+        bool last = (data[sizeof(uint32_t)] & FRAGMENT_FLAG_LAST) != 0;
+        partial[streamId].append(data + FRAGMENT_HEADER_SIZE, length - FRAGMENT_HEADER_SIZE);
+        if (last) {
+            frames.push_back({ FrameKind::Message, std::move(partial[streamId]) });
+            partial.erase(streamId);
+        }
+    }
+    CHECK(pos == bytes.size());
+    return partial.empty();
+}
+
+static std::vector<uint8_t> MessageFrame(const std::string& text)
+{
+    std::vector<uint8_t> frame;
+    EncodeFrame(frame, FrameKind::Message, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    return frame;
+}
+
+static std::vector<WrittenFrame> WaitFrames(FakeTransport& transport, size_t count)
+{
+    std::vector<uint8_t> bytes;
+    std::vector<WrittenFrame> frames;
+    CHECK(WaitUntil([&] {
+        std::vector<uint8_t> more = transport.TakeWritten();
+        bytes.insert(bytes.end(), more.begin(), more.end());
+        return ParseFrames(bytes, frames) && frames.size() >= count;
+    }));
+    return frames;
+}
+
+static const std::string REQUEST_UTF8 = "{\"type\":\"Request\",\"text\":\"\xe4\xbd\xa0\xe5\xa5\xbd\"}";
+
+static const uint8_t* Bytes(const WrittenFrame& frame)
+{
+    return reinterpret_cast<const uint8_t*>(frame.data.data());
+}
+
+// շͶݡỰʧ°󶨣UI ֻ߳ Deliver¼ÿϢĺʱ
+static void TestRoundTrip()
+{
+    FakeTransport transport;
+    RecordingUiSink sink;
+    BridgeCore core(transport, sink);
+    sink.Run(core);
+    core.Start();
+
+    // ǰ -> Resume(0) ѡ֡תϢ"" Ϊ 3 ֽ UTF-8 ַ
+    static const char16_t BIND[] = u"CLI-Bridge";
+    static const char16_t REQUEST[] = u"{\"type\":\"Request\",\"text\":\"\u4f60\u597d\"}";
+    int released = 0;
+    auto release = [](void* context) { ++*static_cast<int*>(context); };
+    core.Submit(BIND, std::char_traits<char16_t>::length(BIND), release, &released);
+    core.Submit(REQUEST, std::char_traits<char16_t>::length(REQUEST), release, &released);
+
+    std::vector<WrittenFrame> frames = WaitFrames(transport, 3);
+    CHECK(frames.size() == 3);
+    CHECK(frames[0].kind == FrameKind::Resume && frames[0].data.size() == 3 * sizeof(uint64_t));
+    CHECK(ReadU64(Bytes(frames[0])) == 0);
+    CHECK(frames[1].kind == FrameKind::Message && frames[1].data == "CLI-Bridge");
+    CHECK(frames[2].kind == FrameKind::Message && frames[2].data == REQUEST_UTF8);
+    CHECK(WaitUntil([&] { return released == 2; }));
+
+    //  -> ǰˣỰƣϢһǷ UTF-8
+    std::vector<uint8_t> inbound;
+    EncodeSession(inbound, 7, 0);
+    for (const std::string& text : { std::string("{\"type\":\"Notify\",\"seq\":1}"), std::string("{\"type\":\"Notify\",\"seq\":2}"),
+        std::string("\xff\xfe"), std::string("{\"type\":\"Response\",\"text\":\"\xe4\xbd\xa0\xe5\xa5\xbd\"}") }) {
+        std::vector<uint8_t> frame = MessageFrame(text);
+        inbound.insert(inbound.end(), frame.begin(), frame.end());
+    }
+    transport.Feed(inbound);
+
+    CHECK(WaitUntil([&] { return sink.Delivered().find(u"\"Response\"") != std::u16string::npos; }));
+    std::u16string delivered = sink.Delivered();
+    CHECK(delivered.find(u"{\"type\":\"Notify\",\"seq\":1}") != std::u16string::npos);
+    CHECK(delivered.find(u"{\"type\":\"Notify\",\"seq\":2}") != std::u16string::npos);
+    CHECK(delivered.find(u"{\"type\":\"Response\",\"text\":\"\u4f60\u597d\"}") != std::u16string::npos);
+    CHECK(core.GetStats().invalidText == 1);
+    CHECK(core.GetStats().inbound == 3);
+
+    // ߣ֡ Resume(7)طδȷϵϢ
+    transport.Break();
+    frames = WaitFrames(transport, 2);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].kind == FrameKind::Resume);
+    CHECK(ReadU64(Bytes(frames[0])) == 7);
+    CHECK(ReadU64(Bytes(frames[0]) + sizeof(uint64_t)) == 4);      // յķϢķǷϢ
+    CHECK(ReadU64(Bytes(frames[0]) + 2 * sizeof(uint64_t)) == 1);
+    CHECK(frames[1].data == REQUEST_UTF8);
+    CHECK(core.GetStats().resumes == 1);
+
+    // ܣ֪ͨǰ Session.Lost Resume(0) + ֡°
+    inbound.clear();
+    EncodeSession(inbound, 0, 0);
+    transport.Feed(inbound);
+    frames = WaitFrames(transport, 2);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].kind == FrameKind::Resume && ReadU64(Bytes(frames[0])) == 0);
+    CHECK(frames[1].data == "CLI-Bridge");
+    CHECK(WaitUntil([&] { return sink.Delivered().find(u"Session.Lost") != std::u16string::npos; }));
+    CHECK(core.GetStats().rebinds == 1);
+
+    core.Stop();
+    sink.Stop();
+
+    // UI ߳ÿϢֻǰֳɵ UTF-16 ص
+    std::vector<uint64_t> uiNs = sink.UiNs();
+    CHECK(!uiNs.empty());
+    std::sort(uiNs.begin(), uiNs.end());
+    BridgeStats stats = core.GetStats();
+    CHECK(stats.batches == uiNs.size());
+    std::printf("UI thread per message: %zu messages, p50=%lluns, max=%lluns (core: uiP50=%lluns, uiP99=%lluns)\n",
+        uiNs.size(), static_cast<unsigned long long>(uiNs[uiNs.size() / 2]), static_cast<unsigned long long>(uiNs.back()),
+        static_cast<unsigned long long>(stats.uiP50Ns), static_cast<unsigned long long>(stats.uiP99Ns));
+}
+
+// ֡޵ϢƬд֡ʱ·ƬͣǸδ֡֡ͷλ
+static void TestOversizedResend()
+{
+    FakeTransport transport;
+    RecordingUiSink sink;
+    BridgeCore core(transport, sink);
+    core.Start();
+
+    std::u16string huge(MAX_FRAME_LENGTH + 100, u'a');
+    core.Submit(huge.data(), huge.size(), nullptr, nullptr);
+    std::vector<WrittenFrame> frames = WaitFrames(transport, 2);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].kind == FrameKind::Resume);
+    CHECK(frames[1].kind == FrameKind::Message && frames[1].data == std::string(huge.size(), 'a'));
+
+    transport.Break();
+    frames = WaitFrames(transport, 2);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].kind == FrameKind::Resume && ReadU64(Bytes(frames[0])) == 0);
+    CHECK(frames[1].kind == FrameKind::Message && frames[1].data == std::string(huge.size(), 'a'));
+
+    core.Stop();
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestOversizedResend();
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Ϣַһ׼ParseMessageType / ActionTable 볣дԱȣns/Σ
+// - typeϣ vs Ƚַ if 
+// - actionActionTableѰַԤϣvs std::unordered_map<std::string> vs std::mapע ACTION_COUNT 
+//   δзֱ⣻ȡ "Module.Verb" ʽǰ׺ͬʵע action
+// ǰȺ˶ԸʵֵĽһ
+//   dispatch_bench [iterations]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../TestClient/Service/MessageDispatch.h"
+#include "TestCheck.h"
+
+static constexpr size_t ACTION_COUNT = 128;
+
+using Handler = size_t;
+
+// д˳Ƚ
+static MessageType ParseByCompare(std::string_view s)
+{
+    for (size_t i = 0; i < MESSAGE_TYPE_COUNT; ++i) {
+        if (MESSAGE_TYPE_NAMES[i] == s)
+            return static_cast<MessageType>(i);
+    }
+    return MessageType::Unknown;
+}
+
+static std::vector<std::string> ActionNames()
+{
+    static const char* const MODULES[] = { "State", "Device", "Config", "File", "Session", "Log", "Update", "Report" };
+    static const char* const VERBS[] = { "Get", "Set", "List", "Subscribe", "Unsubscribe", "Create", "Delete", "Query",
+        "Start", "Stop", "Reset", "Export", "Import", "Refresh", "Validate", "Describe" };
+
+    std::vector<std::string> names;
+    for (const char* module : MODULES) {
+        for (const char* verb : VERBS) {
+            names.push_back(std::string(module) + "." + verb);
+        }
+    }
+    return names;
+}
+
+template <typename F>
+static double NsPerOp(size_t iterations, size_t batch, F&& fn)
+{
+    for (size_t k = 0; k < iterations / 10 + 1; ++k)
+        fn();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < iterations; ++k)
+        fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+        / static_cast<double>(iterations * batch);
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    std::vector<std::string> names = ActionNames();
+    CHECK(names.size() == ACTION_COUNT);
+
+    ActionTable<Handler> table;
+    std::unordered_map<std::string, Handler> hashed;
+    std::map<std::string, Handler, std::less<>> ordered;
+    for (size_t i = 0; i < names.size(); ++i) {
+        table.Register(names[i], i);
+        hashed.emplace(names[i], i);
+        ordered.emplace(names[i], i);
+    }
+    CHECK(table.Size() == ACTION_COUNT);
+
+    // ҵյϢһڴ string_view
+    std::vector<std::string> hitText(names.begin(), names.end());
+    std::vector<std::string> missText;
+    for (const std::string& name : names) {
+        missText.push_back(name + "X");
+    }
+    std::vector<std::string_view> hits(hitText.begin(), hitText.end());
+    std::vector<std::string_view> misses(missText.begin(), missText.end());
+
+    for (size_t i = 0; i < hits.size(); ++i) {
+        CHECK(table.Find(hits[i]) && *table.Find(hits[i]) == i);
+        CHECK(!table.Find(misses[i]));
+    }
+
+    std::vector<std::string> typeText(MESSAGE_TYPE_NAMES.begin(), MESSAGE_TYPE_NAMES.end());
+    typeText.push_back("Unknown");
+    std::vector<std::string_view> types(typeText.begin(), typeText.end());
+    for (std::string_view t : types) {
+        CHECK(ParseMessageType(t) == ParseByCompare(t));
+    }
+
+    volatile size_t sink = 0;
+
+    std::printf("%-28s %10s\n", "lookup", "ns/op");
+    auto report = [](const char* name, double ns) { std::printf("%-28s %10.1f\n", name, ns); };
+
+    report("type: ParseMessageType", NsPerOp(iterations, types.size(), [&] {
+        for (std::string_view t : types)
+            sink = sink + static_cast<size_t>(ParseMessageType(t));
+        }));
+    report("type: compare chain", NsPerOp(iterations, types.size(), [&] {
+        for (std::string_view t : types)
+            sink = sink + static_cast<size_t>(ParseByCompare(t));
+        }));
+
+    size_t actionIterations = iterations / 10 + 1;
+    for (bool hit : { true, false }) {
+        const std::vector<std::string_view>& keys = hit ? hits : misses;
+        std::string label = hit ? "hit" : "miss";
+
+        report(("action " + label + ": ActionTable").c_str(), NsPerOp(actionIterations, keys.size(), [&] {
+            for (std::string_view k : keys) {
+                const Handler* h = table.Find(k);
+                sink = sink + (h ? *h : 0);
+            }
+            }));
+        // û͸ϣ unordered_map<std::string>find Ҫȹ std::string 
+        report(("action " + label + ": unordered_map").c_str(), NsPerOp(actionIterations, keys.size(), [&] {
+            for (std::string_view k : keys) {
+                auto it = hashed.find(std::string(k));
+                sink = sink + (it != hashed.end() ? it->second : 0);
+            }
+            }));
+        report(("action " + label + ": std::map").c_str(), NsPerOp(actionIterations, keys.size(), [&] {
+            for (std::string_view k : keys) {
+                auto it = ordered.find(k);
+                sink = sink + (it != ordered.end() ? it->second : 0);
+            }
+            }));
+    }
+    return 0;
+}
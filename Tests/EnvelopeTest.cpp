@@ -0,0 +1,86 @@
+// ŷȡ deadline ʱ
+// - ˵ĽʱFILETIME ת UtcNowMs ͬΪ Unix Ԫ
+// - timeoutMs ʵʱ㣬ʱ DeadlineExceeded 
+// - deadline  timeoutMs ͬʱȡߣ޷ʶֵ
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include "../TestClient/Service/Envelope.h"
+#include "TestCheck.h"
+
+static std::vector<uint8_t> Bytes(const std::string& text)
+{
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+//  GetSystemTimeAsFileTime ͬһʾ1601-01-01  100 
+static uint64_t FileTimeNow()
+{
+    return UtcNowMs() * 10000ULL + 116444736000000000ULL;
+}
+
+// յϢʱĴPipeServer  FileTimeToUnixMs ʱServiceManager ʱ deadline
+static PipeMessage Receive(const std::string& envelope)
+{
+    PipeMessage msg;
+    msg.clientId = "CLI-001";
+    msg.payload = Bytes(envelope);
+    msg.timestampMs = FileTimeToUnixMs(FileTimeNow());
+    msg.receivedUs = SteadyNowUs();
+    msg.deadlineMs = ReadDeadline(msg.payload, msg.timestampMs);
+    return msg;
+}
+
+static void TestFileTimeEpoch()
+{
+    CHECK(FileTimeToUnixMs(116444736000000000ULL) == 0);
+    CHECK(FileTimeToUnixMs(133485408000000000ULL) == 1704067200000ULL);      // 2024-01-01T00:00:00Z
+    CHECK(FileTimeToUnixMs(0) == 0);
+
+    uint64_t stamp = FileTimeToUnixMs(FileTimeNow());
+    uint64_t now = UtcNowMs();
+    CHECK(stamp <= now && now - stamp < 1000);
+}
+
+static void TestTimeoutExpires()
+{
+    PipeMessage msg = Receive(R"({"type":"Request","msgId":"a","timeoutMs":50,"payload":{}})");
+    CHECK(msg.deadlineMs == msg.timestampMs + 50);
+    CHECK(!DeadlineExceeded(msg));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    CHECK(DeadlineExceeded(msg));
+}
+
+static void TestAbsoluteDeadline()
+{
+    uint64_t now = UtcNowMs();
+    PipeMessage past = Receive(R"({"type":"Request","deadline":)" + std::to_string(now - 1) + "}");
+    CHECK(past.deadlineMs == now - 1);
+    CHECK(DeadlineExceeded(past));
+
+    PipeMessage future = Receive(R"({"type":"Request","deadline":)" + std::to_string(now + 60'000) + "}");
+    CHECK(!DeadlineExceeded(future));
+
+    // ȡ
+    PipeMessage both = Receive(R"({"deadline":)" + std::to_string(now + 60'000) + R"(,"timeoutMs":100})");
+    CHECK(both.deadlineMs == both.timestampMs + 100);
+
+    //  deadlinetimeoutMs Ϊ 0ֵ֣ʱ
+    CHECK(Receive(R"({"type":"Request"})").deadlineMs == 0);
+    CHECK(Receive(R"({"timeoutMs":0})").deadlineMs == 0);
+    CHECK(Receive(R"({"deadline":"soon"})").deadlineMs == 0);
+
+    // payload еͬ
+    CHECK(Receive(R"({"payload":{"timeoutMs":5}})").deadlineMs == 0);
+}
+
+int main()
+{
+    TestFileTimeEpoch();
+    TestTimeoutExpires();
+    TestAbsoluteDeadline();
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+// FrameBatcherģʱµĺΪ
+// - кĵһϢɷ֮ÿ֡෢һΣDeadline Ϊϴη + ֡
+// -  / ֽﵽֵʱ沢
+// -  typeֻ type֮ͬǰܵϢ
+// -  JSON Ϣȷ浱ǰΣٵ
+#include <cstdio>
+#include <string>
+#include "../WebViewHost/Bridge/FrameBatcher.h"
+#include "TestCheck.h"
+
+static constexpr uint64_t INTERVAL = 16'000'000;
+
+struct SimClock
+{
+    uint64_t now = 1'000'000'000;
+
+    FrameBatcher::Clock Fn() { return [this] { return now; }; }
+};
+
+static FrameBatcherConfig Config()
+{
+    FrameBatcherConfig config;
+    config.frameIntervalNs = INTERVAL;
+    return config;
+}
+
+static std::string Take(FrameBatcher& batcher)
+{
+    std::string out;
+    CHECK(batcher.TakeBatch(out));
+    return out;
+}
+
+// кһ֡ڵĺϢȵϴη + ֡ϳһ
+static void TestIntervalFlush()
+{
+    SimClock clock;
+    FrameBatcher batcher(Config(), clock.Fn());
+
+    std::string out;
+    CHECK(batcher.Empty());
+    CHECK(batcher.Deadline() == FrameBatcher::NO_DEADLINE);
+    CHECK(!batcher.TakeBatch(out));
+
+    CHECK(!batcher.Add(R"({"type":"Notify","n":1})"));
+    CHECK(batcher.Deadline() == 0);
+    CHECK(Take(batcher) == R"({"type":"Notify","n":1})");
+    uint64_t flushedAt = clock.now;
+    CHECK(batcher.Deadline() == FrameBatcher::NO_DEADLINE);
+
+    clock.now += 1'000'000;
+    CHECK(!batcher.Add(R"({"type":"Notify","n":2})"));
+    clock.now += 1'000'000;
+    CHECK(!batcher.Add(R"({"type":"Notify","n":3})"));
+    CHECK(batcher.Deadline() == flushedAt + INTERVAL);
+
+    clock.now = flushedAt + INTERVAL;
+    CHECK(Take(batcher) == R"([{"type":"Notify","n":2},{"type":"Notify","n":3}])");
+    CHECK(batcher.Empty());
+
+    // һηʱ
+    CHECK(!batcher.Add(R"({"type":"Notify","n":4})"));
+    CHECK(batcher.Deadline() == clock.now + INTERVAL);
+
+    CHECK(batcher.Batches() == 2);
+    CHECK(batcher.Messages() == 4);
+}
+
+static void TestCountThreshold()
+{
+    SimClock clock;
+    FrameBatcherConfig config = Config();
+    config.maxBatchMessages = 3;
+    FrameBatcher batcher(config, clock.Fn());
+
+    CHECK(!batcher.Add("{\"n\":0}"));
+    Take(batcher);
+
+    CHECK(!batcher.Add("{\"n\":1}"));
+    CHECK(!batcher.Add("{\"n\":2}"));
+    CHECK(batcher.Deadline() != 0);
+    CHECK(batcher.Add("{\"n\":3}"));
+    CHECK(batcher.Deadline() == 0);
+
+    // ѷ֮ϢһᲢΣȡ֮ǰһֱɷ
+    CHECK(batcher.Add("{\"n\":4}"));
+    CHECK(Take(batcher) == "[{\"n\":1},{\"n\":2},{\"n\":3}]");
+    CHECK(batcher.Deadline() == 0);
+    CHECK(Take(batcher) == "{\"n\":4}");
+    CHECK(batcher.Empty());
+
+    CHECK(!batcher.Add("{\"n\":5}"));
+    CHECK(batcher.Deadline() == clock.now + INTERVAL);
+}
+
+static void TestByteThreshold()
+{
+    SimClock clock;
+    FrameBatcherConfig config = Config();
+    config.maxBatchBytes = 64;
+    FrameBatcher batcher(config, clock.Fn());
+
+    CHECK(!batcher.Add("{}"));
+    Take(batcher);
+
+    std::string big = "{\"data\":\"" + std::string(50, 'x') + "\"}";
+    CHECK(!batcher.Add("{\"n\":1}"));
+    CHECK(batcher.Add(big));
+    CHECK(batcher.Deadline() == 0);
+    CHECK(Take(batcher) == "[{\"n\":1}," + big + "]");
+
+    // ͳֵԭ
+    std::string huge = "{\"data\":\"" + std::string(100, 'y') + "\"}";
+    CHECK(batcher.Add(huge));
+    CHECK(Take(batcher) == huge);
+    CHECK(batcher.Empty());
+}
+
+static void TestUrgentTypes()
+{
+    SimClock clock;
+    FrameBatcher batcher(Config(), clock.Fn());
+
+    CHECK(!batcher.Add(R"({"type":"Notify"})"));
+    Take(batcher);
+
+    clock.now += 1'000'000;
+    CHECK(!batcher.Add(R"({"type":"Notify","n":1})"));
+    CHECK(batcher.Add(R"({"type":"Response","msgId":7})"));
+    CHECK(batcher.Deadline() == 0);
+    CHECK(Take(batcher) == R"([{"type":"Notify","n":1},{"type":"Response","msgId":7}])");
+
+    // ״̬ص֡
+    CHECK(!batcher.Add(R"({"type":"Notify","n":2})"));
+    CHECK(batcher.Deadline() == clock.now + INTERVAL);
+    Take(batcher);
+
+    CHECK(batcher.Add(R"({ "type" : "Error", "error":{} })"));
+    Take(batcher);
+
+    // Ƕ׶ֵַе type 
+    CHECK(!batcher.Add(R"({"type":"Notify","payload":{"type":"Response"}})"));
+    CHECK(!batcher.Add(R"({"note":"\"type\":\"Error\"","type":"Notify"})"));
+    CHECK(!batcher.Add(R"({"kind":"type","type":"Notify"})"));
+    CHECK(batcher.Deadline() == clock.now + INTERVAL);
+
+    // رս type  Response Ҳ֡
+    FrameBatcherConfig config = Config();
+    config.urgentTypes.clear();
+    FrameBatcher plain(config, clock.Fn());
+    CHECK(!plain.Add(R"({"type":"Notify"})"));
+    Take(plain);
+    CHECK(!plain.Add(R"({"type":"Response"})"));
+    CHECK(plain.Deadline() == clock.now + INTERVAL);
+}
+
+static void TestNonObjectMessages()
+{
+    SimClock clock;
+    FrameBatcher batcher(Config(), clock.Fn());
+
+    CHECK(!batcher.Add("{\"n\":0}"));
+    Take(batcher);
+
+    CHECK(!batcher.Add("{\"n\":1}"));
+    CHECK(!batcher.Add("{\"n\":2}"));
+    CHECK(batcher.Add("[1,2,3]"));
+    CHECK(batcher.Deadline() == 0);
+    CHECK(batcher.Add("plain text"));
+    CHECK(batcher.Add("  {\"n\":3}"));
+
+    // ˳򲻱䣺֮ǰܵΡ顢ıԳȻ֮Ķ
+    CHECK(Take(batcher) == "[{\"n\":1},{\"n\":2}]");
+    CHECK(Take(batcher) == "[1,2,3]");
+    CHECK(Take(batcher) == "plain text");
+    CHECK(batcher.Deadline() == 0);
+    CHECK(Take(batcher) == "  {\"n\":3}");
+    CHECK(batcher.Empty());
+
+    // Ϣͬ
+    CHECK(batcher.Add(""));
+    CHECK(Take(batcher).empty());
+    CHECK(batcher.Empty());
+}
+
+static void TestExtractType()
+{
+    CHECK(FrameBatcher::ExtractType(R"({"type":"Response"})") == "Response");
+    CHECK(FrameBatcher::ExtractType(R"({"a":[{"type":"X"}],"type":"Y"})") == "Y");
+    CHECK(FrameBatcher::ExtractType(R"({"a":"\"","type":"Z"})") == "Z");
+    CHECK(FrameBatcher::ExtractType(R"({"type":1})").empty());
+    CHECK(FrameBatcher::ExtractType(R"({"payload":{"type":"X"}})").empty());
+    CHECK(FrameBatcher::ExtractType("not json").empty());
+}
+
+int main()
+{
+    TestIntervalFlush();
+    TestCountThreshold();
+    TestByteThreshold();
+    TestUrgentTypes();
+    TestNonObjectMessages();
+    TestExtractType();
+    std::printf("OK\n");
+    return 0;
+}
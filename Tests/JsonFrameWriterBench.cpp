@@ -0,0 +1,167 @@
+// Ӧл׼JsonFrameWriter ֱдػ֡ vs ԭ SendJsonToClient ·
+// - SendJsonToClient ·nlohmann::json  -> dump()  std::string ->  std::vector<uint8_t>
+//   -> MakeOutbound ٿػ岢֡ PipeServer::SendJsonToClient / MakeOutbound Ĵһ£
+// - JsonFrameWriter ·ֱдػ壬Finish ֡ǰ׺
+// ·ɵ֡ SendToClient(BufferLease)֮ķͿͬ
+// ״Error ӦServiceManager::MakeErrorResponseState ӦHandleStateAction 200 Ԫصб
+//   json_frame_writer_bench [iterations]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../TestClient/PipeServer/JsonFrameWriter.h"
+#include "TestCheck.h"
+
+static const nlohmann::json REQUEST = {
+    { "ver", "1.0" }, { "type", "Request" }, { "msgId", "req-000123" },
+    { "payload", { { "action", "State.Subscribe" }, { "params", { { "topic", "device/status" } } } } },
+};
+
+static constexpr size_t LIST_SIZE = 200;
+
+// ԭ MakeErrorResponse / HandleStateAction ͬд
+static nlohmann::json ErrorJson()
+{
+    nlohmann::json response = {
+        { "ver", "1.0" },
+        { "type", "Error" },
+        { "error", { { "code", "BadRequest" }, { "message", "missing topic" } } },
+    };
+    response["msgId"] = REQUEST["msgId"];
+    return response;
+}
+
+static nlohmann::json StateJson()
+{
+    nlohmann::json response = {
+        { "ver", "1.0" },
+        { "type", "Response" },
+        { "payload", { { "topic", "device/status" }, { "seq", 42 } } },
+    };
+    response["msgId"] = REQUEST["msgId"];
+    return response;
+}
+
+static nlohmann::json ListJson()
+{
+    nlohmann::json items = nlohmann::json::array();
+    for (size_t i = 0; i < LIST_SIZE; ++i) {
+        items.push_back({ { "id", i }, { "name", "item-" + std::to_string(i) }, { "enabled", i % 2 == 0 }, { "load", 0.5 } });
+    }
+    nlohmann::json response = { { "ver", "1.0" }, { "type", "Response" }, { "payload", { { "items", items } } } };
+    response["msgId"] = REQUEST["msgId"];
+    return response;
+}
+
+// PipeServer::SendJsonToClient(clientId, json.dump())  SendToClient(BufferLease) ֮ǰĲ
+static BufferLease ViaSendJson(BufferPool& pool, const nlohmann::json& response)
+{
+    std::string jsonUtf8 = response.dump();
+    std::vector<uint8_t> payload(jsonUtf8.begin(), jsonUtf8.end());
+    BufferLease buffer = pool.Copy(payload.data(), payload.size());
+    SealFrame(*buffer, FrameKind::Message);
+    return buffer;
+}
+
+static void WriteMsgId(JsonFrameWriter& w)
+{
+    w.Key("msgId").Raw(REQUEST["msgId"].dump());
+}
+
+static BufferLease ErrorWriter(const std::shared_ptr<BufferPool>& pool)
+{
+    JsonFrameWriter w(pool, 256);
+    w.BeginObject().Field("ver", "1.0").Field("type", "Error");
+    WriteMsgId(w);
+    w.Key("error").BeginObject().Field("code", "BadRequest").Field("message", "missing topic").EndObject();
+    return w.EndObject().Finish();
+}
+
+static BufferLease StateWriter(const std::shared_ptr<BufferPool>& pool)
+{
+    JsonFrameWriter w(pool, 256);
+    w.BeginObject().Field("ver", "1.0").Field("type", "Response");
+    WriteMsgId(w);
+    w.Key("payload").BeginObject().Field("topic", "device/status").Field("seq", uint64_t(42)).EndObject();
+    return w.EndObject().Finish();
+}
+
+static BufferLease ListWriter(const std::shared_ptr<BufferPool>& pool)
+{
+    JsonFrameWriter w(pool);
+    w.BeginObject().Field("ver", "1.0").Field("type", "Response");
+    WriteMsgId(w);
+    w.Key("payload").BeginObject().Key("items").BeginArray();
+    std::string name;
+    for (size_t i = 0; i < LIST_SIZE; ++i) {
+        name = "item-" + std::to_string(i);
+        w.BeginObject()
+            .Field("id", uint64_t(i))
+            .Field("name", name)
+            .Field("enabled", i % 2 == 0)
+            .Field("load", 0.5)
+            .EndObject();
+    }
+    w.EndArray().EndObject();
+    return w.EndObject().Finish();
+}
+
+// ·Ľͬͬ
+static void CheckSame(const BufferLease& a, const BufferLease& b)
+{
+    CHECK(a->IsSealed() && b->IsSealed());
+    auto pa = nlohmann::json::parse(a->Data(), a->Data() + a->Size());
+    auto pb = nlohmann::json::parse(b->Data(), b->Data() + b->Size());
+    CHECK(pa == pb);
+}
+
+template <typename F>
+static double NsPerOp(size_t iterations, F&& fn)
+{
+    for (size_t k = 0; k < iterations / 10 + 1; ++k)
+        fn();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < iterations; ++k)
+        fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+        / static_cast<double>(iterations);
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    std::shared_ptr<BufferPool> pool = BufferPool::Create();
+
+    struct Case
+    {
+        const char* name;
+        nlohmann::json (*build)();
+        BufferLease (*write)(const std::shared_ptr<BufferPool>&);
+        size_t divisor;
+    };
+    const Case cases[] = {
+        { "error", ErrorJson, ErrorWriter, 1 },
+        { "state", StateJson, StateWriter, 1 },
+        { "list200", ListJson, ListWriter, 100 },
+    };
+
+    std::printf("%-8s %8s %22s %22s %18s %8s\n", "shape", "bytes", "SendJsonToClient(ns)", "  (prebuilt json, ns)",
+        "JsonFrameWriter(ns)", "speedup");
+    for (const Case& c : cases) {
+        BufferLease viaJson = ViaSendJson(*pool, c.build());
+        BufferLease viaWriter = c.write(pool);
+        CheckSame(viaJson, viaWriter);
+
+        size_t n = iterations / c.divisor;
+        volatile size_t sink = 0;
+        // ֳͨ nlohmann::json챾룻ѹֻ dump 
+        double full = NsPerOp(n, [&] { sink = sink + ViaSendJson(*pool, c.build())->FrameSize(); });
+        nlohmann::json prebuilt = c.build();
+        double dumpOnly = NsPerOp(n, [&] { sink = sink + ViaSendJson(*pool, prebuilt)->FrameSize(); });
+        double writer = NsPerOp(n, [&] { sink = sink + c.write(pool)->FrameSize(); });
+        std::printf("%-8s %8zu %22.0f %22.0f %18.0f %7.1fx\n", c.name, viaWriter->Size(), full, dumpOnly, writer, full / writer);
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Ϣζʹ Windowsͬһ PipeServerͻ˰ű / Ͽ
+// 1. ״ Hello ʼỰ REPLAY_COUNT Ϣ AckطŻ
+// 2. ڼ˷ MAILBOX_COUNT Ϣ
+// 3. ֻ Welcome ͲٶطռסдϢͣڻѹУʱٴζ
+// 4. ط֮Ӧԭ˳յȫϢһ
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TestClient/PipeServer/PipeServer.h"
+#include "TestCheck.h"
+
+static constexpr size_t REPLAY_COUNT = 64;
+static constexpr size_t REPLAY_SIZE = 16 * 1024;        // طԶڹܵ壬ӲʱдȻ
+static constexpr size_t MAILBOX_COUNT = 3;
+
+static const std::string CLIENT_ID = "mailbox-client";
+
+static bool ReadExact(HANDLE pipe, void* data, size_t size)
+{
+    uint8_t* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        DWORD read = 0;
+        if (!ReadFile(pipe, p, static_cast<DWORD>((std::min<size_t>)(size, 1 << 20)), &read, nullptr) || read == 0)
+            return false;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+// һ Message ֡ݣ֡ܵϿʱ false
+static bool ReadMessage(HANDLE pipe, std::string& text)
+{
+    std::vector<uint8_t> payload;
+    for (;;) {
+        uint32_t header = 0;
+        if (!ReadExact(pipe, &header, sizeof(header)))
+            return false;
+        payload.resize(HeaderLength(header));
+        if (!ReadExact(pipe, payload.data(), payload.size()))
+            return false;
+        if (HeaderKind(header) == FrameKind::Message) {
+            text.assign(payload.begin(), payload.end());
+            return true;
+        }
+    }
+}
+
+static bool WriteMessage(HANDLE pipe, const std::string& text)
+{
+    std::vector<uint8_t> frame;
+    EncodeFrame(frame, FrameKind::Message, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    DWORD written = 0;
+    return WriteFile(pipe, frame.data(), static_cast<DWORD>(frame.size()), &written, nullptr) && written == frame.size();
+}
+
+static HANDLE Connect(const std::wstring& pipeName)
+{
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    for (int i = 0; i < 50 && pipe == INVALID_HANDLE_VALUE; i++) {
+        pipe = CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe == INVALID_HANDLE_VALUE)
+            Sleep(20);
+    }
+    CHECK(pipe != INVALID_HANDLE_VALUE);
+    return pipe;
+}
+
+//  Hellotoken Ϊձʾʼ»Ự WelcomeػỰ
+static std::string Hello(HANDLE pipe, const std::string& token)
+{
+    std::string resume = token.empty() ? "{}" : R"({"token":")" + token + R"(","received":0})";
+    CHECK(WriteMessage(pipe, R"({"ver":"1.0","type":"Hello","msgId":"hello","payload":{"clientIdHint":")" + CLIENT_ID
+        + R"(","resume":)" + resume + "}}"));
+
+    std::string welcome;
+    CHECK(ReadMessage(pipe, welcome));
+    CHECK(welcome.find("\"Welcome\"") != std::string::npos);
+    CHECK(token.empty() || welcome.find("\"resumed\":true") != std::string::npos);
+
+    static constexpr char KEY[] = "\"resumeToken\":\"";
+    size_t pos = welcome.find(KEY);
+    CHECK(pos != std::string::npos);
+    pos += sizeof(KEY) - 1;
+    return welcome.substr(pos, welcome.find('"', pos) - pos);
+}
+
+// رտͻһˣȷ˲߲ѻỰת
+static void Disconnect(PipeServer& server, HANDLE pipe)
+{
+    CloseHandle(pipe);
+    CHECK(WaitUntil([&] { return server.ListClients().empty(); }));
+}
+
+static std::string Tag(const std::string& text)
+{
+    static constexpr char KEY[] = "\"tag\":\"";
+    size_t pos = text.find(KEY);
+    if (pos == std::string::npos)
+        return {};
+    pos += sizeof(KEY) - 1;
+    return text.substr(pos, text.find('"', pos) - pos);
+}
+
+static void TestMailboxSurvivesTwoDisconnects(PipeServer& server, const std::wstring& pipeName)
+{
+    // 1. »ỰطϢȷ
+    HANDLE first = Connect(pipeName);
+    std::string token = Hello(first, "");
+    CHECK(WaitUntil([&] { return server.ListClients().size() == 1; }));
+    std::string filler(REPLAY_SIZE, 'x');
+    for (size_t i = 0; i < REPLAY_COUNT; i++) {
+        CHECK(server.SendJsonToClient(CLIENT_ID, R"({"type":"Notify","tag":"replay-)" + std::to_string(i)
+            + R"(","data":")" + filler + R"("})"));
+    }
+    std::string text;
+    for (size_t i = 0; i < REPLAY_COUNT; i++) {
+        CHECK(ReadMessage(first, text));
+        CHECK(Tag(text) == "replay-" + std::to_string(i));
+    }
+    Disconnect(server, first);
+
+    // 2. ڼϢ
+    for (size_t i = 0; i < MAILBOX_COUNT; i++) {
+        CHECK(server.SendJsonToClient(CLIENT_ID, R"({"type":"Notify","tag":"mailbox-)" + std::to_string(i) + R"("})"));
+    }
+    CHECK(server.GetStats().mailbox.messages == MAILBOX_COUNT);
+
+    // 3. ȡ䣬طŻûдٴζ
+    uint64_t delivered = server.GetStats().mailbox.delivered;
+    HANDLE second = Connect(pipeName);
+    CHECK(Hello(second, token) == token);
+    CHECK(WaitUntil([&] { return server.GetStats().mailbox.delivered == delivered + MAILBOX_COUNT; }));
+    Disconnect(server, second);
+
+    // 4. ٴȫط֮Ϣԭ˳򡢸һ
+    HANDLE third = Connect(pipeName);
+    CHECK(Hello(third, token) == token);
+    std::vector<std::string> tags;
+    std::atomic<bool> done{ false };
+    std::thread reader([&] {
+        std::string message;
+        while (tags.size() < REPLAY_COUNT + MAILBOX_COUNT && ReadMessage(third, message)) {
+            tags.push_back(Tag(message));
+        }
+        done = true;
+        });
+    // Ϣʧʱ̻߳һֱȣʱɷ˶Ͽ
+    if (!WaitUntil([&] { return done.load(); })) {
+        server.DisconnectClient(CLIENT_ID);
+    }
+    reader.join();
+    Disconnect(server, third);
+
+    CHECK(tags.size() == REPLAY_COUNT + MAILBOX_COUNT);
+    for (size_t i = 0; i < REPLAY_COUNT; i++) {
+        CHECK(tags[i] == "replay-" + std::to_string(i));
+    }
+    for (size_t i = 0; i < MAILBOX_COUNT; i++) {
+        CHECK(tags[REPLAY_COUNT + i] == "mailbox-" + std::to_string(i));
+    }
+}
+
+int main()
+{
+    std::wstring pipeName = L"\\\\.\\pipe\\MailboxResumeTest-" + std::to_wstring(GetCurrentProcessId());
+    PipeServer server(pipeName);
+    if (!server.Start()) {
+        std::printf("PipeServer failed to start\n");
+        return 1;
+    }
+
+    TestMailboxSurvivesTwoDisconnects(server, pipeName);
+
+    server.Stop();
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Batch ֡»׼ Windowsͬһ PipeServer һ Hello ͻˣСϢ
+// ͻ˰֡ȡÿ֡ ReadFileǰ׺ + ݣBatch ֡Ϣ
+// ֱ /  supportsBatch Ŀͻ˸һ֣棺
+// - msgs/sͻȫϢ
+// - CPU/msg̣˶д߳ + ͻˣû̬ + ں̬ CPU ʱϢ
+// - writes/msgreads/msg WriteFile ͻ ReadFile 
+// Ͷ WINDOW ȶ״̬һŶ
+//   pipe_batch_bench [messages] [payload bytes]
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TestClient/PipeServer/PipeServer.h"
+
+static constexpr size_t WINDOW = 4096;
+
+struct Result
+{
+    double   msgsPerSecond = 0;
+    double   cpuUsPerMessage = 0;
+    double   writesPerMessage = 0;
+    double   readsPerMessage = 0;
+    size_t   received = 0;
+};
+
+static uint64_t ProcessCpuUs()
+{
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    auto us = [](const FILETIME& ft) {
+        ULARGE_INTEGER uli;
+        uli.LowPart = ft.dwLowDateTime;
+        uli.HighPart = ft.dwHighDateTime;
+        return static_cast<uint64_t>(uli.QuadPart / 10);
+    };
+    return us(kernel) + us(user);
+}
+
+static bool ReadExact(HANDLE pipe, void* data, size_t size, size_t& reads)
+{
+    uint8_t* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        DWORD read = 0;
+        if (!ReadFile(pipe, p, static_cast<DWORD>((std::min<size_t>)(size, 1 << 20)), &read, nullptr) || read == 0)
+            return false;
+        reads++;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+static bool WriteMessage(HANDLE pipe, const std::string& text)
+{
+    std::vector<uint8_t> frame;
+    EncodeFrame(frame, FrameKind::Message, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    DWORD written = 0;
+    return WriteFile(pipe, frame.data(), static_cast<DWORD>(frame.size()), &written, nullptr) && written == frame.size();
+}
+
+static Result RunOnce(PipeServer& server, const std::wstring& pipeName, bool batch, size_t count, size_t payloadSize)
+{
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    for (int i = 0; i < 50 && pipe == INVALID_HANDLE_VALUE; i++) {
+        pipe = CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe == INVALID_HANDLE_VALUE)
+            Sleep(20);
+    }
+    if (pipe == INVALID_HANDLE_VALUE)
+        return {};
+
+    std::string clientId = batch ? "bench-batch" : "bench-single";
+    WriteMessage(pipe, R"({"ver":"1.0","type":"Hello","msgId":"hello","payload":{"clientIdHint":")" + clientId
+        + R"(","capabilities":{"supportsBatch":)" + (batch ? "true" : "false") + "}}}");
+    while (server.ListClients().empty())
+        Sleep(1);
+
+    // ̣߳֡ȡMessage ֡ Batch ֡ڵÿϢWelcome ƣ
+    std::atomic<size_t> received{ 0 };
+    size_t reads = 0;
+    std::thread reader([&] {
+        std::vector<uint8_t> payload;
+        bool welcomed = false;
+        while (received.load(std::memory_order_relaxed) < count) {
+            uint32_t header = 0;
+            if (!ReadExact(pipe, &header, sizeof(header), reads))
+                break;
+            payload.resize(HeaderLength(header));
+            if (!ReadExact(pipe, payload.data(), payload.size(), reads))
+                break;
+            if (HeaderKind(header) == FrameKind::Batch) {
+                size_t n = 0;
+                ForEachBatchMessage(payload.data(), payload.size(), [&](const uint8_t*, size_t) { n++; });
+                received.fetch_add(n, std::memory_order_relaxed);
+            }
+            else if (HeaderKind(header) == FrameKind::Message) {
+                if (welcomed) {
+                    received.fetch_add(1, std::memory_order_relaxed);
+                }
+                welcomed = true;
+            }
+        }
+        });
+
+    std::string body(payloadSize, 'x');
+    uint64_t writesBefore = server.GetStats().writes;
+    uint64_t cpuBefore = ProcessCpuUs();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t seq = 0; seq < count; seq++) {
+        while (seq >= received.load(std::memory_order_relaxed) + WINDOW)
+            std::this_thread::yield();
+        server.SendJsonToClient(clientId, R"({"ver":"1.0","type":"Notify","seq":)" + std::to_string(seq)
+            + R"(,"payload":")" + body + R"("})");
+    }
+    reader.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t cpuUs = ProcessCpuUs() - cpuBefore;
+    uint64_t writes = server.GetStats().writes - writesBefore;
+
+    server.DisconnectClient(clientId);
+    CloseHandle(pipe);
+    while (!server.ListClients().empty())
+        Sleep(1);
+
+    Result result;
+    result.received = received.load();
+    if (result.received == 0)
+        return result;
+    double n = static_cast<double>(result.received);
+    result.msgsPerSecond = n / seconds;
+    result.cpuUsPerMessage = static_cast<double>(cpuUs) / n;
+    result.writesPerMessage = static_cast<double>(writes) / n;
+    result.readsPerMessage = static_cast<double>(reads) / n;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t payloadSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+
+    std::wstring pipeName = L"\\\\.\\pipe\\PipeBatchBench-" + std::to_wstring(GetCurrentProcessId());
+    PipeServer server(pipeName, 4, 64 * 1024);
+    if (!server.Start()) {
+        std::printf("PipeServer failed to start\n");
+        return 1;
+    }
+
+    std::printf("%zu messages, %zu-byte payload\n", count, payloadSize);
+    std::printf("%-8s %10s %12s %12s %12s %12s\n", "client", "received", "msgs/s", "CPU us/msg", "writes/msg", "reads/msg");
+    for (bool batch : { false, true }) {
+        Result r = RunOnce(server, pipeName, batch, count, payloadSize);
+        std::printf("%-8s %10zu %12.0f %12.2f %12.3f %12.3f\n", batch ? "batch" : "single", r.received, r.msgsPerSecond,
+            r.cpuUsPerMessage, r.writesPerMessage, r.readsPerMessage);
+    }
+
+    PipeServerStats stats = server.GetStats();
+    std::printf("server: batches=%llu batchedMessages=%llu\n", static_cast<unsigned long long>(stats.batches),
+        static_cast<unsigned long long>(stats.batchedMessages));
+    server.Stop();
+    return 0;
+}
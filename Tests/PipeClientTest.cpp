@@ -0,0 +1,365 @@
+// PipeClientűؽļٹܵ˵㣬 Win32
+// - ӣæ / δҵʱ CONNECT_RETRY_DELAY ԣ MAX_CONNECT_ATTEMPTS Σ
+// - д룺ʧʱϿ MAX_WRITE_ATTEMPTS Σ֡ÿдһ
+// - ȡһ Read  falseʧܶϿһ Read 
+// - Cancelеĵȴ / ȡأ֮ĵò
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../WebViewHost/Bridge/PipeClient.h"
+#include "TestCheck.h"
+
+using Status = IPipeEndpoint::Status;
+using namespace std::chrono_literals;
+
+class ScriptedEndpoint : public IPipeEndpoint
+{
+public:
+    struct Written
+    {
+        int                     connection;             // ڼ Open ɹӣ 1 ʼ
+        std::string             data;
+    };
+
+    // űþOpen / Write  OkRead  Close  Cancel
+    std::deque<Status>          opens;
+    std::deque<Status>          writes;
+    std::deque<std::string>     reads;                  // մʾʧܣԶ˹رգ
+    bool                        blockWaits = false;     // WaitRetry  Cancelڲȡ
+
+    Status Open() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_openCalls++;
+        if (m_cancelled)
+            return Status::Cancelled;
+        Status status = Pop(opens);
+        if (status == Status::Ok) {
+            m_connection++;
+            m_open = true;
+        }
+        return status;
+    }
+
+    void Close() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = false;
+        m_closes++;
+        m_cv.notify_all();
+    }
+
+    Status Read(uint8_t* target, size_t capacity, size_t& bytesRead) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bytesRead = 0;
+        if (reads.empty()) {
+            int connection = m_connection;
+            m_cv.wait(lock, [&] { return m_cancelled || !m_open || m_connection != connection; });
+            return m_cancelled ? Status::Cancelled : Status::Failed;
+        }
+
+        std::string chunk = std::move(reads.front());
+        reads.pop_front();
+        if (chunk.empty())
+            return Status::Failed;
+        CHECK(chunk.size() <= capacity);
+        std::copy(chunk.begin(), chunk.end(), target);
+        bytesRead = chunk.size();
+        return Status::Ok;
+    }
+
+    Status Write(const uint8_t* data, size_t size) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        CHECK(m_open);
+        if (m_cancelled)
+            return Status::Cancelled;
+        Status status = Pop(writes);
+        if (status == Status::Ok) {
+            m_written.push_back({ m_connection, std::string(reinterpret_cast<const char*>(data), size) });
+        }
+        return status;
+    }
+
+    bool WaitRetry(std::chrono::milliseconds delay) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waits.push_back(delay);
+        m_cv.notify_all();
+        if (blockWaits) {
+            m_cv.wait(lock, [&] { return m_cancelled; });
+        }
+        return !m_cancelled;
+    }
+
+    void Cancel() override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        m_cv.notify_all();
+    }
+
+    std::vector<Written> WrittenData()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    std::vector<std::chrono::milliseconds> Waits()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_waits;
+    }
+
+    int OpenCalls()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_openCalls;
+    }
+
+    int Closes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_closes;
+    }
+
+private:
+    static Status Pop(std::deque<Status>& script)
+    {
+        if (script.empty())
+            return Status::Ok;
+        Status status = script.front();
+        script.pop_front();
+        return status;
+    }
+
+private:
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cv;
+    bool                        m_cancelled = false;
+    bool                        m_open = false;
+    int                         m_connection = 0;
+    int                         m_openCalls = 0;
+    int                         m_closes = 0;
+    std::vector<Written>        m_written;
+    std::vector<std::chrono::milliseconds> m_waits;
+};
+
+// ֡ݴɴÿдһ
+static void SetCountingGreeting(PipeClient& client, int& greetings)
+{
+    greetings = 0;
+    client.SetGreeting([&greetings](std::vector<uint8_t>& frames) {
+        std::string text = "greet" + std::to_string(++greetings);
+        frames.assign(text.begin(), text.end());
+        });
+}
+
+static bool WriteText(PipeClient& client, const std::string& text)
+{
+    return client.Write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+static void TestConnectRetry()
+{
+    ScriptedEndpoint endpoint;
+    endpoint.opens = { Status::Busy, Status::NotFound, Status::Busy, Status::Ok };
+    PipeClient client(endpoint);
+    int greetings = 0;
+    SetCountingGreeting(client, greetings);
+
+    CHECK(WriteText(client, "hello"));
+    CHECK(endpoint.OpenCalls() == 4);
+    std::vector<std::chrono::milliseconds> waits = endpoint.Waits();
+    CHECK(waits.size() == 3);
+    for (auto delay : waits)
+        CHECK(delay == PipeClient::CONNECT_RETRY_DELAY);
+
+    auto written = endpoint.WrittenData();
+    CHECK(written.size() == 2);
+    CHECK(written[0].connection == 1 && written[0].data == "greet1");
+    CHECK(written[1].connection == 1 && written[1].data == "hello");
+
+    PipeClientStats stats = client.GetStats();
+    CHECK(stats.connects == 1);
+    CHECK(stats.connectFailures == 0);
+    CHECK(stats.writeRetries == 0);
+}
+
+// һֱæÿֳ MAX_CONNECT_ATTEMPTS κWrite  MAX_WRITE_ATTEMPTS ֣
+static void TestConnectGiveUp()
+{
+    ScriptedEndpoint endpoint;
+    endpoint.opens.assign(PipeClient::MAX_CONNECT_ATTEMPTS * PipeClient::MAX_WRITE_ATTEMPTS, Status::Busy);
+    PipeClient client(endpoint);
+
+    CHECK(!WriteText(client, "lost"));
+    CHECK(endpoint.OpenCalls() == PipeClient::MAX_CONNECT_ATTEMPTS * PipeClient::MAX_WRITE_ATTEMPTS);
+    CHECK(endpoint.WrittenData().empty());
+    PipeClientStats stats = client.GetStats();
+    CHECK(stats.connects == 0);
+    CHECK(stats.connectFailures == PipeClient::MAX_WRITE_ATTEMPTS);
+    CHECK(stats.writeRetries == PipeClient::MAX_WRITE_ATTEMPTS - 1);
+
+    ScriptedEndpoint failing;
+    failing.opens = { Status::Failed, Status::Failed, Status::Failed };
+    PipeClient other(failing);
+    CHECK(!WriteText(other, "lost"));
+    CHECK(failing.OpenCalls() == PipeClient::MAX_WRITE_ATTEMPTS);
+    for (auto delay : failing.Waits())
+        CHECK(delay == PipeClient::WRITE_RETRY_DELAY);
+}
+
+// дʧܣϿȴ WRITE_RETRY_DELAYд֡д
+static void TestWriteRetryReconnects()
+{
+    ScriptedEndpoint endpoint;
+    PipeClient client(endpoint);
+    int greetings = 0;
+    SetCountingGreeting(client, greetings);
+
+    CHECK(WriteText(client, "first"));
+    CHECK(WriteText(client, "second"));
+    CHECK(greetings == 1);
+
+    endpoint.writes = { Status::Failed };
+    CHECK(WriteText(client, "third"));
+    CHECK(greetings == 2);
+    CHECK(endpoint.Closes() == 1);
+    CHECK(endpoint.Waits() == std::vector<std::chrono::milliseconds>{ PipeClient::WRITE_RETRY_DELAY });
+
+    auto written = endpoint.WrittenData();
+    CHECK(written.size() == 5);
+    CHECK(written[0].connection == 1 && written[0].data == "greet1");
+    CHECK(written[1].connection == 1 && written[1].data == "first");
+    CHECK(written[2].connection == 1 && written[2].data == "second");
+    CHECK(written[3].connection == 2 && written[3].data == "greet2");
+    CHECK(written[4].connection == 2 && written[4].data == "third");
+
+    PipeClientStats stats = client.GetStats();
+    CHECK(stats.connects == 2);
+    CHECK(stats.writeRetries == 1);
+    CHECK(stats.disconnects == 1);
+
+    // ֡дʧͬݲдû֡
+    endpoint.writes = { Status::Failed };
+    client.Disconnect();
+    CHECK(WriteText(client, "fourth"));
+    written = endpoint.WrittenData();
+    CHECK(written.size() == 7);
+    CHECK(written[5].connection == 4 && written[5].data == "greet4");
+    CHECK(written[6].connection == 4 && written[6].data == "fourth");
+
+    // ÿζʧܣ MAX_WRITE_ATTEMPTS κ󷵻 false
+    endpoint.writes.assign(PipeClient::MAX_WRITE_ATTEMPTS, Status::Failed);
+    CHECK(!WriteText(client, "lost"));
+    CHECK(endpoint.WrittenData().size() == 7);
+    CHECK(client.GetStats().writeRetries == 2 + PipeClient::MAX_WRITE_ATTEMPTS - 1);
+}
+
+// size Ϊ 0  Write ֻӺ֡û֡ʱд
+static void TestGreetingOnly()
+{
+    ScriptedEndpoint endpoint;
+    PipeClient client(endpoint);
+    int greetings = 0;
+    SetCountingGreeting(client, greetings);
+
+    CHECK(client.Write(nullptr, 0));
+    CHECK(client.Write(nullptr, 0));
+    auto written = endpoint.WrittenData();
+    CHECK(written.size() == 1 && written[0].data == "greet1");
+
+    ScriptedEndpoint silent;
+    PipeClient plain(silent);
+    plain.SetGreeting([](std::vector<uint8_t>&) {});
+    CHECK(plain.Write(nullptr, 0));
+    CHECK(WriteText(plain, "data"));
+    written = silent.WrittenData();
+    CHECK(written.size() == 1 && written[0].data == "data");
+}
+
+// ʧܶϿһ Read  falseϵİ֮֡ȡ
+static void TestReadReconnect()
+{
+    ScriptedEndpoint endpoint;
+    endpoint.reads = { "abc", "", "def" };
+    PipeClient client(endpoint);
+
+    uint8_t buffer[16];
+    size_t bytesRead = 0;
+    CHECK(!client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(std::string(reinterpret_cast<char*>(buffer), bytesRead) == "abc");
+
+    CHECK(!client.Read(buffer, sizeof(buffer), bytesRead) && bytesRead == 0);
+    CHECK(client.GetStats().disconnects == 1);
+
+    CHECK(!client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(client.GetStats().connects == 2);
+    CHECK(client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(std::string(reinterpret_cast<char*>(buffer), bytesRead) == "def");
+
+    // д߳󣬶߳ͬȷһ false
+    client.Disconnect();
+    CHECK(client.Write(nullptr, 0));
+    endpoint.reads = { "ghi" };
+    CHECK(!client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(client.Read(buffer, sizeof(buffer), bytesRead));
+    CHECK(std::string(reinterpret_cast<char*>(buffer), bytesRead) == "ghi");
+}
+
+// CancelԵȴе Writeڶȡе Read أ֮ٳ
+static void TestCancel()
+{
+    ScriptedEndpoint endpoint;
+    endpoint.opens.assign(PipeClient::MAX_CONNECT_ATTEMPTS, Status::NotFound);
+    endpoint.blockWaits = true;
+    PipeClient client(endpoint);
+
+    bool writeResult = true;
+    std::thread writer([&] { writeResult = WriteText(client, "never"); });
+    CHECK(WaitUntil([&] { return endpoint.Waits().size() == 1; }));
+
+    client.Cancel();
+    writer.join();
+    CHECK(!writeResult);
+    CHECK(endpoint.OpenCalls() == 1);
+    CHECK(endpoint.WrittenData().empty());
+
+    CHECK(!WriteText(client, "after cancel"));
+    CHECK(endpoint.OpenCalls() == 1);
+
+    ScriptedEndpoint reading;
+    PipeClient reader(reading);
+    uint8_t buffer[16];
+    size_t bytesRead = 0;
+    CHECK(!reader.Read(buffer, sizeof(buffer), bytesRead));
+
+    bool readResult = true;
+    std::thread blocked([&] { readResult = reader.Read(buffer, sizeof(buffer), bytesRead); });
+    std::this_thread::sleep_for(20ms);
+    reader.Cancel();
+    blocked.join();
+    CHECK(!readResult && bytesRead == 0);
+    // ȡ
+    CHECK(reader.GetStats().disconnects == 0);
+}
+
+int main()
+{
+    TestConnectRetry();
+    TestConnectGiveUp();
+    TestWriteRetryReconnects();
+    TestGreetingOnly();
+    TestReadReconnect();
+    TestCancel();
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// СϢӳٻ׼ Windowsͬһ PipeServer һͻˣ
+// ÿ SMALL_INTERVAL_US һСϢʱ̣ͻ˶¼ӳ٣
+// ȲֻСϢں̨ʹϢͬʱһΣԱ p50 / p99
+// ֱ Hello ֵĿͻˣϢƬͣ봿ı clientId ľɿͻˣϢ֡дһ֡
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TestClient/PipeServer/PipeServer.h"
+
+static constexpr size_t   SMALL_COUNT = 2000;
+static constexpr uint64_t SMALL_INTERVAL_US = 500;
+static constexpr size_t   BULK_SIZE = 1024 * 1024;
+static constexpr auto     BULK_INTERVAL = std::chrono::milliseconds(5);
+
+static uint64_t NowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static bool ReadExact(HANDLE pipe, void* data, size_t size)
+{
+    uint8_t* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        DWORD read = 0;
+        if (!ReadFile(pipe, p, static_cast<DWORD>((std::min<size_t>)(size, 1 << 20)), &read, nullptr) || read == 0)
+            return false;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+static bool WriteMessage(HANDLE pipe, const std::string& text)
+{
+    std::vector<uint8_t> frame;
+    EncodeFrame(frame, FrameKind::Message, reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    DWORD written = 0;
+    return WriteFile(pipe, frame.data(), static_cast<DWORD>(frame.size()), &written, nullptr) && written == frame.size();
+}
+
+struct Result
+{
+    uint64_t p50Us = 0;
+    uint64_t p99Us = 0;
+    uint64_t maxUs = 0;
+    size_t   received = 0;
+};
+
+// ֻ̣߳ͳƴ sentUs СϢϢ֡Ƭ
+static Result ReadSmall(HANDLE pipe, size_t expected)
+{
+    std::vector<uint64_t> latencies;
+    latencies.reserve(expected);
+    std::vector<uint8_t> payload;
+    while (latencies.size() < expected) {
+        uint32_t header = 0;
+        if (!ReadExact(pipe, &header, sizeof(header)))
+            break;
+        payload.resize(HeaderLength(header));
+        if (!ReadExact(pipe, payload.data(), payload.size()))
+            break;
+        if (HeaderKind(header) != FrameKind::Message)
+            continue;
+
+        static constexpr char KEY[] = "\"sentUs\":";
+        std::string_view text(reinterpret_cast<const char*>(payload.data()), payload.size());
+        size_t pos = text.find(KEY);
+        if (pos == std::string_view::npos)
+            continue;
+        uint64_t sentUs = std::strtoull(text.data() + pos + sizeof(KEY) - 1, nullptr, 10);
+        latencies.push_back(NowUs() - sentUs);
+    }
+
+    Result result;
+    result.received = latencies.size();
+    if (latencies.empty())
+        return result;
+    std::sort(latencies.begin(), latencies.end());
+    result.p50Us = latencies[latencies.size() * 50 / 100];
+    result.p99Us = latencies[latencies.size() * 99 / 100];
+    result.maxUs = latencies.back();
+    return result;
+}
+
+static Result RunOnce(PipeServer& server, const std::wstring& pipeName, bool hello, bool bulk)
+{
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    for (int i = 0; i < 50 && pipe == INVALID_HANDLE_VALUE; i++) {
+        pipe = CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe == INVALID_HANDLE_VALUE)
+            Sleep(20);
+    }
+    if (pipe == INVALID_HANDLE_VALUE)
+        return {};
+
+    std::string clientId = hello ? "bench-hello" : "bench-legacy";
+    WriteMessage(pipe, hello
+        ? R"({"ver":"1.0","type":"Hello","msgId":"hello","payload":{"clientIdHint":")" + clientId + R"("}})"
+        : clientId);
+    while (server.ListClients().empty())
+        Sleep(1);
+
+    std::atomic<bool> running{ true };
+    std::thread bulkSender;
+    if (bulk) {
+        bulkSender = std::thread([&] {
+            std::string payload = R"({"ver":"1.0","type":"Notify","payload":")" + std::string(BULK_SIZE, 'x') + R"("})";
+            while (running) {
+                server.SendJsonToClient(clientId, payload);
+                std::this_thread::sleep_for(BULK_INTERVAL);
+            }
+            });
+    }
+
+    Result result;
+    std::thread reader([&] { result = ReadSmall(pipe, SMALL_COUNT); });
+    for (size_t seq = 0; seq < SMALL_COUNT; seq++) {
+        uint64_t due = NowUs() + SMALL_INTERVAL_US;
+        server.SendJsonToClient(clientId, R"({"ver":"1.0","type":"Notify","seq":)" + std::to_string(seq)
+            + R"(,"sentUs":)" + std::to_string(NowUs()) + "}");
+        while (NowUs() < due)
+            std::this_thread::yield();
+    }
+
+    reader.join();
+    running = false;
+    if (bulkSender.joinable())
+        bulkSender.join();
+    server.DisconnectClient(clientId);
+    CloseHandle(pipe);
+    while (!server.ListClients().empty())
+        Sleep(1);
+    return result;
+}
+
+int main()
+{
+    std::wstring pipeName = L"\\\\.\\pipe\\PipeLatencyBench-" + std::to_wstring(GetCurrentProcessId());
+    PipeServer server(pipeName);
+    server.SetBatchConfig({ false });
+    if (!server.Start()) {
+        std::printf("PipeServer failed to start\n");
+        return 1;
+    }
+
+    std::printf("%-8s %-10s %10s %10s %10s %10s\n", "client", "traffic", "received", "p50(us)", "p99(us)", "max(us)");
+    for (bool hello : { true, false }) {
+        for (bool bulk : { false, true }) {
+            Result r = RunOnce(server, pipeName, hello, bulk);
+            std::printf("%-8s %-10s %10zu %10llu %10llu %10llu\n", hello ? "hello" : "legacy", bulk ? "with bulk" : "small only",
+                r.received, static_cast<unsigned long long>(r.p50Us), static_cast<unsigned long long>(r.p99Us),
+                static_cast<unsigned long long>(r.maxUs));
+        }
+    }
+
+    PipeServerStats stats = server.GetStats();
+    std::printf("server: smallP99Us=%llu smallP99UsUnderBulk=%llu fragmentsSent=%llu\n",
+        static_cast<unsigned long long>(stats.smallP99Us), static_cast<unsigned long long>(stats.smallP99UsUnderBulk),
+        static_cast<unsigned long long>(stats.fragmentsSent));
+    server.Stop();
+    return 0;
+}
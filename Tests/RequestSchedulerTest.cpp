@@ -0,0 +1,100 @@
+// RequestScheduler  Deadline 
+// -  deadline ʣʱԶ urgent ֮󣬽 urgent ֮ǰ
+// - EDFֹʱȳͬʱ˳򣻵ȵþõͨŵ urgent ֮ǰϻ
+// - timeoutMs  deadline ͬʱȡ
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../TestClient/Service/RequestScheduler.h"
+#include "../TestClient/Service/Envelope.h"
+#include "TestCheck.h"
+
+//  ServiceManager ͬʱʱʱŷ deadline
+static PipeMessage Request(const std::string& clientId, const std::string& msgId, const std::string& extra,
+    uint64_t timestampMs, uint64_t receivedUs)
+{
+    std::string text = R"({"type":"Request","msgId":")" + msgId + "\"" + extra + "}";
+    PipeMessage msg;
+    msg.clientId = clientId;
+    msg.payload.assign(text.begin(), text.end());
+    msg.timestampMs = timestampMs;
+    msg.receivedUs = receivedUs;
+    msg.deadlineMs = ReadDeadline(msg.payload, msg.timestampMs);
+    return msg;
+}
+
+static std::string MsgId(const PipeMessage& msg)
+{
+    std::string_view raw;
+    CHECK(FindEnvelopeField(AsText(msg.payload), "msgId", raw));
+    return std::string(raw.substr(1, raw.size() - 2));
+}
+
+static std::vector<std::string> Drain(RequestScheduler& scheduler)
+{
+    std::vector<std::string> order;
+    PipeMessage msg;
+    while (scheduler.Pop(msg)) {
+        order.push_back(MsgId(msg));
+    }
+    return order;
+}
+
+static SchedulerConfig DeadlineConfig()
+{
+    SchedulerConfig config;
+    config.policy = SchedulePolicy::Deadline;
+    config.urgentSlackUs = 20'000;
+    config.normalSlackUs = 1'000'000;
+    return config;
+}
+
+//  deadline ʱͬһԪ500ms ڵӦŵ 20ms  urgent ǰ
+static void TestAbsoluteDeadlinePosition()
+{
+    RequestScheduler scheduler(DeadlineConfig());
+    uint64_t nowMs = UtcNowMs();
+    uint64_t nowUs = SteadyNowUs();
+
+    scheduler.Push(Request("A", "normal", "", nowMs, nowUs));
+    scheduler.Push(Request("A", "far", R"(,"deadline":)" + std::to_string(nowMs + 500), nowMs, nowUs));
+    scheduler.Push(Request("B", "urgent", R"(,"flags":{"urgent":true})", nowMs, nowUs));
+    scheduler.Push(Request("C", "near", R"(,"deadline":)" + std::to_string(nowMs + 5), nowMs, nowUs));
+
+    CHECK((Drain(scheduler) == std::vector<std::string>{ "near", "urgent", "far", "normal" }));
+}
+
+static void TestEdfOrdering()
+{
+    RequestScheduler scheduler(DeadlineConfig());
+    uint64_t nowMs = UtcNowMs();
+    uint64_t t0 = SteadyNowUs();
+
+    // ͬһʱ̵urgent+20ms< timeoutMs 50 < normal+1sͬఴ˳
+    scheduler.Push(Request("A", "normal-1", "", nowMs, t0));
+    scheduler.Push(Request("B", "timeout-50", R"(,"timeoutMs":50)", nowMs, t0));
+    scheduler.Push(Request("A", "normal-2", "", nowMs, t0));
+    scheduler.Push(Request("C", "urgent-1", R"(,"flags":{"urgent":true})", nowMs, t0));
+    scheduler.Push(Request("C", "urgent-2", R"(,"flags":{"urgent":true})", nowMs, t0));
+    // ߶ʱȡߣtimeoutMs 10  deadline +500ms 
+    scheduler.Push(Request("D", "both", R"(,"deadline":)" + std::to_string(nowMs + 500) + R"(,"timeoutMs":10)", nowMs, t0));
+
+    CHECK((Drain(scheduler) == std::vector<std::string>{ "both", "urgent-1", "urgent-2", "timeout-50", "normal-1", "normal-2" }));
+
+    // ϻ2 ǰͨ󣨽ֹ 1 ǰڸյ urgent ֮ǰ
+    scheduler.Push(Request("C", "urgent-new", R"(,"flags":{"urgent":true})", nowMs, t0));
+    scheduler.Push(Request("A", "normal-old", "", nowMs - 2'000, t0 - 2'000'000));
+    CHECK((Drain(scheduler) == std::vector<std::string>{ "normal-old", "urgent-new" }));
+
+    SchedulerStats stats = scheduler.GetStats();
+    CHECK(stats.queued == 0);
+    CHECK(stats.dispatched == 8);
+}
+
+int main()
+{
+    TestAbsoluteDeadlinePosition();
+    TestEdfOrdering();
+    std::printf("OK\n");
+    return 0;
+}
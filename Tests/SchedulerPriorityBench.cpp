@@ -0,0 +1,159 @@
+// RequestScheduler ȼŶʱ䣺DeadlineEDF FairShareDRRԱ
+// - ɢ¼ģ⣨ģʱӣִЭ ServiceManager ͬԼΪ LOAD_PERCENT%
+// - ͻ˸һbulk ͨrpc  timeoutMs ui  urgent 󣬵Ϊֲָ
+// - Ŷ p50 / p99Լ rpc 󳬹 timeoutMs Ŵı
+//   scheduler_priority_bench [simulated seconds] [seed]
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "../TestClient/Service/RequestScheduler.h"
+#include "../TestClient/Service/Envelope.h"
+#include "TestCheck.h"
+
+static constexpr size_t   WORKERS = 4;
+static constexpr uint64_t HANDLER_US = 200;
+static constexpr uint64_t LOAD_PERCENT = 95;
+static constexpr uint64_t RPC_TIMEOUT_MS = 5;
+
+struct Source
+{
+    const char*              clientId;
+    RequestClass             cls;
+    uint64_t                 sharePercent;              // ռܵʵı
+    std::string              envelope;
+};
+
+static const std::array<Source, 3> SOURCES = { {
+    { "bulk", RequestClass::Normal, 75, R"({"type":"Request","msgId":"b"})" },
+    { "rpc", RequestClass::Deadline, 20, R"({"type":"Request","msgId":"r","timeoutMs":)" + std::to_string(RPC_TIMEOUT_MS) + "}" },
+    { "ui", RequestClass::Urgent, 5, R"({"type":"Request","msgId":"u","flags":{"urgent":true}})" },
+} };
+
+struct Result
+{
+    std::array<std::vector<uint64_t>, static_cast<size_t>(RequestClass::Count)> waitUs;
+    size_t                   rpcLate = 0;
+};
+
+static Result Simulate(SchedulePolicy policy, uint64_t durationUs, uint64_t seed)
+{
+    SchedulerConfig config;
+    config.policy = policy;
+    RequestScheduler scheduler(config);
+    scheduler.SetMaxRunners(WORKERS);
+
+    struct Event
+    {
+        uint64_t             timeUs = 0;
+        uint64_t             seq = 0;
+        int                  source = -1;               // >= 0 ΪΪ
+        std::string          clientId;
+        bool operator>(const Event& other) const { return timeUs != other.timeUs ? timeUs > other.timeUs : seq > other.seq; }
+    };
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    uint64_t seq = 0;
+
+    // ܵ =  * LOAD_PERCENT% sharePercent ָͻ
+    double capacityPerUs = static_cast<double>(WORKERS) / static_cast<double>(HANDLER_US);
+    std::mt19937_64 rng(seed);
+    auto arrive = [&](int source, uint64_t after) {
+        double rate = capacityPerUs * LOAD_PERCENT / 100.0 * SOURCES[source].sharePercent / 100.0;
+        std::exponential_distribution<double> gap(rate);
+        events.push({ after + static_cast<uint64_t>(gap(rng)), seq++, source, SOURCES[source].clientId });
+    };
+    for (int i = 0; i < static_cast<int>(SOURCES.size()); ++i) {
+        arrive(i, 0);
+    }
+
+    Result result;
+    uint64_t now = 0;
+    auto run = [&]() {
+        PipeMessage msg;
+        if (!scheduler.Pop(msg))
+            return;
+        uint64_t wait = now - msg.receivedUs;
+        for (const Source& s : SOURCES) {
+            if (msg.clientId == s.clientId) {
+                result.waitUs[static_cast<size_t>(s.cls)].push_back(wait);
+            }
+        }
+        if (msg.deadlineMs != 0 && wait + HANDLER_US > RPC_TIMEOUT_MS * 1000) {
+            result.rpcLate++;
+        }
+        events.push({ now + HANDLER_US, seq++, -1, msg.clientId });
+    };
+
+    while (!events.empty() && events.top().timeUs < durationUs) {
+        Event e = events.top();
+        events.pop();
+        now = e.timeUs;
+
+        if (e.source >= 0) {
+            const std::string& text = SOURCES[e.source].envelope;
+            PipeMessage msg;
+            msg.clientId = e.clientId;
+            msg.payload.assign(text.begin(), text.end());
+            msg.timestampMs = now / 1000;
+            msg.receivedUs = now;
+            msg.deadlineMs = ReadDeadline(msg.payload, msg.timestampMs);
+            if (scheduler.Push(std::move(msg))) {
+                run();
+            }
+            arrive(e.source, now);
+            continue;
+        }
+
+        scheduler.Complete(e.clientId, HANDLER_US);
+        run();
+    }
+    return result;
+}
+
+static uint64_t Percentile(std::vector<uint64_t> values, size_t p)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[(std::min)(values.size() - 1, values.size() * p / 100)];
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t durationUs = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20) * 1'000'000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20240601;
+
+    std::printf("%zu workers, %llu us per request, load %llu%%, rpc timeoutMs %llu\n", WORKERS,
+        static_cast<unsigned long long>(HANDLER_US), static_cast<unsigned long long>(LOAD_PERCENT),
+        static_cast<unsigned long long>(RPC_TIMEOUT_MS));
+    std::printf("%-10s %-8s %10s %10s %10s %10s\n", "policy", "class", "requests", "p50(us)", "p99(us)", "rpc late");
+
+    static const char* const CLASS_NAMES[] = { "urgent", "deadline", "normal" };
+    std::array<Result, 2> results;
+    const SchedulePolicy policies[] = { SchedulePolicy::FairShare, SchedulePolicy::Deadline };
+    for (size_t k = 0; k < 2; ++k) {
+        results[k] = Simulate(policies[k], durationUs, seed);
+        const Result& r = results[k];
+        for (size_t c = 0; c < static_cast<size_t>(RequestClass::Count); ++c) {
+            std::printf("%-10s %-8s %10zu %10llu %10llu", k == 0 ? "fairshare" : "deadline", CLASS_NAMES[c], r.waitUs[c].size(),
+                static_cast<unsigned long long>(Percentile(r.waitUs[c], 50)),
+                static_cast<unsigned long long>(Percentile(r.waitUs[c], 99)));
+            if (c == static_cast<size_t>(RequestClass::Deadline)) {
+                std::printf(" %9.2f%%", 100.0 * static_cast<double>(r.rpcLate) / static_cast<double>((std::max<size_t>)(r.waitUs[c].size(), 1)));
+            }
+            std::printf("\n");
+        }
+    }
+
+    // EDF  urgent ֹʱӦ DRR ȵø
+    size_t urgent = static_cast<size_t>(RequestClass::Urgent);
+    size_t deadline = static_cast<size_t>(RequestClass::Deadline);
+    CHECK(Percentile(results[1].waitUs[urgent], 99) <= Percentile(results[0].waitUs[urgent], 99));
+    CHECK(results[1].rpcLate <= results[0].rpcLate);
+    CHECK(Percentile(results[1].waitUs[deadline], 99) <= Percentile(results[0].waitUs[deadline], 99));
+    return 0;
+}
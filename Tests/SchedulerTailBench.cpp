@@ -0,0 +1,170 @@
+// RequestScheduler βӳٻ׼෢ͨͻ + һеļͻ
+// - ɢ¼ģ⣨ģʱӣִ߰ ServiceManager ķʽУPush  true ʱPop ʱ˳ Complete
+// - Աԭȵȫ FIFO̶߳У FairShareDRRͨͻ˵Ŷ p50 / p99 / maxԼͻ˵
+//   scheduler_tail_bench [simulated seconds]
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+#include "../TestClient/Service/RequestScheduler.h"
+#include "TestCheck.h"
+
+static constexpr size_t   WORKERS = 4;
+static constexpr uint64_t HANDLER_US = 200;
+static constexpr size_t   POLITE_CLIENTS = 8;
+static constexpr uint64_t POLITE_INTERVAL_US = 5'000;   // ÿͨͻ 200 /
+static constexpr size_t   AGGRESSIVE_OUTSTANDING = 256; // ͻʼձôδ
+
+static const std::string AGGRESSIVE = "aggressive";
+
+// ԭȵĵȣͬһ FIFOִЭ RequestScheduler ͬ
+class FifoQueue
+{
+public:
+    bool Push(PipeMessage msg)
+    {
+        m_queue.push_back(std::move(msg));
+        if (m_runners < WORKERS) {
+            m_runners++;
+            return true;
+        }
+        return false;
+    }
+
+    bool Pop(PipeMessage& msg)
+    {
+        if (m_queue.empty()) {
+            m_runners--;
+            return false;
+        }
+        msg = std::move(m_queue.front());
+        m_queue.pop_front();
+        return true;
+    }
+
+    void Complete(const std::string&, uint64_t) {}
+
+private:
+    std::deque<PipeMessage> m_queue;
+    size_t                  m_runners = 0;
+};
+
+struct Result
+{
+    std::vector<uint64_t>   politeWaitUs;
+    size_t                  aggressiveDone = 0;
+};
+
+template <typename Scheduler>
+static Result Simulate(Scheduler& scheduler, uint64_t durationUs)
+{
+    // ¼msg Чִߴ꣨clientId Ϊͻˣ
+    struct Event
+    {
+        uint64_t             timeUs = 0;
+        uint64_t             seq = 0;
+        bool                 arrival = false;
+        std::string          clientId;
+        bool operator>(const Event& other) const { return timeUs != other.timeUs ? timeUs > other.timeUs : seq > other.seq; }
+    };
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    uint64_t seq = 0;
+    auto schedule = [&](uint64_t timeUs, bool arrival, const std::string& clientId) {
+        events.push({ timeUs, seq++, arrival, clientId });
+    };
+
+    for (size_t i = 0; i < POLITE_CLIENTS; ++i) {
+        // ͻ˴λ
+        schedule(i * POLITE_INTERVAL_US / POLITE_CLIENTS, true, "polite-" + std::to_string(i));
+    }
+    for (size_t i = 0; i < AGGRESSIVE_OUTSTANDING; ++i) {
+        schedule(0, true, AGGRESSIVE);
+    }
+
+    Result result;
+    uint64_t now = 0;
+
+    // ִȡһ¼ûпɴʱִ˳
+    auto run = [&]() {
+        PipeMessage msg;
+        if (!scheduler.Pop(msg))
+            return;
+        if (msg.clientId != AGGRESSIVE && msg.receivedUs >= POLITE_INTERVAL_US) {
+            result.politeWaitUs.push_back(now - msg.receivedUs);
+        }
+        schedule(now + HANDLER_US, false, msg.clientId);
+    };
+
+    while (!events.empty() && events.top().timeUs < durationUs) {
+        Event e = events.top();
+        events.pop();
+        now = e.timeUs;
+
+        if (e.arrival) {
+            PipeMessage msg;
+            msg.clientId = e.clientId;
+            msg.payload.assign(128, ' ');
+            msg.timestampMs = now / 1000;
+            msg.receivedUs = now;
+            if (scheduler.Push(std::move(msg))) {
+                run();
+            }
+            if (e.clientId != AGGRESSIVE) {
+                schedule(now + POLITE_INTERVAL_US, true, e.clientId);
+            }
+            continue;
+        }
+
+        scheduler.Complete(e.clientId, HANDLER_US);
+        if (e.clientId == AGGRESSIVE) {
+            result.aggressiveDone++;
+            schedule(now, true, AGGRESSIVE);
+        }
+        run();
+    }
+    return result;
+}
+
+static uint64_t Percentile(std::vector<uint64_t> values, size_t p)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[(std::min)(values.size() - 1, values.size() * p / 100)];
+}
+
+static void Report(const char* name, const Result& r, uint64_t durationUs)
+{
+    std::printf("%-10s %10zu %10llu %10llu %10llu %14.0f\n", name, r.politeWaitUs.size(),
+        static_cast<unsigned long long>(Percentile(r.politeWaitUs, 50)),
+        static_cast<unsigned long long>(Percentile(r.politeWaitUs, 99)),
+        static_cast<unsigned long long>(Percentile(r.politeWaitUs, 100)),
+        static_cast<double>(r.aggressiveDone) * 1e6 / static_cast<double>(durationUs));
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t durationUs = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10) * 1'000'000;
+
+    std::printf("%zu workers, %llu us per request, %zu polite clients every %llu us, 1 aggressive client with %zu outstanding\n",
+        WORKERS, static_cast<unsigned long long>(HANDLER_US), POLITE_CLIENTS,
+        static_cast<unsigned long long>(POLITE_INTERVAL_US), AGGRESSIVE_OUTSTANDING);
+    std::printf("%-10s %10s %10s %10s %10s %14s\n", "scheduler", "polite", "p50(us)", "p99(us)", "max(us)", "aggressive/s");
+
+    FifoQueue fifo;
+    Result fifoResult = Simulate(fifo, durationUs);
+    Report("fifo", fifoResult, durationUs);
+
+    RequestScheduler fair;
+    fair.SetMaxRunners(WORKERS);
+    Result fairResult = Simulate(fair, durationUs);
+    Report("fairshare", fairResult, durationUs);
+
+    // ͻ˰ FIFO ʱͨͻѹ֮DRR ֻһ
+    CHECK(!fairResult.politeWaitUs.empty());
+    CHECK(Percentile(fairResult.politeWaitUs, 99) < Percentile(fifoResult.politeWaitUs, 99));
+    return 0;
+}
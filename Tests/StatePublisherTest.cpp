@@ -0,0 +1,203 @@
+// StatePublisherٷͺ¼ÿͻյ֡ͻ˰Э黹ԭ״̬
+// - յգ֮ÿӦõɿϣ뷢״̬ͬɾǶ׶顢ͱ仯
+// -  baseSeq 뱾 seq νӣ滻ʱķ
+// - ʧܵĶ߱Ƴ˲Ŀͻͬ׷
+// - ״ֶ̬α仯ʱÿηȫֽڶԱ
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../TestClient/Service/StatePublisher.h"
+#include "TestCheck.h"
+
+using json = nlohmann::json;
+
+// ٵĹܵ clientId ¼յ֡ݣoffline еĿͻ˷ʧ
+struct FakeServer
+{
+    std::shared_ptr<BufferPool> pool = BufferPool::Create();
+    std::map<std::string, std::vector<std::string>> frames;
+    std::map<std::string, bool> offline;
+    size_t bytes = 0;
+
+    StatePublisher::SendFunction Sender()
+    {
+        return [this](const std::string& clientId, const BufferLease& frame) {
+            if (offline[clientId])
+                return false;
+            CHECK(frame->IsSealed());
+            frames[clientId].emplace_back(reinterpret_cast<const char*>(frame->Data()), frame->Size());
+            bytes += frame->Size();
+            return true;
+        };
+    }
+};
+
+// ͻһֱࣺ滻Ҫ baseSeq νӺӦ
+struct Replica
+{
+    json     state;
+    uint64_t seq = 0;
+    bool     synced = false;
+    size_t   consumed = 0;
+    size_t   snapshots = 0;
+    size_t   patches = 0;
+
+    void Drain(const std::vector<std::string>& frames)
+    {
+        for (; consumed < frames.size(); ++consumed) {
+            json message = json::parse(frames[consumed]);
+            CHECK(message["type"] == "Notify");
+            const json& payload = message["payload"];
+            if (payload["kind"] == "snapshot") {
+                state = payload["state"];
+                seq = payload["seq"].get<uint64_t>();
+                synced = true;
+                snapshots++;
+                continue;
+            }
+            CHECK(payload["kind"] == "patch");
+            if (!synced || payload["baseSeq"].get<uint64_t>() != seq) {
+                synced = false;            // ˲ͬ
+                continue;
+            }
+            state = state.patch(payload["patch"]);
+            seq = payload["seq"].get<uint64_t>();
+            patches++;
+        }
+    }
+};
+
+static void TestPatchesReproduceState()
+{
+    FakeServer server;
+    StatePublisher publisher(server.pool, server.Sender());
+    Replica replica;
+
+    // ĴֶòСڿգ߲·
+    json info = json::object();
+    for (int i = 0; i < 50; ++i) {
+        info["field" + std::to_string(i)] = "value-" + std::to_string(i);
+    }
+    json state = { { "mode", "idle" }, { "level", 3 }, { "tags", { "a", "b" } }, { "net", { { "ip", "10.0.0.2" }, { "up", true } } } };
+    state["info"] = info;
+    publisher.Publish("device", state);
+    CHECK(publisher.Subscribe("CLI-001", "device"));
+    replica.Drain(server.frames["CLI-001"]);
+    CHECK(replica.state == state && replica.seq == 1);
+
+    std::vector<json> steps = {
+        { { "mode", "busy" }, { "level", 3 }, { "tags", { "a", "b" } }, { "net", { { "ip", "10.0.0.2" }, { "up", true } } } },
+        { { "mode", "busy" }, { "level", 4 }, { "tags", { "a", "b", "c" } }, { "net", { { "ip", "10.0.0.2" }, { "up", false } } } },
+        { { "mode", "busy" }, { "level", 4 }, { "tags", { "c" } }, { "net", { { "ip", "10.0.0.9" } } }, { "error", "E42" } },
+        { { "mode", "busy" }, { "level", "high" }, { "tags", json::array() }, { "net", nullptr }, { "error", "E42" } },
+        { { "mode", "busy~/x" }, { "level", "high" }, { "a/b", { { "~", 1 } } }, { "tags", json::array() }, { "net", nullptr } },
+    };
+    for (json& next : steps) {
+        next["info"] = info;
+    }
+    for (const json& next : steps) {
+        uint64_t seq = publisher.Publish("device", next);
+        replica.Drain(server.frames["CLI-001"]);
+        CHECK(replica.synced);
+        CHECK(replica.seq == seq);
+        CHECK(replica.state == next);
+    }
+    CHECK(replica.patches == steps.size());
+
+    // ͬ״̬
+    size_t before = server.frames["CLI-001"].size();
+    CHECK(publisher.Publish("device", steps.back()) == replica.seq);
+    CHECK(server.frames["CLI-001"].size() == before);
+
+    // 滻ɸ״̬յһ룬ķ
+    json replaced = json::object();
+    for (int i = 0; i < 100; ++i) {
+        replaced["other" + std::to_string(i)] = i;
+    }
+    publisher.Publish("device", replaced);
+    replica.Drain(server.frames["CLI-001"]);
+    CHECK(replica.state == replaced);
+    CHECK(replica.snapshots == 2);
+}
+
+static void TestDisconnectAndResync()
+{
+    FakeServer server;
+    StatePublisher publisher(server.pool, server.Sender());
+    json state = json::object();
+    for (int i = 0; i < 100; ++i) {
+        state["key-" + std::to_string(i)] = i;
+    }
+    publisher.Publish("t", state);
+    CHECK(publisher.Subscribe("A", "t"));
+    CHECK(publisher.Subscribe("B", "t"));
+
+    // B ϿʧܺǶ
+    server.offline["B"] = true;
+    state["key-0"] = 100;
+    publisher.Publish("t", state);
+    server.offline["B"] = false;
+    state["key-1"] = 101;
+    publisher.Publish("t", state);
+    CHECK(server.frames["B"].size() == 1);
+
+    // A һ֮Ĳ baseSeq Բϣͬ׷
+    Replica a;
+    server.frames["A"].erase(server.frames["A"].begin() + 1);
+    a.Drain(server.frames["A"]);
+    CHECK(!a.synced);
+    CHECK(publisher.Resync("A", "t"));
+    a.Drain(server.frames["A"]);
+    CHECK(a.synced && a.state == state && a.seq == publisher.Seq("t"));
+}
+
+// 200 ̨豸״̬ÿθ¸ 1~3 ֶ
+static void ReportBandwidth()
+{
+    FakeServer server;
+    StatePublisher publisher(server.pool, server.Sender());
+    Replica replica;
+
+    json state = json::object();
+    for (int i = 0; i < 200; ++i) {
+        state["dev-" + std::to_string(i)] = { { "online", true }, { "temp", 40 }, { "load", 0.25 }, { "fw", "1.2.3" } };
+    }
+    publisher.Publish("devices", state);
+    CHECK(publisher.Subscribe("CLI-001", "devices"));
+
+    size_t fullBytes = 0;
+    size_t updates = 500;
+    for (size_t u = 0; u < updates; ++u) {
+        json& dev = state["dev-" + std::to_string(u * 7 % 200)];
+        dev["temp"] = 40 + static_cast<int>(u % 30);
+        if (u % 3 == 0)
+            dev["load"] = static_cast<double>(u % 100) / 100.0;
+        if (u % 5 == 0)
+            dev["online"] = u % 10 != 0;
+        publisher.Publish("devices", state);
+        fullBytes += json({ { "type", "Notify" },
+            { "payload", { { "topic", "devices" }, { "kind", "snapshot" }, { "seq", publisher.Seq("devices") }, { "state", state } } } })
+            .dump().size();
+    }
+    replica.Drain(server.frames["CLI-001"]);
+    CHECK(replica.state == state);
+
+    StatePublisherStats stats = publisher.GetStats();
+    size_t sentBytes = server.bytes - server.frames["CLI-001"].front().size();
+    std::printf("%zu updates: patches %zu bytes, snapshots every time %zu bytes (%.1f%% of full); stats saved %.1f%%\n",
+        updates, sentBytes, fullBytes, 100.0 * static_cast<double>(sentBytes) / static_cast<double>(fullBytes),
+        100.0 * stats.SavedRatio());
+    CHECK(stats.patches == updates);
+    CHECK(sentBytes * 10 < fullBytes);
+}
+
+int main()
+{
+    TestPatchesReproduceState();
+    TestDisconnectAndResync();
+    ReportBandwidth();
+    std::printf("OK\n");
+    return 0;
+}
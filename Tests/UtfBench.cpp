@@ -0,0 +1,105 @@
+// Common::Utf »׼ĲοʵֶԱȣMB/sֽڼƣ
+// - ascii͵Ӣ JSON Ϣ
+// - mixedֵֶĵ JSONԼɷ ASCII ֽڣ
+// - cjkı
+// ͬһԴ밴 AVX2 / SSE2 / ֱ루utf_benchutf_bench_avx2utf_bench_scalarԱȸ·
+//   utf_bench [megabytes per case]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../TestClient/Common/Utf.h"
+#include "UtfReference.h"
+
+namespace Utf = Common::Utf;
+
+static const char* PathName()
+{
+#if defined(COMMON_UTF_SCALAR)
+    return "scalar (COMMON_UTF_SCALAR)";
+#elif defined(COMMON_UTF_AVX2)
+    return "avx2";
+#elif defined(COMMON_UTF_SSE2)
+    return "sse2";
+#else
+    return "scalar (no SIMD)";
+#endif
+}
+
+static std::string MakeInput(const char* kind, size_t size)
+{
+    static const std::string CJK = "\xE6\xB6\x88\xE6\x81\xAF\xE5\xB7\xB2\xE9\x80\x81\xE8\xBE\xBE";   // Ϣʹ
+    std::string out;
+    size_t seq = 0;
+    while (out.size() < size) {
+        std::string n = std::to_string(seq++);
+        if (std::string(kind) == "ascii") {
+            out += R"({"ver":"1.0","type":"Notify","msgId":)" + n + R"(,"payload":{"event":"progress","value":)" + n + "}}";
+        }
+        else if (std::string(kind) == "mixed") {
+            out += R"({"ver":"1.0","type":"Notify","msgId":)" + n + R"(,"payload":{"text":")" + CJK + CJK + R"("}})";
+        }
+        else {
+            out += CJK;
+        }
+    }
+    return out;
+}
+
+template <typename F>
+static double MegabytesPerSecond(size_t bytesPerRun, size_t totalBytes, F&& run)
+{
+    size_t runs = totalBytes / bytesPerRun + 1;
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < runs; ++k)
+        run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(bytesPerRun) * static_cast<double>(runs) / seconds / (1024.0 * 1024.0);
+}
+
+int main(int argc, char** argv)
+{
+    size_t total = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256) * 1024 * 1024;
+    static constexpr size_t MESSAGE_SIZE = 64 * 1024;
+
+    std::printf("path: %s\n", PathName());
+    std::printf("%-6s %-12s %12s %12s %8s\n", "input", "op", "utf (MB/s)", "ref (MB/s)", "speedup");
+
+    volatile size_t sink = 0;
+    for (const char* kind : { "ascii", "mixed", "cjk" }) {
+        std::string utf8 = MakeInput(kind, MESSAGE_SIZE);
+        std::u16string utf16;
+        UtfReference::Utf8ToUtf16(reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size(), utf16);
+
+        std::vector<char16_t> wide(Utf::MaxUtf16Length(utf8.size()));
+        std::vector<char> narrow(Utf::MaxUtf8Length(utf16.size()));
+        std::u16string refWide;
+        std::string refNarrow;
+
+        auto report = [&](const char* op, double fast, double ref) {
+            std::printf("%-6s %-12s %12.0f %12.0f %7.1fx\n", kind, op, fast, ref, fast / ref);
+        };
+
+        report("utf8->utf16",
+            MegabytesPerSecond(utf8.size(), total, [&] { sink = sink + Utf::Utf8ToUtf16(utf8.data(), utf8.size(), wide.data()); }),
+            MegabytesPerSecond(utf8.size(), total, [&] {
+                UtfReference::Utf8ToUtf16(reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size(), refWide);
+                sink = sink + refWide.size();
+                }));
+        report("validate",
+            MegabytesPerSecond(utf8.size(), total, [&] { sink = sink + Utf::IsValidUtf8(utf8.data(), utf8.size()); }),
+            MegabytesPerSecond(utf8.size(), total, [&] {
+                sink = sink + UtfReference::Utf8ToUtf16(reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size(), refWide);
+                }));
+        // UTF-16 ͬ UTF-8 ֽƣȽ
+        report("utf16->utf8",
+            MegabytesPerSecond(utf8.size(), total, [&] { sink = sink + Utf::Utf16ToUtf8(utf16.data(), utf16.size(), narrow.data()); }),
+            MegabytesPerSecond(utf8.size(), total, [&] {
+                UtfReference::Utf16ToUtf8(utf16.data(), utf16.size(), refNarrow);
+                sink = sink + refNarrow.size();
+                }));
+    }
+    return 0;
+}
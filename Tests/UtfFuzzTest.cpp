@@ -0,0 +1,263 @@
+// Common::Utf ģԣĲοʵֽڶ
+// - ƴ ASCII ΡȵĺϷ㡢 / ض /  /  / ΧУдֽ
+// -  ASCII Ԫ ASCII εÿλáʼַ 0~3 SIMD ߽β
+// - Ŀ껺尴 MaxUtf8Length / MaxUtf16Length 䣬βڱԽд
+// ͬһԴ밴 AVX2 / SSE2 / COMMON_UTF_SCALAR-mno-sse2ֱУ CMakeLists.txt
+//   utf_fuzz_test [iterations] [seed]
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../TestClient/Common/Utf.h"
+#include "UtfReference.h"
+#include "TestCheck.h"
+
+namespace Utf = Common::Utf;
+
+static constexpr uint8_t GUARD = 0xA5;
+static constexpr size_t GUARD_SIZE = 64;
+
+static const char* PathName()
+{
+#if defined(COMMON_UTF_SCALAR)
+    return "scalar (COMMON_UTF_SCALAR)";
+#elif defined(COMMON_UTF_AVX2)
+    return "avx2";
+#elif defined(COMMON_UTF_SSE2)
+    return "sse2";
+#else
+    return "scalar (no SIMD)";
+#endif
+}
+
+// ʼƫ offset Ƶ»壬Ƕȡ
+static void CheckUtf8(const std::string& input, size_t offset)
+{
+    std::vector<char> src(offset + input.size());
+    std::copy(input.begin(), input.end(), src.begin() + offset);
+    const char* p = src.data() + offset;
+
+    std::u16string expected;
+    bool valid = UtfReference::Utf8ToUtf16(reinterpret_cast<const uint8_t*>(input.data()), input.size(), expected);
+
+    std::vector<char16_t> dst(Utf::MaxUtf16Length(input.size()) + GUARD_SIZE, static_cast<char16_t>(GUARD));
+    size_t n = Utf::Utf8ToUtf16(p, input.size(), dst.data());
+    CHECK(Utf::IsValidUtf8(p, input.size()) == valid);
+    if (!valid) {
+        CHECK(n == Utf::INVALID);
+    }
+    else {
+        CHECK(n == expected.size());
+        CHECK(std::u16string(dst.data(), n) == expected);
+    }
+    for (size_t k = Utf::MaxUtf16Length(input.size()); k < dst.size(); ++k)
+        CHECK(dst[k] == GUARD);
+}
+
+static void CheckUtf16(const std::u16string& input, size_t offset)
+{
+    std::vector<char16_t> src(offset + input.size());
+    std::copy(input.begin(), input.end(), src.begin() + offset);
+    const char16_t* p = src.data() + offset;
+
+    std::string expected;
+    bool valid = UtfReference::Utf16ToUtf8(input.data(), input.size(), expected);
+
+    std::vector<char> dst(Utf::MaxUtf8Length(input.size()) + GUARD_SIZE, static_cast<char>(GUARD));
+    size_t n = Utf::Utf16ToUtf8(p, input.size(), dst.data());
+    if (!valid) {
+        CHECK(n == Utf::INVALID);
+    }
+    else {
+        CHECK(n == expected.size());
+        CHECK(std::string(dst.data(), n) == expected);
+    }
+    for (size_t k = Utf::MaxUtf8Length(input.size()); k < dst.size(); ++k)
+        CHECK(static_cast<uint8_t>(dst[k]) == GUARD);
+}
+
+class Generator
+{
+public:
+    explicit Generator(uint64_t seed) : m_rng(seed) {}
+
+    size_t Below(size_t n) { return static_cast<size_t>(m_rng() % n); }
+
+    uint32_t CodePoint()
+    {
+        switch (Below(6)) {
+        case 0: return static_cast<uint32_t>(0x80 + Below(0x800 - 0x80));
+        case 1: return static_cast<uint32_t>(0x800 + Below(0xD800 - 0x800));
+        case 2: return static_cast<uint32_t>(0xE000 + Below(0x10000 - 0xE000));
+        case 3: return static_cast<uint32_t>(0x10000 + Below(0x110000 - 0x10000));
+        case 4: return static_cast<uint32_t>(0x4E00 + Below(0x9FA5 - 0x4E00));      // ú
+        default: {
+            static constexpr uint32_t EDGES[] = { 0x7F, 0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0xFFFD, 0xFFFF, 0x10000, 0x10FFFF };
+            return EDGES[Below(sizeof(EDGES) / sizeof(EDGES[0]))];
+        }
+        }
+    }
+
+    std::string Utf8()
+    {
+        static const char* const BAD[] = {
+            "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+            "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF8\x88\x80\x80\x80",
+            "\xFE", "\xFF", "\xC3", "\xE4\xB8", "\xF0\x9F\x98", "\xC3\x28", "\xE4\x28\xAD",
+        };
+
+        std::string out;
+        size_t pieces = Below(12);
+        for (size_t k = 0; k < pieces; ++k) {
+            switch (Below(8)) {
+            case 0:
+            case 1:
+            case 2:
+                out.append(Below(70), static_cast<char>(' ' + Below(95)));
+                break;
+            case 3:
+            case 4:
+            case 5:
+                UtfReference::AppendUtf8(out, CodePoint());
+                break;
+            case 6:
+                out += BAD[Below(sizeof(BAD) / sizeof(BAD[0]))];
+                break;
+            default:
+                out.push_back(static_cast<char>(Below(256)));
+                break;
+            }
+        }
+        Mutate(out);
+        return out;
+    }
+
+    std::u16string Utf16()
+    {
+        std::u16string out;
+        size_t pieces = Below(12);
+        for (size_t k = 0; k < pieces; ++k) {
+            switch (Below(8)) {
+            case 0:
+            case 1:
+            case 2:
+                out.append(Below(70), static_cast<char16_t>(' ' + Below(95)));
+                break;
+            case 3:
+            case 4:
+                out.push_back(static_cast<char16_t>(0x80 + Below(0xD800 - 0x80)));
+                break;
+            case 5: {
+                uint32_t cp = static_cast<uint32_t>(0x10000 + Below(0x100000));
+                out.push_back(static_cast<char16_t>(0xD800 | ((cp - 0x10000) >> 10)));
+                out.push_back(static_cast<char16_t>(0xDC00 | ((cp - 0x10000) & 0x3FF)));
+                break;
+            }
+            case 6:
+                out.push_back(static_cast<char16_t>(0xD800 + Below(0x800)));        // 
+                break;
+            default:
+                out.push_back(static_cast<char16_t>(Below(0x10000)));
+                break;
+            }
+        }
+        if (!out.empty() && Below(8) == 0) {
+            out[Below(out.size())] = static_cast<char16_t>(Below(0x10000));
+        }
+        return out;
+    }
+
+private:
+    void Mutate(std::string& s)
+    {
+        if (s.empty() || Below(4) != 0)
+            return;
+        size_t edits = 1 + Below(3);
+        for (size_t k = 0; k < edits; ++k) {
+            s[Below(s.size())] = static_cast<char>(Below(256));
+        }
+    }
+
+private:
+    std::mt19937_64 m_rng;
+};
+
+//  ASCII Ԫ ASCII εÿλã 8 / 16 / 32 ߽ǰ
+static void SweepBoundaries()
+{
+    static const char* const UTF8_UNITS[] = { "\xC3\xA9", "\xE4\xBD\xA0", "\xF0\x9F\x98\x80", "\x80", "\xE4\xBD", "\xED\xA0\x80" };
+    static const std::u16string UTF16_UNITS[] = { u"\u00E9", u"\u4F60", u"\U0001F600", std::u16string(1, 0xD800), std::u16string(1, 0xDC00),
+        std::u16string{ 0xDC00, 0xD800 } };
+
+    for (size_t len = 0; len <= 80; ++len) {
+        for (size_t pos = 0; pos <= len; ++pos) {
+            for (const char* unit : UTF8_UNITS) {
+                std::string s(len, 'a');
+                s.insert(pos, unit);
+                for (size_t offset = 0; offset < 4; ++offset)
+                    CheckUtf8(s, offset);
+            }
+            for (const std::u16string& unit : UTF16_UNITS) {
+                std::u16string s(len, u'a');
+                s.insert(pos, unit);
+                for (size_t offset = 0; offset < 4; ++offset)
+                    CheckUtf16(s, offset);
+            }
+        }
+        CheckUtf8(std::string(len, 'a'), 1);
+        CheckUtf16(std::u16string(len, u'a'), 1);
+    }
+
+    // 0x80 ϡᱻзűʹ 0 / 0xFF ĵԪ
+    for (char16_t c : { char16_t(0x80), char16_t(0xFF), char16_t(0x100), char16_t(0x7FFF), char16_t(0x8000), char16_t(0xFFFF) }) {
+        for (size_t pos = 0; pos < 40; ++pos) {
+            std::u16string s(40, u'a');
+            s[pos] = c;
+            CheckUtf16(s, 0);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+#if defined(COMMON_UTF_AVX2) && !defined(COMMON_UTF_SCALAR) && defined(__GNUC__)
+    // AVX2 汾ڲֵ֧ CPU ctest  SKIP_RETURN_CODE
+    if (!__builtin_cpu_supports("avx2")) {
+        std::printf("SKIP: cpu has no avx2\n");
+        return 77;
+    }
+#endif
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20240601;
+    std::printf("path: %s, iterations: %zu, seed: %llu\n", PathName(), iterations, static_cast<unsigned long long>(seed));
+
+    SweepBoundaries();
+
+    Generator gen(seed);
+    size_t valid8 = 0, valid16 = 0;
+    for (size_t k = 0; k < iterations; ++k) {
+        std::string s = gen.Utf8();
+        CheckUtf8(s, gen.Below(4));
+        std::u16string expected;
+        if (UtfReference::Utf8ToUtf16(reinterpret_cast<const uint8_t*>(s.data()), s.size(), expected)) {
+            valid8++;
+            // Ϸһ
+            CheckUtf16(expected, 0);
+        }
+
+        std::u16string w = gen.Utf16();
+        CheckUtf16(w, gen.Below(4));
+        std::string narrow;
+        if (UtfReference::Utf16ToUtf8(w.data(), w.size(), narrow)) {
+            valid16++;
+            CheckUtf8(narrow, 0);
+        }
+    }
+
+    // 붼Ҫ㹻ĺϷ / Ƿģʧȥ
+    CHECK(iterations == 0 || (valid8 > iterations / 10 && valid8 < iterations * 9 / 10));
+    CHECK(iterations == 0 || (valid16 > iterations / 10 && valid16 < iterations * 9 / 10));
+    std::printf("OK (valid utf8 %zu, valid utf16 %zu)\n", valid8, valid16);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ==============================
+// Ĳοʵ֣ Common::Utf д޹أֻ Unicode жϣģ׼
+// - UTF-8ֽڶȣٽ㣬鳬롢 U+10FFFF
+// - UTF-16ĸ / ʹΪǷ
+// Ƿ뷵 false
+// ==============================
+namespace UtfReference
+{
+    inline bool Utf8ToUtf16(const uint8_t* src, size_t len, std::u16string& out)
+    {
+        static constexpr uint32_t MIN_CODE_POINT[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+        out.clear();
+        size_t i = 0;
+        while (i < len) {
+            uint8_t b0 = src[i];
+            size_t n;
+            uint32_t cp;
+            if (b0 < 0x80) {
+                n = 1;
+                cp = b0;
+            }
+            else if ((b0 & 0xE0) == 0xC0) {
+                n = 2;
+                cp = b0 & 0x1F;
+            }
+            else if ((b0 & 0xF0) == 0xE0) {
+                n = 3;
+                cp = b0 & 0x0F;
+            }
+            else if ((b0 & 0xF8) == 0xF0) {
+                n = 4;
+                cp = b0 & 0x07;
+            }
+            else {
+                return false;
+            }
+
+            if (len - i < n)
+                return false;
+            for (size_t k = 1; k < n; ++k) {
+                if ((src[i + k] & 0xC0) != 0x80)
+                    return false;
+                cp = (cp << 6) | (src[i + k] & 0x3F);
+            }
+            if (cp < MIN_CODE_POINT[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+                return false;
+
+            if (cp >= 0x10000) {
+                cp -= 0x10000;
+                out.push_back(static_cast<char16_t>(0xD800 | (cp >> 10)));
+                out.push_back(static_cast<char16_t>(0xDC00 | (cp & 0x3FF)));
+            }
+            else {
+                out.push_back(static_cast<char16_t>(cp));
+            }
+            i += n;
+        }
+        return true;
+    }
+
+    inline bool Utf16ToUtf8(const char16_t* src, size_t len, std::string& out)
+    {
+        out.clear();
+        for (size_t i = 0; i < len; ++i) {
+            uint32_t cp = src[i];
+            if (cp >= 0xDC00 && cp <= 0xDFFF)
+                return false;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                if (i + 1 >= len || src[i + 1] < 0xDC00 || src[i + 1] > 0xDFFF)
+                    return false;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (src[i + 1] - 0xDC00);
+                ++i;
+            }
+
+            if (cp < 0x80) {
+                out.push_back(static_cast<char>(cp));
+            }
+            else if (cp < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else if (cp < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+        return true;
+    }
+
+    // Ϊ UTF-8÷֤ǺϷ㣩ɲ
+    inline void AppendUtf8(std::string& out, uint32_t cp)
+    {
+        char16_t units[2];
+        size_t n = 0;
+        if (cp >= 0x10000) {
+            units[n++] = static_cast<char16_t>(0xD800 | ((cp - 0x10000) >> 10));
+            units[n++] = static_cast<char16_t>(0xDC00 | ((cp - 0x10000) & 0x3FF));
+        }
+        else {
+            units[n++] = static_cast<char16_t>(cp);
+        }
+        std::string encoded;
+        Utf16ToUtf8(units, n, encoded);
+        out += encoded;
+    }
+}
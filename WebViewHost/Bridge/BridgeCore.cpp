@@ -0,0 +1,467 @@
+#include "BridgeCore.h"
+#include "../../TestClient/Common/Utf.h"
+#include <algorithm>
+
+BridgeCore::BridgeCore(IBridgeTransport& transport, IUiSink& sink, FrameBatcherConfig batching)
+    : m_transport(transport)
+    , m_sink(sink)
+    , m_batcher(std::move(batching), &BridgeCore::NowNs)
+{
+    m_transport.SetGreeting([this](std::vector<uint8_t>& frames) { Greet(frames); });
+}
+
+BridgeCore::~BridgeCore()
+{
+    Stop();
+}
+
+void BridgeCore::Start()
+{
+    if (m_running.exchange(true))
+        return;
+    m_writer = std::thread(&BridgeCore::WriterLoop, this);
+    m_reader = std::thread(&BridgeCore::ReaderLoop, this);
+    m_flusher = std::thread(&BridgeCore::FlusherLoop, this);
+}
+
+void BridgeCore::Stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    m_sendCv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+    }
+    m_batchCv.notify_all();
+    m_transport.Cancel();
+    if (m_writer.joinable())
+        m_writer.join();
+    if (m_reader.joinable())
+        m_reader.join();
+    if (m_flusher.joinable())
+        m_flusher.join();
+
+    // δ͵Ϣдͷŵ÷ַ
+    std::deque<Outbound> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        pending.swap(m_sendQueue);
+    }
+    for (const Outbound& item : pending) {
+        if (item.release)
+            item.release(item.context);
+    }
+}
+
+void BridgeCore::Submit(const char16_t* text, size_t length, ReleaseFn release, void* context)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_sendQueue.push_back({ text, length, release, context });
+    }
+    m_sendCv.notify_one();
+}
+
+BridgeStats BridgeCore::GetStats() const
+{
+    BridgeStats stats;
+    stats.inbound = m_inbound.load(std::memory_order_relaxed);
+    stats.batches = m_batches.load(std::memory_order_relaxed);
+    stats.outbound = m_outbound.load(std::memory_order_relaxed);
+    stats.writes = m_writes.load(std::memory_order_relaxed);
+    stats.invalidText = m_invalidText.load(std::memory_order_relaxed);
+    stats.badFrames = m_badFrames.load(std::memory_order_relaxed);
+    stats.resumes = m_resumes.load(std::memory_order_relaxed);
+    stats.rebinds = m_rebinds.load(std::memory_order_relaxed);
+    stats.writeFailures = m_writeFailures.load(std::memory_order_relaxed);
+    stats.postFailures = m_postFailures.load(std::memory_order_relaxed);
+    stats.uiP50Ns = m_uiNs.Percentile(50);
+    stats.uiP99Ns = m_uiNs.Percentile(99);
+    stats.queueP50Ns = m_queueNs.Percentile(50);
+    stats.queueP99Ns = m_queueNs.Percentile(99);
+    return stats;
+}
+
+// д̣߳һȡ߶еȫϢUTF-16 ֱתػ岢֡
+// С֡ƴͬһ黺һдٹܵд
+void BridgeCore::WriterLoop()
+{
+    std::deque<Outbound> pending;
+    std::vector<uint8_t> gather;
+    std::vector<BufferLease> gathered;  // gather еϢдطŻ
+
+    auto flush = [&] {
+        if (gather.empty())
+            return;
+        bool ok = m_transport.Write(gather.data(), gather.size());
+        CountWrite(ok, gathered.size());
+        if (ok) {
+            for (const BufferLease& message : gathered) {
+                RecordSent(message);
+            }
+        }
+        gather.clear();
+        gathered.clear();
+    };
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_sendMutex);
+            m_sendCv.wait(lock, [this] {
+                return !m_sendQueue.empty() || m_greetPending || m_ackPending || !m_running;
+            });
+            if (!m_running)
+                break;
+            pending.swap(m_sendQueue);
+        }
+
+        // ̷߳ӣʹûдϢҲҪ֡˲ŻᲹȱʧϢ
+        if (m_greetPending.exchange(false)) {
+            m_transport.Write(nullptr, 0);
+        }
+        if (m_ackPending.exchange(false)) {
+            EncodeAck(gather, m_received.load());
+        }
+
+        for (const Outbound& item : pending) {
+            BufferLease buffer = m_bufferPool->Acquire(Common::Utf::MaxUtf8Length(item.length));
+            size_t bytes = Common::Utf::Utf16ToUtf8(item.text, item.length, reinterpret_cast<char*>(buffer->Data()));
+            if (item.release)
+                item.release(item.context);
+
+            if (bytes == Common::Utf::INVALID) {
+                m_invalidText.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            buffer->Resize(bytes);
+
+            if (bytes > MAX_FRAME_LENGTH) {
+                flush();
+                bool ok = WriteFragments(*buffer);
+                CountWrite(ok, 1);
+                if (ok) {
+                    RecordSent(buffer);
+                }
+                continue;
+            }
+
+            SealFrame(*buffer, FrameKind::Message);
+            if (gather.size() + buffer->FrameSize() > COALESCE_LIMIT) {
+                flush();
+            }
+            if (buffer->FrameSize() >= COALESCE_LIMIT) {
+                // ֱ֡Ӵӳػдٸ
+                bool ok = m_transport.Write(buffer->FrameData(), buffer->FrameSize());
+                CountWrite(ok, 1);
+                if (ok) {
+                    RecordSent(buffer);
+                }
+                continue;
+            }
+            gather.insert(gather.end(), buffer->FrameData(), buffer->FrameData() + buffer->FrameSize());
+            gathered.push_back(std::move(buffer));
+        }
+        pending.clear();
+        flush();
+    }
+}
+
+void BridgeCore::CountWrite(bool ok, size_t messages)
+{
+    m_writes.fetch_add(1, std::memory_order_relaxed);
+    if (ok) {
+        m_outbound.fetch_add(messages, std::memory_order_relaxed);
+    }
+    else {
+        m_writeFailures.fetch_add(messages, std::memory_order_relaxed);
+    }
+}
+
+// Ϣ offset һƬ׷ӵ out˵ķƬʽͬһƬ
+static size_t AppendFragment(std::vector<uint8_t>& out, uint32_t streamId, const PooledBuffer& message, size_t offset)
+{
+    size_t size = (std::min)(FRAGMENT_SIZE, message.Size() - offset);
+    bool last = offset + size == message.Size();
+
+    AppendU32(out, MakeFrameHeader(FrameKind::Fragment, static_cast<uint32_t>(FRAGMENT_HEADER_SIZE + size)));
+    AppendU32(out, streamId);
+    out.push_back(last ? FRAGMENT_FLAG_LAST : 0);
+    out.insert(out.end(), message.Data() + offset, message.Data() + offset + size);
+    return offset + size;
+}
+
+// ֡ޣ Fragment ƬƬдϢ֡
+bool BridgeCore::WriteFragments(const PooledBuffer& message)
+{
+    uint32_t streamId = m_nextStreamId++;
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER_SIZE + FRAGMENT_HEADER_SIZE + FRAGMENT_SIZE);
+    for (size_t offset = 0; offset < message.Size();) {
+        frame.clear();
+        offset = AppendFragment(frame, streamId, message, offset);
+        if (!m_transport.Write(frame.data(), frame.size()))
+            return false;
+    }
+    return true;
+}
+
+// طдϢѷ֡ԭƣδ֡ģ֡ޡƬдģµ ID ·Ƭ
+void BridgeCore::AppendResent(std::vector<uint8_t>& frames, const PooledBuffer& message)
+{
+    if (message.IsSealed()) {
+        frames.insert(frames.end(), message.FrameData(), message.FrameData() + message.FrameSize());
+        return;
+    }
+
+    uint32_t streamId = m_nextStreamId++;
+    for (size_t offset = 0; offset < message.Size();) {
+        offset = AppendFragment(frames, streamId, message, offset);
+    }
+}
+
+// ̣߳֡ƬϢ
+void BridgeCore::ReaderLoop()
+{
+    std::unique_ptr<FrameDecoder> decoder;
+    FragmentAssembler fragments(m_bufferPool);
+    auto reset = [&] {
+        decoder = std::make_unique<FrameDecoder>(m_bufferPool, MAX_FRAME_LENGTH);
+        fragments.Clear();
+    };
+    reset();
+
+    while (m_running) {
+        // С֡ݴ֡ʣಿֱӶ֡
+        size_t capacity = 0;
+        uint8_t* target = decoder->ReadTarget(capacity);
+        size_t bytesRead = 0;
+        if (!m_transport.Read(target, capacity, bytesRead)) {
+            reset();
+            WakeWriter(m_greetPending);
+            continue;
+        }
+
+        bool bad = !decoder->Commit(bytesRead);
+        Frame frame;
+        while (!bad && decoder->Next(frame)) {
+            if (frame.kind == FrameKind::Message) {
+                HandleInbound(frame.buffer);
+                continue;
+            }
+            if (frame.kind == FrameKind::Session || frame.kind == FrameKind::Ack) {
+                HandleSessionFrame(frame);
+                continue;
+            }
+            if (frame.kind != FrameKind::Fragment)
+                continue;           // ˵ʽ䲻 WebView Ž
+
+            BufferLease message;
+            FragmentAssembler::Result result = fragments.Add(frame, message);
+            if (result == FragmentAssembler::Result::Complete) {
+                HandleInbound(message);
+            }
+            else if (result == FragmentAssembler::Result::TooLarge) {
+                bad = true;
+            }
+        }
+
+        if (bad) {
+            m_badFrames.fetch_add(1, std::memory_order_relaxed);
+            m_transport.Disconnect();
+            reset();
+        }
+    }
+}
+
+void BridgeCore::HandleInbound(const BufferLease& message)
+{
+    // ż󱻶ķǷϢÿ ACK_INTERVAL ȷһ
+    uint64_t received = m_received.fetch_add(1) + 1;
+    if (received % ACK_INTERVAL == 0) {
+        WakeWriter(m_ackPending);
+    }
+
+    std::string_view text(reinterpret_cast<const char*>(message->Data()), message->Size());
+
+    // ǰУ飬һǷϢͬϢ
+    if (!Common::Utf::IsValidUtf8(text.data(), text.size())) {
+        m_invalidText.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(m_batchMutex);
+        bool wasEmpty = m_batcher.Empty();
+        wake = m_batcher.Add(text) || wasEmpty;
+    }
+    m_inbound.fetch_add(1, std::memory_order_relaxed);
+    if (wake) {
+        m_batchCv.notify_one();
+    }
+}
+
+// Session󶨻ĽAckյϢ
+void BridgeCore::HandleSessionFrame(const Frame& frame)
+{
+    const uint8_t* p = frame.Data();
+    if (frame.kind == FrameKind::Ack) {
+        if (frame.Size() < sizeof(uint64_t))
+            return;
+
+        std::lock_guard<std::mutex> lock(m_replayMutex);
+        m_replay.Ack(ReadU64(p));
+        return;
+    }
+
+    if (frame.Size() < 2 * sizeof(uint64_t))
+        return;
+    uint64_t token = ReadU64(p);
+    uint64_t received = ReadU64(p + sizeof(uint64_t));
+
+    {
+        std::lock_guard<std::mutex> lock(m_replayMutex);
+        if (token == 0) {
+            m_replay.Reset();
+        }
+        else {
+            m_replay.Ack(received);
+        }
+    }
+
+    // »ỰܣϢͷ
+    if (m_sessionToken.exchange(token) != token) {
+        m_received = 0;
+    }
+
+    if (token == 0) {
+        // ѶỰϿ԰֡°󶨣ǰҪ
+        static constexpr std::string_view NOTICE = R"({"ver":"1.0","type":"Notify","payload":{"event":"Session.Lost"}})";
+        BufferLease notice = m_bufferPool->Copy(reinterpret_cast<const uint8_t*>(NOTICE.data()), NOTICE.size());
+        HandleInbound(notice);
+        m_received = 0;
+        m_transport.Disconnect();
+    }
+}
+
+// д̣߳ӵ֡лỰʱδȷϵϢ
+// Ϊ 0  Resume ֡ѡ˾ݴ˿ʼỰط֡״ʱ֡д
+void BridgeCore::Greet(std::vector<uint8_t>& frames)
+{
+    std::lock_guard<std::mutex> lock(m_replayMutex);
+    uint64_t token = m_sessionToken.load();
+    if (token == 0) {
+        EncodeResume(frames, 0, 0, 1);
+        if (m_bindFrame) {
+            AppendResent(frames, *m_bindFrame);
+            m_rebinds.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_replay.Reset();
+        return;
+    }
+
+    std::vector<BufferLease> unacked;
+    uint64_t resendFrom = m_replay.FirstSeq();
+    m_replay.Since(resendFrom - 1, unacked);
+
+    EncodeResume(frames, token, m_received.load(), resendFrom);
+    for (const BufferLease& message : unacked) {
+        AppendResent(frames, *message);
+    }
+    m_resumes.fetch_add(1, std::memory_order_relaxed);
+}
+
+// дϢǰ֡Դ˰ clientId
+void BridgeCore::RecordSent(const BufferLease& message)
+{
+    std::lock_guard<std::mutex> lock(m_replayMutex);
+    if (!m_bindFrame) {
+        m_bindFrame = message;
+        return;
+    }
+    m_replay.Append(message);
+}
+
+void BridgeCore::WakeWriter(std::atomic<bool>& flag)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        flag = true;
+    }
+    m_sendCv.notify_one();
+}
+
+// Ͷ̣߳ Deadline ʱȡΣת벢Ͷ
+void BridgeCore::FlusherLoop()
+{
+    std::string batch;
+    std::unique_lock<std::mutex> lock(m_batchMutex);
+
+    while (m_running) {
+        uint64_t deadline = m_batcher.Deadline();
+        if (deadline == FrameBatcher::NO_DEADLINE) {
+            m_batchCv.wait(lock);
+            continue;
+        }
+        uint64_t now = NowNs();
+        if (deadline > now) {
+            m_batchCv.wait_for(lock, std::chrono::nanoseconds(deadline - now));
+            continue;
+        }
+
+        while (m_batcher.TakeBatch(batch)) {
+            lock.unlock();
+            PostBatch(batch);
+            lock.lock();
+        }
+    }
+}
+
+// UTF-8 -> ػ UTF-16 ϢͶݸ UI
+void BridgeCore::PostBatch(const std::string& utf8)
+{
+    BridgeMessage* msg = Acquire();
+    msg->text.resize(Common::Utf::MaxUtf16Length(utf8.size()));
+    size_t units = Common::Utf::Utf8ToUtf16(utf8.data(), utf8.size(), msg->text.data());
+    if (units == Common::Utf::INVALID) {
+        m_invalidText.fetch_add(1, std::memory_order_relaxed);
+        Recycle(msg);
+        return;
+    }
+    msg->text.resize(units);
+    msg->readyNs = NowNs();
+
+    if (m_sink.Post(msg)) {
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        m_postFailures.fetch_add(1, std::memory_order_relaxed);
+        Recycle(msg);
+    }
+}
+
+BridgeMessage* BridgeCore::Acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        if (!m_pool.empty()) {
+            BridgeMessage* msg = m_pool.back().release();
+            m_pool.pop_back();
+            return msg;
+        }
+    }
+    return new BridgeMessage();
+}
+
+void BridgeCore::Recycle(BridgeMessage* msg)
+{
+    std::unique_ptr<BridgeMessage> owned(msg);
+    if (owned->text.capacity() > MAX_POOLED_CAPACITY)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    if (m_pool.size() < MAX_POOLED) {
+        m_pool.push_back(std::move(owned));
+    }
+}
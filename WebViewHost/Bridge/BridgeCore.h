@@ -0,0 +1,202 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "../../TestClient/Common/LatencyHistogram.h"
+#include "../../TestClient/PipeServer/FrameCodec.h"
+#include "../../TestClient/PipeServer/SessionStore.h"
+#include "FrameBatcher.h"
+
+// ---------------------------------------------------------
+//  -> ǰ˵һϢڶ߳ת UTF-16
+// UI ֻ߳ text  WebViewȻ BridgeCore::Deliver 黹
+// ---------------------------------------------------------
+struct BridgeMessage
+{
+    std::u16string          text;
+    uint64_t                readyNs = 0;        // תɵʱ䣬ͳŶӳ
+};
+
+// ܵȵײֽ䣨Ž߳ã֡ BridgeCore 𣨼 FrameCodec.h
+class IBridgeTransport
+{
+public:
+    // ӵ֡°󶨣д߳ϵ
+    using Greeting = std::function<void(std::vector<uint8_t>& frames)>;
+
+    virtual ~IBridgeTransport() = default;
+
+    // ÿνӺдκ֮ǰд greeting ɵֽ
+    virtual void SetGreeting(Greeting greeting) = 0;
+    // дѷֽ֡ڣʧܷ falseݶʵָ𣩣size Ϊ 0 ʱֻȷӲ֡
+    virtual bool Write(const uint8_t* data, size_t size) = 0;
+    // ȡ capacity ֽڵ targetϿʧܻ Cancel ʱ false
+    // ֮ٶΪӣδİ֡ϣ
+    virtual bool Read(uint8_t* target, size_t capacity, size_t& bytesRead) = 0;
+    // յ޷ʱϿǰӣ´ζдʱ
+    virtual void Disconnect() = 0;
+    // е Read / Write 췵
+    virtual void Cancel() = 0;
+};
+
+// UI ߳ͶݣWin32 Ϊ PostMessageп滻Ϊ¼ʱļʵ֣
+class IUiSink
+{
+public:
+    virtual ~IUiSink() = default;
+
+    // ̵߳ã false ʾδͶݣϢ BridgeCore 
+    virtual bool Post(BridgeMessage* msg) = 0;
+};
+
+struct BridgeStats
+{
+    uint64_t                 inbound = 0;               //  -> ǰˣϢ
+    uint64_t                 batches = 0;               // ʵͶݸ UI 
+    uint64_t                 outbound = 0;              // ǰ -> 
+    uint64_t                 writes = 0;                // ܵдôС֡ϲ outbound
+    uint64_t                 invalidText = 0;           // Ƿ UTF-8 / UTF-16 
+    uint64_t                 badFrames = 0;             // ֡ηƬ¶Ͽ
+    uint64_t                 resumes = 0;               // ߺ Resume Ĵ
+    uint64_t                 rebinds = 0;               // ܡ·Ͱ֡Ĵ
+    uint64_t                 writeFailures = 0;
+    uint64_t                 postFailures = 0;
+
+    // UI ߳ÿϢĴʱתɵ UI Ŷʱ䣨룩
+    uint64_t                 uiP50Ns = 0;
+    uint64_t                 uiP99Ns = 0;
+    uint64_t                 queueP50Ns = 0;
+    uint64_t                 queueP99Ns = 0;
+};
+
+// ==============================
+// BridgeCoreWebView ֮ŽӺģ Win32 / WebView2
+// - ǰ -> UI ֻ߳ WebView  UTF-16 ָӣƣ
+//   дֱ߳תػ塢֡ٵ release ͷԭַлѹС֡ϲһд
+//   ֡ʱ Fragment Ƭ
+// -  -> ǰ˵ֽͬ FrameDecoder / FragmentAssembler ֱ֡֡Ӷػ
+// -  -> ǰˣֻ߳Ϣ FrameBatcherͶ̰߳֡һת뵽ػ
+//   BridgeMessage IUiSink ͶݣUI ֳֻ߳ɵַ WebView
+// - תʹ Common::UtfǷ
+// - Ự SessionStore.hϢΪ֮֡дϢطŻֱ Ack
+//   ʱ Resume + δȷϢΪ֡ʱط֪֡ͨǰ Session.Lost
+// ==============================
+class BridgeCore
+{
+public:
+    using ReleaseFn = void(*)(void* context);
+
+    BridgeCore(IBridgeTransport& transport, IUiSink& sink, FrameBatcherConfig batching = {});
+    ~BridgeCore();
+    BridgeCore(const BridgeCore&) = delete;
+    BridgeCore& operator=(const BridgeCore&) = delete;
+
+    void Start();
+    void Stop();
+
+    // UI ̵߳ãtext д߳ release(context) ͷţrelease Ϊգ
+    void Submit(const char16_t* text, size_t length, ReleaseFn release, void* context);
+
+    // UI ̴߳ Post Ϣ fn(const char16_t*, size_t)  msg
+    template <typename F>
+    void Deliver(BridgeMessage* msg, F&& fn)
+    {
+        if (!msg)
+            return;
+        uint64_t start = NowNs();
+        m_queueNs.Record(start - msg->readyNs);
+        fn(msg->text.c_str(), msg->text.size());
+        m_uiNs.Record(NowNs() - start);
+        Recycle(msg);
+    }
+
+    BridgeStats GetStats() const;
+
+private:
+    struct Outbound
+    {
+        const char16_t*         text = nullptr;
+        size_t                  length = 0;
+        ReleaseFn               release = nullptr;
+        void*                   context = nullptr;
+    };
+
+    void WriterLoop();
+    void ReaderLoop();
+    void FlusherLoop();
+    void HandleInbound(const BufferLease& message);
+    void HandleSessionFrame(const Frame& frame);
+    void Greet(std::vector<uint8_t>& frames);
+    void RecordSent(const BufferLease& message);
+    void WakeWriter(std::atomic<bool>& flag);
+    bool WriteFragments(const PooledBuffer& message);
+    void AppendResent(std::vector<uint8_t>& frames, const PooledBuffer& message);
+    void CountWrite(bool ok, size_t messages);
+    void PostBatch(const std::string& utf8);
+
+    BridgeMessage* Acquire();
+    void Recycle(BridgeMessage* msg);
+
+    static uint64_t NowNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    static constexpr size_t MAX_POOLED = 64;                    // Ϣ
+    static constexpr size_t MAX_POOLED_CAPACITY = 64 * 1024;    // ַس
+    static constexpr size_t COALESCE_LIMIT = 64 * 1024;         // ϲдޣ֡д
+
+    IBridgeTransport&       m_transport;
+    IUiSink&                m_sink;
+    std::shared_ptr<BufferPool> m_bufferPool = BufferPool::Create();
+    uint32_t                m_nextStreamId = 1;         // վƬ߼ IDд̷߳ʣ
+
+    std::atomic<bool>       m_running{ false };
+    std::thread             m_writer;
+    std::thread             m_reader;
+    std::thread             m_flusher;
+
+    std::mutex              m_sendMutex;
+    std::condition_variable m_sendCv;
+    std::deque<Outbound>    m_sendQueue;
+    std::atomic<bool>       m_greetPending{ false };    // ߳д̷߳֡
+    std::atomic<bool>       m_ackPending{ false };
+
+    // ỰյķϢɶ̸߳£طŻ m_replayMutex 
+    std::atomic<uint64_t>   m_sessionToken{ 0 };
+    std::atomic<uint64_t>   m_received{ 0 };
+    std::mutex              m_replayMutex;
+    BufferLease             m_bindFrame;
+    ReplayBuffer            m_replay{ 1024, 4 * 1024 * 1024 };
+
+    std::mutex              m_batchMutex;
+    std::condition_variable m_batchCv;
+    FrameBatcher            m_batcher;
+
+    std::mutex              m_poolMutex;
+    std::vector<std::unique_ptr<BridgeMessage>> m_pool;
+
+    std::atomic<uint64_t>   m_inbound{ 0 };
+    std::atomic<uint64_t>   m_batches{ 0 };
+    std::atomic<uint64_t>   m_outbound{ 0 };
+    std::atomic<uint64_t>   m_writes{ 0 };
+    std::atomic<uint64_t>   m_invalidText{ 0 };
+    std::atomic<uint64_t>   m_badFrames{ 0 };
+    std::atomic<uint64_t>   m_resumes{ 0 };
+    std::atomic<uint64_t>   m_rebinds{ 0 };
+    std::atomic<uint64_t>   m_writeFailures{ 0 };
+    std::atomic<uint64_t>   m_postFailures{ 0 };
+    Common::Metrics::LatencyHistogram m_uiNs;
+    Common::Metrics::LatencyHistogram m_queueNs;
+};
@@ -0,0 +1,149 @@
+#include "FrameBatcher.h"
+
+namespace
+{
+    size_t SkipSpace(std::string_view s, size_t i)
+    {
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n'))
+            ++i;
+        return i;
+    }
+}
+
+FrameBatcher::FrameBatcher(FrameBatcherConfig config, Clock clock)
+    : m_config(std::move(config))
+    , m_clock(std::move(clock))
+{
+
+}
+
+bool FrameBatcher::Add(std::string_view message)
+{
+    m_messages++;
+
+    size_t start = SkipSpace(message, 0);
+    if (start >= message.size() || message[start] != '{') {
+        SealCurrent();
+        std::string standalone;
+        if (!m_spare.empty()) {
+            standalone.swap(m_spare.back());
+            m_spare.pop_back();
+        }
+        standalone.assign(message.data(), message.size());
+        m_ready.push_back(std::move(standalone));
+        m_forced = true;
+        return true;
+    }
+
+    m_current.push_back(m_count == 0 ? '[' : ',');
+    m_current.append(message.data(), message.size());
+    m_count++;
+
+    if (m_count >= m_config.maxBatchMessages || m_current.size() >= m_config.maxBatchBytes) {
+        SealCurrent();
+        m_forced = true;
+    }
+    else if (!m_config.urgentTypes.empty()) {
+        std::string_view type = ExtractType(message);
+        if (!type.empty() && m_config.urgentTypes.count(std::string(type))) {
+            m_forced = true;
+        }
+    }
+    return m_forced;
+}
+
+uint64_t FrameBatcher::Deadline() const
+{
+    if (Empty())
+        return NO_DEADLINE;
+    if (m_forced || !m_flushed)
+        return 0;
+    return m_lastFlush + m_config.frameIntervalNs;
+}
+
+bool FrameBatcher::TakeBatch(std::string& out)
+{
+    if (m_ready.empty()) {
+        if (m_count == 0)
+            return false;
+        SealCurrent();
+    }
+
+    std::string batch = std::move(m_ready.front());
+    m_ready.pop_front();
+
+    // ÷صľɻʹ
+    out.swap(batch);
+    if (m_spare.size() < MAX_SPARE) {
+        batch.clear();
+        m_spare.push_back(std::move(batch));
+    }
+
+    m_batches++;
+    m_lastFlush = m_clock();
+    m_flushed = true;
+    if (Empty()) {
+        m_forced = false;
+    }
+    return true;
+}
+
+std::string_view FrameBatcher::ExtractType(std::string_view json)
+{
+    constexpr std::string_view KEY = "\"type\"";
+
+    // ֻ㣺Ƕ׶/ַ
+    int depth = 0;
+    for (size_t i = 0; i < json.size(); ++i) {
+        char c = json[i];
+        if (c == '"') {
+            if (depth == 1 && json.compare(i, KEY.size(), KEY) == 0) {
+                size_t p = SkipSpace(json, i + KEY.size());
+                if (p < json.size() && json[p] == ':') {
+                    p = SkipSpace(json, p + 1);
+                    if (p < json.size() && json[p] == '"') {
+                        size_t end = json.find('"', p + 1);
+                        if (end != std::string_view::npos)
+                            return json.substr(p + 1, end - p - 1);
+                    }
+                    return {};
+                }
+                // ֵǡ "type" ַ
+            }
+            // ַ
+            for (++i; i < json.size() && json[i] != '"'; ++i) {
+                if (json[i] == '\\')
+                    ++i;
+            }
+        }
+        else if (c == '{' || c == '[') {
+            depth++;
+        }
+        else if (c == '}' || c == ']') {
+            depth--;
+        }
+    }
+    return {};
+}
+
+void FrameBatcher::SealCurrent()
+{
+    if (m_count == 0)
+        return;
+
+    if (m_count == 1) {
+        m_current.erase(0, 1);          // Ϣȥ '[' ԭ
+    }
+    else {
+        m_current.push_back(']');
+    }
+    m_ready.push_back(std::move(m_current));
+    m_current = std::string();
+    m_count = 0;
+
+    if (!m_spare.empty()) {
+        m_current.swap(m_spare.back());
+        m_current.clear();
+        m_spare.pop_back();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_set>
+#include <functional>
+
+struct FrameBatcherConfig
+{
+    uint64_t                 frameIntervalNs = 16'666'667;  // Լһ֡60Hz
+    size_t                   maxBatchBytes = 256 * 1024;
+    size_t                   maxBatchMessages = 512;
+    // Щ type Ϣһ֮֡ͬǰܵһ
+    std::unordered_set<std::string> urgentTypes{ "Response", "Error" };
+};
+
+// ==============================
+// FrameBatcherѷ -> ǰ˵Ϣʾ֡ƽ̨ɵ÷ͬ
+// - JSON Ϣ׷ӵǰΣʱΪ "[m1,m2,...]"ֻһʱԭ
+// - ϴηһ֡ʱȴ Deadline()ÿ֡෢һΣкĵһϢɷ
+// -  typeֽ/ֵʱ Deadline()  0
+// -  JSON Ϣ顢ıȷ浱ǰΣٵ
+// - ʱӿע룬ģʱӲ
+// ==============================
+class FrameBatcher
+{
+public:
+    using Clock = std::function<uint64_t()>;
+
+    static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+    FrameBatcher(FrameBatcherConfig config, Clock clock);
+
+    // ׷һϢ true ʾӦ TakeBatch
+    bool Add(std::string_view message);
+
+    bool Empty() const { return m_ready.empty() && m_count == 0; }
+
+    // һӦʱ䣨ʱӵλ0 ʾNO_DEADLINE ʾ޴Ϣ
+    uint64_t Deadline() const;
+
+    // ȡһΣ out Ըη false
+    bool TakeBatch(std::string& out);
+
+    uint64_t Batches() const { return m_batches; }
+    uint64_t Messages() const { return m_messages; }
+
+    // ȡ "type" ֶεֵֻɨ裬
+    static std::string_view ExtractType(std::string_view json);
+
+private:
+    void SealCurrent();
+
+private:
+    static constexpr size_t MAX_SPARE = 4;
+
+    FrameBatcherConfig      m_config;
+    Clock                   m_clock;
+
+    std::string             m_current;              // "[m1,m2"ʱ "]"
+    size_t                  m_count = 0;
+    std::deque<std::string> m_ready;                // ѷ桢ȴ
+    std::deque<std::string> m_spare;                // 󻻻صĻ
+
+    bool                    m_forced = false;
+    uint64_t                m_lastFlush = 0;
+    bool                    m_flushed = false;
+
+    uint64_t                m_batches = 0;
+    uint64_t                m_messages = 0;
+};
@@ -0,0 +1,144 @@
+#include "PipeClient.h"
+
+PipeClient::PipeClient(IPipeEndpoint& endpoint)
+    : m_endpoint(endpoint)
+{
+
+}
+
+void PipeClient::SetGreeting(Greeting greeting)
+{
+    m_greeting = std::move(greeting);
+}
+
+bool PipeClient::Write(const uint8_t* data, size_t size)
+{
+    for (int attempt = 0; attempt < MAX_WRITE_ATTEMPTS && !m_cancelled; attempt++) {
+        if (attempt > 0) {
+            m_writeRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!EnsureConnected()) {
+            if (!m_endpoint.WaitRetry(WRITE_RETRY_DELAY))
+                return false;
+            continue;
+        }
+
+        uint64_t generation = m_generation.load();
+        IPipeEndpoint::Status status = Greet(generation);
+        if (status == IPipeEndpoint::Status::Ok && size > 0) {
+            status = m_endpoint.Write(data, size);
+        }
+        if (status == IPipeEndpoint::Status::Ok)
+            return true;
+        if (status == IPipeEndpoint::Status::Cancelled)
+            return false;
+
+        // дʧ,رչܵ
+        DisconnectIf(generation);
+        if (!m_endpoint.WaitRetry(WRITE_RETRY_DELAY))
+            return false;
+    }
+    return false;
+}
+
+bool PipeClient::Read(uint8_t* target, size_t capacity, size_t& bytesRead)
+{
+    bytesRead = 0;
+    if (!EnsureConnected()) {
+        m_endpoint.WaitRetry(READ_RETRY_DELAY);
+        return false;
+    }
+
+    // Ѹд߳δİ֡
+    uint64_t generation = m_generation.load();
+    if (generation != m_readGeneration) {
+        m_readGeneration = generation;
+        return false;
+    }
+
+    IPipeEndpoint::Status status = m_endpoint.Read(target, capacity, bytesRead);
+    if (status == IPipeEndpoint::Status::Ok && bytesRead > 0)
+        return true;
+
+    bytesRead = 0;
+    if (status != IPipeEndpoint::Status::Cancelled) {
+        DisconnectIf(generation);
+    }
+    return false;
+}
+
+void PipeClient::Disconnect()
+{
+    DisconnectIf(m_generation.load());
+}
+
+void PipeClient::DisconnectIf(uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_connectMutex);
+    if (m_connected && m_generation.load() == generation) {
+        m_endpoint.Close();
+        m_connected = false;
+        m_disconnects.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PipeClient::Cancel()
+{
+    m_cancelled = true;
+    m_endpoint.Cancel();
+}
+
+PipeClientStats PipeClient::GetStats() const
+{
+    PipeClientStats stats;
+    stats.connects = m_connects.load(std::memory_order_relaxed);
+    stats.connectFailures = m_connectFailures.load(std::memory_order_relaxed);
+    stats.writeRetries = m_writeRetries.load(std::memory_order_relaxed);
+    stats.disconnects = m_disconnects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// д֡ / °󶨣ʧʱͨдʧһ
+IPipeEndpoint::Status PipeClient::Greet(uint64_t generation)
+{
+    if (m_greetedGeneration == generation)
+        return IPipeEndpoint::Status::Ok;
+
+    m_greetFrames.clear();
+    if (m_greeting) {
+        m_greeting(m_greetFrames);
+    }
+    if (!m_greetFrames.empty()) {
+        IPipeEndpoint::Status status = m_endpoint.Write(m_greetFrames.data(), m_greetFrames.size());
+        if (status != IPipeEndpoint::Status::Ok)
+            return status;
+    }
+    m_greetedGeneration = generation;
+    return IPipeEndpoint::Status::Ok;
+}
+
+// ӵ Service Ĺܵӣֱӷ true
+bool PipeClient::EnsureConnected()
+{
+    std::lock_guard<std::mutex> lock(m_connectMutex);
+    if (m_connected)
+        return true;
+
+    for (int i = 0; i < MAX_CONNECT_ATTEMPTS && !m_cancelled; i++) {
+        IPipeEndpoint::Status status = m_endpoint.Open();
+        if (status == IPipeEndpoint::Status::Ok) {
+            m_connected = true;
+            m_generation.fetch_add(1);
+            m_connects.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (status != IPipeEndpoint::Status::Busy && status != IPipeEndpoint::Status::NotFound)
+            break;
+        if (!m_endpoint.WaitRetry(CONNECT_RETRY_DELAY))
+            break;
+    }
+
+    m_connectFailures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include "BridgeCore.h"
+
+// ==============================
+// IPipeEndpointܵϵԭʼWin32 ʵּ WebViewHost.cpp
+// - Read / Write ɣд߳ͬʱ
+// - Cancel ֮þ췵 CancelledWaitRetry  false
+// ==============================
+class IPipeEndpoint
+{
+public:
+    enum class Status
+    {
+        Ok,
+        Busy,                   // ʵȫæERROR_PIPE_BUSY
+        NotFound,               // δܵ
+        Failed,                 // Զ˹رգҪ
+        Cancelled,
+    };
+
+    virtual ~IPipeEndpoint() = default;
+
+    virtual Status Open() = 0;
+    virtual void Close() = 0;
+    virtual Status Read(uint8_t* target, size_t capacity, size_t& bytesRead) = 0;
+    virtual Status Write(const uint8_t* data, size_t size) = 0;
+    // ȴ delay ԣ Cancel ʱǰ false
+    virtual bool WaitRetry(std::chrono::milliseconds delay) = 0;
+    virtual void Cancel() = 0;
+};
+
+struct PipeClientStats
+{
+    uint64_t                 connects = 0;
+    uint64_t                 connectFailures = 0;       // ӵĴ
+    uint64_t                 writeRetries = 0;
+    uint64_t                 disconnects = 0;
+};
+
+// ==============================
+// PipeClientܵͻ˵ /  / ״̬ Win32
+// - ״ζдʱӣæδҵʱÿ 100ms ԣ MAX_CONNECT_ATTEMPTS 
+// - дʧʱϿೢ MAX_WRITE_ATTEMPTS 
+// - ʧʱϿһ Read ÿһ Read  false
+//    BridgeCore ϵİ֡
+// - ÿϵһ Write ֮ǰд greeting ɵֻ֡д߳д
+// ==============================
+class PipeClient : public IBridgeTransport
+{
+public:
+    static constexpr int MAX_CONNECT_ATTEMPTS = 50;
+    static constexpr int MAX_WRITE_ATTEMPTS = 3;
+    static constexpr std::chrono::milliseconds CONNECT_RETRY_DELAY{ 100 };
+    static constexpr std::chrono::milliseconds WRITE_RETRY_DELAY{ 500 };
+    static constexpr std::chrono::milliseconds READ_RETRY_DELAY{ 1000 };
+
+    explicit PipeClient(IPipeEndpoint& endpoint);
+
+    void SetGreeting(Greeting greeting) override;
+    bool Write(const uint8_t* data, size_t size) override;
+    bool Read(uint8_t* target, size_t capacity, size_t& bytesRead) override;
+    void Disconnect() override;
+    void Cancel() override;
+
+    PipeClientStats GetStats() const;
+
+private:
+    bool EnsureConnected();
+    // ֻϿָǴӣһ̵߳ľɴصһ̸߳ս
+    void DisconnectIf(uint64_t generation);
+    IPipeEndpoint::Status Greet(uint64_t generation);
+
+private:
+    IPipeEndpoint&          m_endpoint;
+
+    std::mutex              m_connectMutex;
+    bool                    m_connected = false;        //  m_connectMutex 
+    std::atomic<uint64_t>   m_generation{ 0 };          // ÿӳɹһ
+    uint64_t                m_readGeneration = 0;       // ̷߳
+    Greeting                m_greeting;
+    uint64_t                m_greetedGeneration = 0;    // д̷߳
+    std::vector<uint8_t>    m_greetFrames;
+    std::atomic<bool>       m_cancelled{ false };
+
+    std::atomic<uint64_t>   m_connects{ 0 };
+    std::atomic<uint64_t>   m_connectFailures{ 0 };
+    std::atomic<uint64_t>   m_writeRetries{ 0 };
+    std::atomic<uint64_t>   m_disconnects{ 0 };
+};
@@ -19,10 +19,10 @@
 #include "WebView2.h"
 #include <thread>
 #include <atomic>
-#include <queue>              // Ϣ
 #include <mutex>              // 
-#include <condition_variable> // 
 #include <cstdio>             //  swprintf_s 
+#include "Bridge\BridgeCore.h"
+#include "Bridge\PipeClient.h"
 
 using namespace Microsoft::WRL;
 
@@ -31,31 +31,39 @@ HINSTANCE hInst;
 HWND hWndMain;
 ComPtr<ICoreWebView2Controller> webviewController;
 ComPtr<ICoreWebView2> webview;
-HANDLE hPipe = INVALID_HANDLE_VALUE;
-std::atomic<bool> isRunning(true);
 
-// ߳ͬ (ڷͶ)
-std::queue<std::string> sendQueue;
-std::mutex queueMutex;
-std::condition_variable queueCv;
-
-// ԶϢ
+// ԶϢlParam Ϊ BridgeMessage* BridgeCore::Deliver 
 #define WM_PIPE_MESSAGE (WM_USER + 1)
 const std::wstring PIPE_NAME = L"\\\\.\\pipe\\WebView2VuePipe";
 
 // ---------------------------------------------------------
 // ܵͨ (ײ)
+// дһڸõ OVERLAPPED + ¼ÿ CreateEvent / CloseHandle
+// ӡԡ״̬ PipeClient 
 // ---------------------------------------------------------
-
-// ӵ Service Ĺܵӣֱӷ true
-bool ConnectToService() 
+class Win32PipeEndpoint : public IPipeEndpoint
 {
-    if (hPipe != INVALID_HANDLE_VALUE) return true;
+public:
+    Win32PipeEndpoint()
+        : m_readEvent(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_writeEvent(CreateEvent(NULL, TRUE, FALSE, NULL))
+        , m_stopEvent(CreateEvent(NULL, TRUE, FALSE, NULL))
+    {
+        m_readOv.hEvent = m_readEvent;
+        m_writeOv.hEvent = m_writeEvent;
+    }
 
-    // (ȴ 5 )
-    const int MAX_RETRIES = 50;
-    for (int i = 0; i < MAX_RETRIES; i++) {
-        hPipe = CreateFile(
+    ~Win32PipeEndpoint() override
+    {
+        Close();
+        CloseHandle(m_readEvent);
+        CloseHandle(m_writeEvent);
+        CloseHandle(m_stopEvent);
+    }
+
+    Status Open() override
+    {
+        HANDLE pipe = CreateFile(
             PIPE_NAME.c_str(),
             GENERIC_READ | GENERIC_WRITE,
             0, NULL, OPEN_EXISTING,
@@ -63,184 +71,127 @@ bool ConnectToService()
             NULL
         );
 
-        if (hPipe != INVALID_HANDLE_VALUE) {
-            DWORD mode = PIPE_READMODE_MESSAGE;
-            SetNamedPipeHandleState(hPipe, &mode, NULL, NULL);
-
+        if (pipe != INVALID_HANDLE_VALUE) {
+            //  PIPE_TYPE_BYTEϢ߽֡ǰ׺Ĭϵֽڶģʽ
+            m_pipe = pipe;
             OutputDebugStringW(L"[Pipe Host] Connected to service!\n");
-            return true;
+            return Status::Ok;
         }
 
         DWORD error = GetLastError();
         if (error == ERROR_PIPE_BUSY) {
             // ܵæ,ȴ
-            if (!WaitNamedPipe(PIPE_NAME.c_str(), 100)) {
-                continue;
-            }
+            WaitNamedPipe(PIPE_NAME.c_str(), 100);
+            return Status::Busy;
         }
-        else if (error != ERROR_FILE_NOT_FOUND) {
-            wchar_t msg[256];
-            swprintf_s(msg, L"[Pipe Host] CreateFile error: %lu\n", error);
-            OutputDebugStringW(msg);
-            return false;
+        if (error == ERROR_FILE_NOT_FOUND) {
+            return Status::NotFound;
         }
 
-        Sleep(100);
+        wchar_t msg[256];
+        swprintf_s(msg, L"[Pipe Host] CreateFile error: %lu\n", error);
+        OutputDebugStringW(msg);
+        return Status::Failed;
     }
-    return false;
-}
 
-// ---------------------------------------------------------
-// ߳ 1: ߳ (Consumer)
-// ӶȡϢ WriteFileӰ UI
-// ---------------------------------------------------------
-void PipeWriterThread() 
-{
-    while (isRunning) {
-        std::string msgToSend;
-
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCv.wait(lock, [] { return !sendQueue.empty() || !isRunning; });
-
-            if (!isRunning) break;
-
-            msgToSend = sendQueue.front();
-            sendQueue.pop();
+    void Close() override
+    {
+        HANDLE pipe = m_pipe.exchange(INVALID_HANDLE_VALUE);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            CloseHandle(pipe);
         }
+    }
 
-        // Է()
-        int retries = 3;
-        while (retries-- > 0 && isRunning) {
-            if (!ConnectToService()) {
-                Sleep(500);
-                continue;
-            }
-
-            DWORD bytesWritten;
-            OVERLAPPED ov = { 0 };
-            ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-
-            BOOL result = WriteFile(
-                hPipe,
-                msgToSend.c_str(),
-                (DWORD)msgToSend.length(),
-                &bytesWritten,
-                &ov  // ʹ Overlapped I/O
-            );
-
-            if (!result) {
-                DWORD error = GetLastError();
-                if (error == ERROR_IO_PENDING) {
-                    // ȴд( 5 )
-                    DWORD waitResult = WaitForSingleObject(ov.hEvent, 5000);
-                    if (waitResult == WAIT_OBJECT_0) {
-                        if (GetOverlappedResult(hPipe, &ov, &bytesWritten, FALSE)) {
-                            OutputDebugStringW(L"[Pipe Host Writer] WriteFile success\n");
-                            CloseHandle(ov.hEvent);
-                            break;  // ɹ,˳ѭ
-                        }
-                    }
-                    else if (waitResult == WAIT_TIMEOUT) {
-                        OutputDebugStringW(L"[Pipe Host Writer] WriteFile TIMEOUT\n");
-                    }
-                }
-
-                // дʧ,رչܵ
-                wchar_t msg[256];
-                swprintf_s(msg, L"[Pipe Host] WriteFile failed: %lu. Retrying...\n", GetLastError());
-                OutputDebugStringW(msg);
+    // ɺأɵ÷Ͷһζȡʱһֱ𣬲ʱѯ
+    Status Read(uint8_t* target, size_t capacity, size_t& bytesRead) override
+    {
+        DWORD read = 0;
+        Status status = Complete(m_readOv, INFINITE,
+            ReadFile(m_pipe, target, (DWORD)capacity, &read, &m_readOv), read);
+        bytesRead = read;
+        return status;
+    }
 
-                CloseHandle(ov.hEvent);
-                CloseHandle(hPipe);
-                hPipe = INVALID_HANDLE_VALUE;
-                Sleep(500);
-            }
-            else {
-                // ͬ
-                OutputDebugStringW(L"[Pipe Host Writer] WriteFile completed synchronously\n");
-                CloseHandle(ov.hEvent);
-                break;
-            }
+    Status Write(const uint8_t* data, size_t size) override
+    {
+        // ȴд( 5 )
+        DWORD written = 0;
+        Status status = Complete(m_writeOv, 5000,
+            WriteFile(m_pipe, data, (DWORD)size, &written, &m_writeOv), written);
+        if (status == Status::Ok && written != size) {
+            status = Status::Failed;
         }
-
-        if (retries < 0) {
-            OutputDebugStringW(L"[Pipe Host] Failed to send message after retries. Message lost.\n");
+        if (status == Status::Failed) {
+            wchar_t msg[256];
+            swprintf_s(msg, L"[Pipe Host] WriteFile failed: %lu. Retrying...\n", GetLastError());
+            OutputDebugStringW(msg);
         }
+        return status;
     }
-}
 
-// ---------------------------------------------------------
-// ߳ 2: ȡ߳
-//  ReadFile ֪ͨ UI
-// ---------------------------------------------------------
-void PipeReaderThread() 
-{
-    char buffer[4096];
-    DWORD bytesRead;
+    bool WaitRetry(std::chrono::milliseconds delay) override
+    {
+        return WaitForSingleObject(m_stopEvent, (DWORD)delay.count()) == WAIT_TIMEOUT;
+    }
 
-    while (isRunning) {
-        if (!ConnectToService()) {
-            Sleep(1000);
-            continue;
-        }
+    void Cancel() override
+    {
+        SetEvent(m_stopEvent);
+    }
 
-        OVERLAPPED ov = { 0 };
-        ov.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-
-        BOOL result = ReadFile(hPipe, buffer, sizeof(buffer) - 1, &bytesRead, &ov);
-
-        if (!result) {
-            DWORD error = GetLastError();
-            if (error == ERROR_IO_PENDING) {
-                // ȴȡ(ʱ)
-                DWORD waitResult = WaitForSingleObject(ov.hEvent, 10000);
-                if (waitResult == WAIT_OBJECT_0) {
-                    if (GetOverlappedResult(hPipe, &ov, &bytesRead, FALSE)) {
-                        buffer[bytesRead] = '\0';
-                        std::string* msg = new std::string(buffer);
-                        PostMessage(hWndMain, WM_PIPE_MESSAGE, 0, (LPARAM)msg);
-                    }
-                }
-                else {
-                    OutputDebugStringW(L"[Pipe Host Reader] ReadFile timeout\n");
+private:
+    // ȴصɣֹͣʱʱȡȵں˲ʹ ov
+    Status Complete(OVERLAPPED& ov, DWORD timeoutMs, BOOL started, DWORD& transferred)
+    {
+        DWORD error = started ? ERROR_SUCCESS : GetLastError();
+        if (error == ERROR_IO_PENDING) {
+            HANDLE pipe = m_pipe;
+            HANDLE waits[2] = { ov.hEvent, m_stopEvent };
+            DWORD waitResult = WaitForMultipleObjects(2, waits, FALSE, timeoutMs);
+            if (waitResult != WAIT_OBJECT_0) {
+                if (waitResult == WAIT_TIMEOUT) {
+                    OutputDebugStringW(L"[Pipe Host] I/O TIMEOUT\n");
                 }
+                CancelIoEx(pipe, &ov);
             }
-            else {
-                // ȡ,Ͽ
-                CloseHandle(hPipe);
-                hPipe = INVALID_HANDLE_VALUE;
-            }
-        }
-        else {
-            // ͬ
-            buffer[bytesRead] = '\0';
-            std::string* msg = new std::string(buffer);
-            PostMessage(hWndMain, WM_PIPE_MESSAGE, 0, (LPARAM)msg);
+            BOOL done = GetOverlappedResult(pipe, &ov, &transferred, TRUE);
+            error = done ? ERROR_SUCCESS : GetLastError();
         }
 
-        CloseHandle(ov.hEvent);
+        if (error == ERROR_SUCCESS)
+            return Status::Ok;
+        if (error == ERROR_OPERATION_ABORTED && WaitForSingleObject(m_stopEvent, 0) == WAIT_OBJECT_0)
+            return Status::Cancelled;
+        return Status::Failed;
     }
-}
 
-// ---------------------------------------------------------
-// UI ̵߳õķͺ (Producer)
-// ˺ UI ̣߳ٽϢ
-// ---------------------------------------------------------
-void SendToServiceAsync(const std::wstring& message) 
+private:
+    std::atomic<HANDLE> m_pipe{ INVALID_HANDLE_VALUE };
+    HANDLE              m_readEvent;
+    HANDLE              m_writeEvent;
+    HANDLE              m_stopEvent;
+    OVERLAPPED          m_readOv{};                     // ߳ʹ
+    OVERLAPPED          m_writeOv{};                    // д߳ʹ
+};
+
+// תõϢͶݵ
+class WindowSink : public IUiSink
 {
-    // ַת UTF-8
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, message.c_str(), (int)message.length(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, message.c_str(), (int)message.length(), &strTo[0], size_needed, NULL, NULL);
-
-    // Ϣ
+public:
+    bool Post(BridgeMessage* msg) override
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        sendQueue.push(strTo);
+        return PostMessage(hWndMain, WM_PIPE_MESSAGE, 0, (LPARAM)msg) != FALSE;
     }
-    // ֪ͨ߳ (PipeWriterThread) 
-    queueCv.notify_one();
+};
+
+Win32PipeEndpoint pipeEndpoint;
+PipeClient        pipeClient(pipeEndpoint);
+WindowSink        windowSink;
+BridgeCore        bridge(pipeClient, windowSink);
+
+static void FreeWebMessage(void* text)
+{
+    CoTaskMemFree(text);
 }
 
 // ---------------------------------------------------------
@@ -267,12 +218,12 @@ void InitializeWebView(HWND hWnd)
                         webview->add_WebMessageReceived(
                             Callback<ICoreWebView2WebMessageReceivedEventHandler>(
                                 [](ICoreWebView2* sender, ICoreWebView2WebMessageReceivedEventArgs* args) -> HRESULT {
-                                    LPWSTR pwStr;
+                                    LPWSTR pwStr = nullptr;
                                     args->TryGetWebMessageAsString(&pwStr);
                                     if (pwStr) {
-                                        // 첽ͺٷ
-                                        SendToServiceAsync(pwStr);
-                                        CoTaskMemFree(pwStr);
+                                        // ֻӣתдܵдַ̣߳д߳ͷ
+                                        bridge.Submit(reinterpret_cast<const char16_t*>(pwStr), wcslen(pwStr),
+                                            FreeWebMessage, pwStr);
                                     }
                                     return S_OK;
                                 }).Get(), nullptr);
@@ -305,26 +256,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         break;
 
-    case WM_PIPE_MESSAGE: //  PipeReaderThread Ϣ
-    {
-        std::string* msgPtr = (std::string*)lParam;
-        if (msgPtr && webview) {
-            // UTF-8 ת ַ ( WebView2 ʹ)
-            int len = MultiByteToWideChar(CP_UTF8, 0, msgPtr->c_str(), -1, NULL, 0);
-            std::wstring wMsg(len, 0);
-            MultiByteToWideChar(CP_UTF8, 0, msgPtr->c_str(), -1, &wMsg[0], len);
-
+    case WM_PIPE_MESSAGE: // Ͷ̵߳ϢѰ֡תΪ UTF-16
+        bridge.Deliver((BridgeMessage*)lParam, [](const char16_t* text, size_t) {
             // ͸ Vue ǰ
-            webview->PostWebMessageAsString(wMsg.c_str());
-            delete msgPtr; // ͷڴ
-        }
-    }
-    break;
+            if (webview) {
+                webview->PostWebMessageAsString(reinterpret_cast<LPCWSTR>(text));
+            }
+        });
+        break;
 
     case WM_DESTROY:
         // ֹͣ߳
-        isRunning = false;
-        queueCv.notify_all(); // ѷ߳Ա˳
+        bridge.Stop();
         PostQuitMessage(0);
         break;
     default:
@@ -361,13 +304,8 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 
     InitializeWebView(hWndMain);
 
-    // ȡ߳
-    std::thread reader(PipeReaderThread);
-    reader.detach();
-
-    // ߳ ()
-    std::thread writer(PipeWriterThread);
-    writer.detach();
+    // ȡ߳
+    bridge.Start();
 
     MSG msg;
     while (GetMessage(&msg, nullptr, 0, 0)) {